@@ -0,0 +1,82 @@
+// hnll
+#include <audio/utils.hpp>
+#include <audio/convolver.hpp>
+
+// std
+#include <random>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+std::vector<std::complex<double>> create_noise(size_t size)
+{
+  std::mt19937 engine{ 0 };
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<std::complex<double>> ret(size);
+  for (auto& v : ret)
+    v = { dist(engine), 0.0 };
+  return ret;
+}
+
+void fft(benchmark::State& state)
+{
+  const auto original = create_noise(state.range(0));
+  for (auto _ : state) {
+    // fft works in place
+    state.PauseTiming();
+    auto series = original;
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(audio::utils::fft(series));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+void ifft(benchmark::State& state)
+{
+  auto time_series = create_noise(state.range(0));
+  const auto original = audio::utils::fft(time_series);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto series = original;
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(audio::utils::ifft(series));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+// one segment of overlap-add convolution : 2 ffts, 1 ifft and the accumulation
+void convolver_add_segment(benchmark::State& state)
+{
+  const auto size = static_cast<size_t>(state.range(0));
+  auto convolver = audio::convolver::create(size);
+  const auto data = audio::utils::create_sine_wave(size / 44100.f, 440.f, 0.5f);
+  // decaying noise as an impulse response
+  std::vector<double> filter(size);
+  std::mt19937 engine{ 0 };
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (size_t i = 0; i < size; i++)
+    filter[i] = dist(engine) * std::exp(-8.0 * i / size);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto segment = data;
+    segment.resize(size);
+    auto segment_filter = filter;
+    state.ResumeTiming();
+
+    convolver->add_segment(std::move(segment), std::move(segment_filter));
+    benchmark::DoNotOptimize(convolver->move_buffer());
+  }
+  // samples per second, compare with the sampling rate
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(fft)->RangeMultiplier(4)->Range(256, 1 << 16)->Complexity(benchmark::oNLogN);
+BENCHMARK(ifft)->RangeMultiplier(4)->Range(256, 1 << 16)->Complexity(benchmark::oNLogN);
+BENCHMARK(convolver_add_segment)->RangeMultiplier(2)->Range(512, 8192);
+
+} // namespace hnll
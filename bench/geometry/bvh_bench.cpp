@@ -0,0 +1,160 @@
+// hnll
+#include <geometry/bvh.hpp>
+#include <geometry/he_mesh.hpp>
+#include <geometry/intersection.hpp>
+#include <physics/collision_detector.hpp>
+#include <utils/thread_pool.hpp>
+#include "../perf_counters_bench.hpp"
+#include "sphere_obj.hpp"
+
+// std
+#include <random>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+static s_ptr<geometry::he_mesh> get_sphere_mesh(int resolution)
+{ return geometry::he_mesh::create_from_obj_file(get_sphere_obj(resolution)); }
+
+// rays from outside of the unit sphere toward random points inside it
+static std::vector<geometry::ray> create_rays(size_t count)
+{
+  std::mt19937 engine(5);
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> inner(-0.5, 0.5);
+  std::vector<geometry::ray> rays(count);
+  for (auto& r : rays) {
+    r.origin = vec3d{ normal(engine), normal(engine), normal(engine) }.normalized() * 3.0;
+    r.direction = vec3d{ inner(engine), inner(engine), inner(engine) } - r.origin;
+  }
+  return rays;
+}
+
+static std::vector<u_ptr<geometry::bounding_volume>> create_volumes(size_t count)
+{
+  std::mt19937 engine(5);
+  // about 8 neighbors per volume regardless of the count
+  const double extent = std::cbrt(static_cast<double>(count)) * 0.5;
+  std::uniform_real_distribution<double> center(-extent, extent);
+  std::uniform_real_distribution<double> radius(0.1, 0.4);
+  std::vector<u_ptr<geometry::bounding_volume>> volumes;
+  for (size_t i = 0; i < count; i++) {
+    vec3d c = { center(engine), center(engine), center(engine) };
+    if (i % 2 == 0)
+      volumes.emplace_back(geometry::bounding_volume::create_sphere(c, radius(engine)));
+    else
+      volumes.emplace_back(geometry::bounding_volume::create_aabb(c, vec3d{ radius(engine), radius(engine), radius(engine) }));
+  }
+  return volumes;
+}
+
+void bvh_create_from_he_mesh(benchmark::State& state)
+{
+  const auto mesh = get_sphere_mesh(state.range(0));
+  size_t node_count = 0;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      auto tree = geometry::bvh::create(*mesh);
+      node_count = tree->get_node_count();
+      benchmark::DoNotOptimize(tree);
+    }
+  }
+  state.counters["nodes"] = static_cast<double>(node_count);
+  state.SetItemsProcessed(state.iterations() * mesh->get_face_count());
+}
+
+void bvh_create_from_he_mesh_parallel(benchmark::State& state)
+{
+  const auto mesh = get_sphere_mesh(state.range(0));
+  utils::thread_pool pool;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      auto tree = geometry::bvh::create(*mesh, &pool);
+      benchmark::DoNotOptimize(tree);
+    }
+  }
+  state.counters["threads"] = static_cast<double>(pool.get_thread_count());
+  state.SetItemsProcessed(state.iterations() * mesh->get_face_count());
+}
+
+void bvh_intersect_ray(benchmark::State& state)
+{
+  const auto tree = geometry::bvh::create(*get_sphere_mesh(state.range(0)));
+  const auto rays = create_rays(4096);
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      size_t hit_count = 0;
+      for (const auto& r : rays)
+        hit_count += tree->intersect(r).is_hit();
+      benchmark::DoNotOptimize(hit_count);
+    }
+  }
+  state.counters["depth"] = static_cast<double>(tree->get_depth());
+  state.SetItemsProcessed(state.iterations() * rays.size());
+}
+
+void bvh_query_sphere(benchmark::State& state)
+{
+  const auto tree = geometry::bvh::create(*get_sphere_mesh(state.range(0)));
+  std::vector<u_ptr<geometry::bounding_volume>> spheres;
+  for (const auto& r : create_rays(1024))
+    spheres.emplace_back(geometry::bounding_volume::create_sphere(r.origin / 3.0, 0.05));
+  std::vector<uint32_t> result;
+  for (auto _ : state) {
+    for (const auto& sphere : spheres) {
+      result.clear();
+      tree->query(*sphere, result);
+      benchmark::DoNotOptimize(result.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * spheres.size());
+}
+
+// broad phase of the moving volumes : refit and detect every frame
+void collision_detector_detect_collisions(benchmark::State& state)
+{
+  const auto volumes = create_volumes(state.range(0));
+  physics::collision_detector detector;
+  for (const auto& volume : volumes)
+    detector.add_volume(*volume);
+  detector.update();
+  size_t pair_count = 0;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      detector.update();
+      pair_count = detector.detect_collisions().size();
+    }
+  }
+  state.counters["pairs"] = static_cast<double>(pair_count);
+  state.SetItemsProcessed(state.iterations() * volumes.size());
+}
+
+// all pairs, as a baseline of the broad phase
+void collision_detector_brute_force(benchmark::State& state)
+{
+  const auto volumes = create_volumes(state.range(0));
+  for (auto _ : state) {
+    size_t pair_count = 0;
+    for (size_t i = 0; i < volumes.size(); i++)
+      for (size_t j = i + 1; j < volumes.size(); j++)
+        pair_count += geometry::intersection::test_bv_intersection(*volumes[i], *volumes[j]) > 0;
+    benchmark::DoNotOptimize(pair_count);
+  }
+  state.SetItemsProcessed(state.iterations() * volumes.size());
+}
+
+// up to 130k triangles
+BENCHMARK(bvh_create_from_he_mesh)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK(bvh_create_from_he_mesh_parallel)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(bvh_intersect_ray)->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bvh_query_sphere)->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(collision_detector_detect_collisions)->RangeMultiplier(4)->Range(256, 16384)->Unit(benchmark::kMicrosecond);
+BENCHMARK(collision_detector_brute_force)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMicrosecond);
+
+} // namespace hnll
@@ -0,0 +1,125 @@
+// hnll
+#include <geometry/he_mesh.hpp>
+#include <geometry/dense_he_mesh.hpp>
+#include <utils/thread_pool.hpp>
+#include <geometry/mesh_separation.hpp>
+#include <graphics/meshlet.hpp>
+#include "../perf_counters_bench.hpp"
+#include "sphere_obj.hpp"
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+void he_mesh_create_from_obj_file(benchmark::State& state)
+{
+  const auto path = get_sphere_obj(state.range(0));
+  size_t face_count = 0;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      auto mesh = geometry::he_mesh::create_from_obj_file(path);
+      face_count = mesh->get_face_count();
+      benchmark::DoNotOptimize(mesh);
+    }
+  }
+  state.counters["faces"] = static_cast<double>(face_count);
+  state.SetItemsProcessed(state.iterations() * face_count);
+}
+
+// includes the obj parsing as the serial one
+void he_mesh_create_from_obj_file_parallel(benchmark::State& state)
+{
+  const auto path = get_sphere_obj(state.range(0));
+  utils::thread_pool pool;
+  size_t face_count = 0;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      auto mesh = geometry::he_mesh::create_from_obj_file(pool, path);
+      face_count = mesh->get_face_count();
+      benchmark::DoNotOptimize(mesh);
+    }
+  }
+  state.counters["faces"] = static_cast<double>(face_count);
+  state.counters["threads"] = static_cast<double>(pool.get_thread_count());
+  state.SetItemsProcessed(state.iterations() * face_count);
+}
+
+void dense_he_mesh_create_from_obj_file(benchmark::State& state)
+{
+  const auto path = get_sphere_obj(state.range(0));
+  size_t face_count = 0;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      auto mesh = geometry::dense_he_mesh::create_from_obj_file(path);
+      face_count = mesh->get_face_count();
+      benchmark::DoNotOptimize(mesh);
+    }
+  }
+  state.counters["faces"] = static_cast<double>(face_count);
+  state.SetItemsProcessed(state.iterations() * face_count);
+}
+
+// visits the adjacent faces of every face, as the meshlet separation does
+void he_mesh_traverse_adjacent_faces(benchmark::State& state)
+{
+  const auto mesh = geometry::he_mesh::create_from_obj_file(get_sphere_obj(state.range(0)));
+  for (auto _ : state) {
+    double sum = 0.0;
+    for (geometry::face_id f = 0; f < mesh->get_face_count(); f++) {
+      const auto& normal = mesh->get_face(f).normal;
+      for (const auto& adjacent : mesh->get_adjacent_faces(f))
+        sum += adjacent.normal.dot(normal);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * mesh->get_face_count());
+}
+
+void dense_he_mesh_traverse_adjacent_faces(benchmark::State& state)
+{
+  const auto mesh = geometry::dense_he_mesh::create_from_obj_file(get_sphere_obj(state.range(0)));
+  for (auto _ : state) {
+    double sum = 0.0;
+    for (geometry::face_id f = 0; f < mesh->get_face_count(); f++) {
+      auto he = mesh->get_face_he(f);
+      for (int i = 0; i < 3; i++) {
+        if (!mesh->is_boundary(he))
+          sum += mesh->get_face_normal(mesh->get_he_face(mesh->get_he_pair(he))).dot(mesh->get_face_normal(f));
+        he = mesh->get_he_next(he);
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * mesh->get_face_count());
+}
+
+void mesh_separation_separate_meshletBS(benchmark::State& state)
+{
+  const auto obj_path = get_sphere_obj(state.range(0));
+  const auto mesh = geometry::he_mesh::create_from_obj_file(obj_path);
+  size_t meshlet_count = 0;
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      auto meshlets = geometry::mesh_separation::separate_meshletBS(*mesh);
+      meshlet_count = meshlets.size();
+      benchmark::DoNotOptimize(meshlets);
+    }
+  }
+  state.counters["meshlets"] = static_cast<double>(meshlet_count);
+  state.SetItemsProcessed(state.iterations() * mesh->get_face_count());
+}
+
+// up to 130k triangles
+BENCHMARK(he_mesh_create_from_obj_file)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK(he_mesh_create_from_obj_file_parallel)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(dense_he_mesh_create_from_obj_file)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK(he_mesh_traverse_adjacent_faces)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(dense_he_mesh_traverse_adjacent_faces)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(mesh_separation_separate_meshletBS)->RangeMultiplier(2)->Range(16, 64)->Unit(benchmark::kMillisecond);
+
+} // namespace hnll
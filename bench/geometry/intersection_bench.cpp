@@ -0,0 +1,93 @@
+// hnll
+#include <geometry/intersection.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/primitives.hpp>
+#include <utils/utils.hpp>
+
+// std
+#include <random>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+using namespace geometry;
+
+// random volumes around the frustum, so that both the hit and the miss paths are taken
+constexpr size_t VOLUME_COUNT = 4096;
+
+std::vector<bounding_volume> create_spheres()
+{
+  std::mt19937 engine{ 0 };
+  std::uniform_real_distribution<double> pos(-20.0, 20.0);
+  std::uniform_real_distribution<double> radius(0.1, 3.0);
+  std::vector<bounding_volume> ret;
+  for (size_t i = 0; i < VOLUME_COUNT; i++)
+    ret.emplace_back(vec3d{ pos(engine), pos(engine), pos(engine) }, radius(engine));
+  return ret;
+}
+
+std::vector<bounding_volume> create_aabbs()
+{
+  std::mt19937 engine{ 1 };
+  std::uniform_real_distribution<double> pos(-20.0, 20.0);
+  std::uniform_real_distribution<double> radius(0.1, 3.0);
+  std::vector<bounding_volume> ret;
+  for (size_t i = 0; i < VOLUME_COUNT; i++)
+    ret.emplace_back(vec3d{ pos(engine), pos(engine), pos(engine) }, vec3d{ radius(engine), radius(engine), radius(engine) });
+  return ret;
+}
+
+void intersection_sphere_frustum(benchmark::State& state)
+{
+  const auto spheres = create_spheres();
+  perspective_frustum frustum = { M_PI / 2.f, M_PI / 2.f, 1, 30 };
+  frustum.update_planes(utils::transform{});
+
+  size_t i = 0;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(intersection::test_sphere_frustum(spheres[i++ % VOLUME_COUNT], frustum));
+  state.SetItemsProcessed(state.iterations());
+}
+
+void intersection_sphere_sphere(benchmark::State& state)
+{
+  const auto spheres = create_spheres();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(intersection::test_bv_intersection(spheres[i % VOLUME_COUNT], spheres[(i + 1) % VOLUME_COUNT]));
+    i++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void intersection_aabb_aabb(benchmark::State& state)
+{
+  const auto aabbs = create_aabbs();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(intersection::test_bv_intersection(aabbs[i % VOLUME_COUNT], aabbs[(i + 1) % VOLUME_COUNT]));
+    i++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void intersection_aabb_sphere(benchmark::State& state)
+{
+  const auto aabbs = create_aabbs();
+  const auto spheres = create_spheres();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(intersection::test_bv_intersection(aabbs[i % VOLUME_COUNT], spheres[i % VOLUME_COUNT]));
+    i++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(intersection_sphere_frustum);
+BENCHMARK(intersection_sphere_sphere);
+BENCHMARK(intersection_aabb_aabb);
+BENCHMARK(intersection_aabb_sphere);
+
+} // namespace hnll
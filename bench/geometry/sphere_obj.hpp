@@ -0,0 +1,62 @@
+#pragma once
+
+// std
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace hnll {
+
+// uv sphere written to the temp directory, so that the benchmark doesn't depend on downloaded models.
+// resolution is the segment count along the latitude, the longitude has twice as many.
+// written once per process to a unique name and renamed, so that an interrupted or concurrent run
+// never leaves a partial file at the path. shared by the geometry benchmarks.
+inline std::string get_sphere_obj(int resolution)
+{
+  static std::unordered_map<int, std::string> written_paths;
+  if (auto it = written_paths.find(resolution); it != written_paths.end())
+    return it->second;
+
+  auto path = (std::filesystem::temp_directory_path() / ("hnll_bench_sphere_" + std::to_string(resolution) + ".obj")).string();
+  auto temp_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+  std::ofstream file(temp_path);
+  const int stacks = resolution;
+  const int slices = resolution * 2;
+  // poles are shared by the slices
+  file << "v 0 1 0\n";
+  for (int i = 1; i < stacks; i++) {
+    double phi = M_PI * i / stacks;
+    for (int j = 0; j < slices; j++) {
+      double theta = 2.0 * M_PI * j / slices;
+      file << "v " << std::sin(phi) * std::cos(theta) << ' ' << std::cos(phi) << ' ' << std::sin(phi) * std::sin(theta) << '\n';
+    }
+  }
+  file << "v 0 -1 0\n";
+
+  // 1 origin indices
+  auto ring = [slices](int stack, int slice) { return 2 + (stack - 1) * slices + slice % slices; };
+  const int bottom = 2 + (stacks - 1) * slices;
+  for (int j = 0; j < slices; j++)
+    file << "f 1 " << ring(1, j + 1) << ' ' << ring(1, j) << '\n';
+  for (int i = 1; i < stacks - 1; i++) {
+    for (int j = 0; j < slices; j++) {
+      file << "f " << ring(i, j) << ' ' << ring(i, j + 1) << ' ' << ring(i + 1, j + 1) << '\n';
+      file << "f " << ring(i, j) << ' ' << ring(i + 1, j + 1) << ' ' << ring(i + 1, j) << '\n';
+    }
+  }
+  for (int j = 0; j < slices; j++)
+    file << "f " << ring(stacks - 1, j) << ' ' << ring(stacks - 1, j + 1) << ' ' << bottom << '\n';
+
+  file.close();
+  if (!file)
+    throw std::runtime_error("failed to write " + temp_path);
+  std::filesystem::rename(temp_path, path);
+  written_paths.emplace(resolution, path);
+  return path;
+}
+
+} // namespace hnll
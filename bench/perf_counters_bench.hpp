@@ -0,0 +1,58 @@
+#pragma once
+
+// hnll
+#include <utils/perf_counters.hpp>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+// reports the hardware counters of the benchmark loop as the user counters
+//
+//   for (auto _ : state) { ... }
+//
+// becomes
+//
+//   {
+//     bench_perf_counters counters(state);
+//     for (auto _ : state) { ... }
+//   }
+//
+// nothing is reported if the counters are unavailable (containers, etc.)
+class bench_perf_counters
+{
+  public:
+    explicit bench_perf_counters(benchmark::State& state)
+      : state_(state), group_(utils::perf_counters::get_thread_group())
+    { if (group_) start_ = group_->read(); }
+
+    ~bench_perf_counters()
+    {
+      if (!group_)
+        return;
+      auto delta = group_->read() - start_;
+      for (size_t i = 0; i < utils::PERF_COUNTER_COUNT; i++) {
+        auto counter = static_cast<utils::perf_counter>(i);
+        if (delta.has(counter))
+          state_.counters[utils::perf_counters::get_counter_name(counter)] =
+            benchmark::Counter(static_cast<double>(delta.get(counter)), benchmark::Counter::kAvgIterations);
+      }
+      if (delta.has(utils::perf_counter::CYCLES))
+        state_.counters["ipc"] = delta.get_ipc();
+      if (delta.has(utils::perf_counter::CACHE_REFERENCES))
+        state_.counters["cache_miss_rate"] = delta.get_cache_miss_rate();
+      if (delta.has(utils::perf_counter::BRANCHES))
+        state_.counters["branch_miss_rate"] = delta.get_branch_miss_rate();
+    }
+
+    bench_perf_counters(const bench_perf_counters&) = delete;
+    bench_perf_counters& operator=(const bench_perf_counters&) = delete;
+
+  private:
+    benchmark::State& state_;
+    const utils::perf_counter_group* group_;
+    utils::perf_sample start_;
+};
+
+} // namespace hnll
@@ -0,0 +1,43 @@
+// hnll
+#include "../../examples/heterogeneous_horn/fdtd12_horn.hpp"
+#include "../perf_counters_bench.hpp"
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+// same configuration as examples/heterogeneous_horn/fdtd12.cpp
+constexpr float dx_fdtd = 3.83e-3;
+constexpr float dt = 7.81e-6;
+constexpr float c = 340;
+constexpr float rho = 1.17f;
+
+void fdtd_horn_update(benchmark::State& state)
+{
+  auto horn = fdtd_horn::create(
+    dt,
+    dx_fdtd,
+    rho,
+    c,
+    6, // pml count
+    0.5,
+    { 2, 1, 2, 1, 2 }, // dimensions
+    { {0.1f, 0.04f}, {0.2f, 0.03f}, {0.1f, 0.04f}, {0.1f, 0.03f}, {0.1f, 0.1f}}
+  );
+
+  // cpu step only, the upload to the field buffer needs a device
+  {
+    bench_perf_counters counters(state);
+    for (auto _ : state) {
+      horn->update_field();
+      benchmark::ClobberMemory();
+    }
+  }
+  state.counters["grids"] = horn->get_whole_x() * horn->get_whole_y();
+  state.SetItemsProcessed(state.iterations() * horn->get_whole_x() * horn->get_whole_y());
+}
+
+BENCHMARK(fdtd_horn_update)->Unit(benchmark::kMicrosecond);
+
+} // namespace hnll
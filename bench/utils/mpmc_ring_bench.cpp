@@ -0,0 +1,108 @@
+// hnll
+#include <utils/mpmc_ring.hpp>
+
+// std
+#include <thread>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+// producers (benchmark threads) push to a queue drained by a single consumer thread
+
+constexpr size_t RING_CAPACITY = 1024;
+constexpr size_t BATCH_SIZE = 16;
+
+u_ptr<utils::mpmc_ring<int>> ring;
+u_ptr<utils::mt_deque<int>> deque;
+std::atomic<bool> consumer_done;
+std::thread consumer;
+
+template <typename PopFunc>
+void start_consumer(PopFunc pop)
+{
+  consumer_done = false;
+  consumer = std::thread([pop]() {
+    while (!consumer_done) {
+      if (!pop())
+        std::this_thread::yield();
+    }
+  });
+}
+
+void stop_consumer()
+{
+  consumer_done = true;
+  consumer.join();
+}
+
+void setup_ring(const benchmark::State&)
+{
+  ring = std::make_unique<utils::mpmc_ring<int>>(RING_CAPACITY);
+  start_consumer([]() {
+    int values[BATCH_SIZE];
+    return ring->try_pop_batch(values, BATCH_SIZE) > 0;
+  });
+}
+
+void teardown_ring(const benchmark::State&)
+{
+  // producers may be blocked on a full ring only while running, so the consumer can stop here
+  stop_consumer();
+  ring.reset();
+}
+
+void setup_deque(const benchmark::State&)
+{
+  deque = std::make_unique<utils::mt_deque<int>>();
+  start_consumer([]() { return deque->try_pop_front() != nullptr; });
+}
+
+void teardown_deque(const benchmark::State&)
+{
+  stop_consumer();
+  deque.reset();
+}
+
+void mpmc_ring_push(benchmark::State& state)
+{
+  for (auto _ : state)
+    ring->push(1);
+  state.SetItemsProcessed(state.iterations());
+}
+
+void mpmc_ring_push_batch(benchmark::State& state)
+{
+  int values[BATCH_SIZE] = {};
+  for (auto _ : state)
+    ring->push_batch(values, BATCH_SIZE);
+  state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+void mt_deque_push(benchmark::State& state)
+{
+  for (auto _ : state)
+    deque->push_tail(1);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(mpmc_ring_push)
+  ->Setup(setup_ring)
+  ->Teardown(teardown_ring)
+  ->ThreadRange(1, 16)
+  ->UseRealTime();
+
+BENCHMARK(mpmc_ring_push_batch)
+  ->Setup(setup_ring)
+  ->Teardown(teardown_ring)
+  ->ThreadRange(1, 16)
+  ->UseRealTime();
+
+BENCHMARK(mt_deque_push)
+  ->Setup(setup_deque)
+  ->Teardown(teardown_deque)
+  ->ThreadRange(1, 16)
+  ->UseRealTime();
+
+} // namespace hnll
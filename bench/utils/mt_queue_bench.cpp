@@ -0,0 +1,74 @@
+// hnll
+#include <utils/mt_queue.hpp>
+
+// std
+#include <thread>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+// contention between one owner (thread 0) and thieves (other threads).
+// the owner pushes every iteration and pops every other iteration, thieves keep stealing.
+
+u_ptr<utils::ws_deque<int>> ws_queue;
+u_ptr<utils::mt_deque<int>> mt_queue;
+
+void setup_ws_deque(const benchmark::State&)    { ws_queue = std::make_unique<utils::ws_deque<int>>(); }
+void teardown_ws_deque(const benchmark::State&) { ws_queue.reset(); }
+void setup_mt_deque(const benchmark::State&)    { mt_queue = std::make_unique<utils::mt_deque<int>>(); }
+void teardown_mt_deque(const benchmark::State&) { mt_queue.reset(); }
+
+void ws_deque_owner_and_thieves(benchmark::State& state)
+{
+  int i = 0;
+  if (state.thread_index() == 0) {
+    for (auto _ : state) {
+      ws_queue->push(i);
+      if (i++ & 1)
+        benchmark::DoNotOptimize(ws_queue->pop());
+    }
+  }
+  else {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(ws_queue->steal());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void mt_deque_owner_and_thieves(benchmark::State& state)
+{
+  int i = 0;
+  if (state.thread_index() == 0) {
+    for (auto _ : state) {
+      int value = i;
+      mt_queue->push_front(std::move(value));
+      if (i++ & 1)
+        benchmark::DoNotOptimize(mt_queue->try_pop_front());
+    }
+  }
+  else {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(mt_queue->try_pop_back());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+const int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+BENCHMARK(ws_deque_owner_and_thieves)
+  ->Setup(setup_ws_deque)
+  ->Teardown(teardown_ws_deque)
+  ->DenseThreadRange(1, max_threads)
+  ->UseRealTime();
+
+BENCHMARK(mt_deque_owner_and_thieves)
+  ->Setup(setup_mt_deque)
+  ->Teardown(teardown_mt_deque)
+  ->DenseThreadRange(1, max_threads)
+  ->UseRealTime();
+
+} // namespace hnll
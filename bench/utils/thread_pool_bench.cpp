@@ -0,0 +1,57 @@
+// hnll
+#include <utils/thread_pool.hpp>
+
+// std
+#include <atomic>
+
+// lib
+#include <benchmark/benchmark.h>
+
+namespace hnll {
+
+constexpr int TASK_BATCH = 1024;
+
+// round trip of a single task : push, wake a worker, run, fulfill the future
+void thread_pool_submit_get(benchmark::State& state)
+{
+  utils::thread_pool pool(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(pool.submit([]() { return 1; }).get());
+  state.SetItemsProcessed(state.iterations());
+}
+
+// tasks from the main thread go through the global queue
+void thread_pool_spawn_batch(benchmark::State& state)
+{
+  utils::thread_pool pool(state.range(0));
+  std::atomic<int> counter = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < TASK_BATCH; i++)
+      pool.spawn([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    pool.wait_for_all_tasks();
+  }
+  benchmark::DoNotOptimize(counter.load());
+  state.SetItemsProcessed(state.iterations() * TASK_BATCH);
+}
+
+// a worker spawns the batch into its local queue, the other workers have to steal them
+void thread_pool_steal(benchmark::State& state)
+{
+  utils::thread_pool pool(state.range(0));
+  std::atomic<int> counter = 0;
+  for (auto _ : state) {
+    pool.spawn([&pool, &counter]() {
+      for (int i = 0; i < TASK_BATCH; i++)
+        pool.spawn([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    });
+    pool.wait_for_all_tasks();
+  }
+  benchmark::DoNotOptimize(counter.load());
+  state.SetItemsProcessed(state.iterations() * TASK_BATCH);
+}
+
+BENCHMARK(thread_pool_submit_get)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK(thread_pool_spawn_batch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(thread_pool_steal)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+} // namespace hnll
@@ -5,6 +5,7 @@
 #include <game/compute_shader.hpp>
 #include <audio/engine.hpp>
 #include <audio/audio_data.hpp>
+#include <utils/scope_stats.hpp>
 #include <utils/utils.hpp>
 #include "obj_converter.hpp"
 
@@ -426,7 +427,7 @@ DEFINE_ENGINE(curved_fdtd_1d)
             offsets.emplace_back(field_buffer[i].y_offset);
           }
           convert_to_obj(std::string(getenv("HNLL_ENGN")) + OBJ_DIR, "test", DX, BORE_THICKNESS, MOUTHPIECE_LENGTH - MOUTHPIECE_BORE_INTERSECTION, offsets, hole_ids_, HOLE_RADIUS);
-          std::cout << "conversion completed." << std::endl;
+          HNLL_LOG_INFO("conversion completed.");
         });
         convert_thread.detach();
       }
@@ -446,6 +447,7 @@ DEFINE_ENGINE(curved_fdtd_1d)
   private:
     void update_sound()
     {
+      HNLL_STAT_SCOPE("audio update");
       audio::engine::erase_finished_audio_on_queue(source_);
 
       static const int queue_capacity = 2;
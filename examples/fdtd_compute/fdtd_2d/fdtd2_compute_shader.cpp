@@ -3,6 +3,7 @@
 #include "include/fdtd2_field.hpp"
 #include "include/fdtd2_compute_shader.hpp"
 #include <utils/singleton.hpp>
+#include <utils/profiler.hpp>
 
 namespace hnll {
 
@@ -54,7 +55,7 @@ void fdtd2_compute_shader::render(const utils::compute_frame_info& info)
     };
 
     {
-      utils::scope_timer timer {"task dispatch"};
+      HNLL_PROFILE_SCOPE("task dispatch");
       // update velocity and pressure
       bind_pipeline(command);
 
@@ -5,6 +5,7 @@
 #include "include/fdtd2_shading_system.hpp"
 #include <audio/engine.hpp>
 #include <audio/audio_data.hpp>
+#include <utils/scope_stats.hpp>
 #include "../serial.hpp"
 
 // std
@@ -150,6 +151,7 @@ DEFINE_ENGINE(fdtd_2d)
 
     void update_sound()
     {
+      HNLL_STAT_SCOPE("audio update");
       static int frame_index = 0;
       constexpr auto frame_count = utils::FRAMES_IN_FLIGHT;
 
@@ -5,6 +5,7 @@
 #include "include/fdtd_cylindrical_shading_system.hpp"
 #include <audio/engine.hpp>
 #include <audio/audio_data.hpp>
+#include <utils/scope_stats.hpp>
 
 // std
 #include <thread>
@@ -104,6 +105,7 @@ DEFINE_ENGINE(fdtd_cylindrical)
 
     void update_sound()
     {
+      HNLL_STAT_SCOPE("audio update");
       audio::engine::erase_finished_audio_on_queue(source_);
 
       if (audio::engine::get_audio_count_on_queue(source_) > queue_capacity_)
@@ -3,6 +3,7 @@
 #include "include/fdtd_cylindrical_field.hpp"
 #include "include/fdtd_cylindrical_compute_shader.hpp"
 #include <utils/singleton.hpp>
+#include <utils/profiler.hpp>
 
 namespace hnll {
 
@@ -48,7 +49,7 @@ void fdtd_cylindrical_compute_shader::render(const utils::compute_frame_info& in
     };
 
     {
-      utils::scope_timer timer {"task dispatch"};
+      HNLL_PROFILE_SCOPE("task dispatch");
       // update velocity and pressure
       bind_pipeline(command);
 
@@ -2,6 +2,7 @@
 #include "fdtd12_horn.hpp"
 #include <graphics/buffer.hpp>
 #include <utils/rendering_utils.hpp>
+#include <utils/perf_counters.hpp>
 
 #define ID2(x, y) x + y * whole_x_
 
@@ -253,16 +254,22 @@ void fdtd_horn::build_desc(graphics::device &device)
 
 void fdtd_horn::update(int frame_index)
 {
-  frame_count_++;
-
-  update_velocity();
-  update_pressure();
+  update_field();
 
   // update field buffer
   desc_sets_->write_to_buffer(0, 0, frame_index, field_.data());
   desc_sets_->flush_buffer(0, 0, frame_index);
 }
 
+void fdtd_horn::update_field()
+{
+  HNLL_PERF_SCOPE("fdtd horn update");
+  frame_count_++;
+
+  update_velocity();
+  update_pressure();
+}
+
 void fdtd_horn::update_element(const std::vector<int>& ids, const std::function<void(int, int, int)>& func)
 {
   for (const auto& id : ids) {
@@ -50,7 +50,10 @@ class fdtd_horn
       std::vector<int> dimensions,
       std::vector<vec2> sizes);
 
+    // cpu step and upload of the field
     void update(int frame_index);
+    // cpu step only, doesn't touch the gpu
+    void update_field();
 
     // graphics process
     void build_desc(graphics::device& device);
@@ -1,5 +1,6 @@
 // hnll
 #include "../fdtd12_horn.hpp"
+#include <utils/logger.hpp>
 
 // lib
 #include <gtest/gtest.h>
@@ -59,7 +60,7 @@ TEST(fdtd12_horn, ctor)
   };
 
   for (int i = 0; i < 50; i++) {
-    std::cout << i << std::endl;
+    HNLL_LOG_DEBUG("grid cell ", i);
     EXPECT_EQ(grid_conditions[i].x(), test_grid_types[i]);
   }
 
@@ -9,6 +9,7 @@
 #include <graphics/utils.hpp>
 #include <utils/vulkan_config.hpp>
 #include <utils/utils.hpp>
+#include <utils/profiler.hpp>
 
 // std
 #include <iostream>
@@ -60,13 +61,15 @@ class hello_model {
     {
       while (glfwWindowShouldClose(window_->get_glfw_window()) == GLFW_FALSE) {
         {
-          utils::scope_timer timer{"fps", utils::timer_type::MILLI};
+          HNLL_PROFILE_SCOPE("frame");
           glfwPollEvents();
           update();
           render();
         }
+        HNLL_PROFILE_COLLECT();
       }
       vkDeviceWaitIdle(device_->get_device());
+      HNLL_PROFILE_WRITE(utils::create_cache_directory() + "/trace.json");
       cleanup();
     }
 
@@ -5,6 +5,13 @@
 #include <game/modules/compute_engine.hpp>
 #include <graphics/graphics_model.hpp>
 #include <utils/common_alias.hpp>
+#include <utils/frame_arena.hpp>
+#include <utils/frame_pacer.hpp>
+#include <utils/memory_tracker.hpp>
+#include <utils/perf_counters.hpp>
+#include <utils/profiler.hpp>
+#include <utils/scope_stats.hpp>
+#include <utils/utils.hpp>
 #include <utils/vulkan_config.hpp>
 #include <utils/singleton.hpp>
 
@@ -44,15 +51,15 @@ class engine_core
 
     void begin_imgui();
 
-    float get_dt();
-    inline const std::chrono::system_clock::time_point& get_old_time() const { return old_time_; };
-    inline void set_old_time(std::chrono::system_clock::time_point&& time) { old_time_ = std::move(time); }
+    // sleeps until the next frame, max_fps caps the rate
+    float get_dt() { return frame_pacer_.wait_for_next_frame(); }
+    inline const utils::frame_pacer& get_frame_pacer() const { return frame_pacer_; }
 
     inline const utils::viewer_info& get_viewer_info() const { return viewer_info_; }
     static inline void set_viewer_info(utils::viewer_info&& v) { viewer_info_ = std::move(v); }
 
-    float get_max_fps() const { return max_fps_; }
-    void set_max_fps(float max_fps) { max_fps_ = max_fps; }
+    float get_max_fps() const { return frame_pacer_.get_max_fps(); }
+    void set_max_fps(float max_fps) { frame_pacer_.set_max_fps(max_fps); }
 
     // glfw
     vec2 get_cursor_pos() const;
@@ -72,9 +79,8 @@ class engine_core
 #ifndef IMGUI_DISABLED
     utils::single_ptr<gui_engine> gui_engine_;
 #endif
-    std::chrono::system_clock::time_point old_time_;
+    utils::frame_pacer frame_pacer_{ 60.f };
     static utils::viewer_info viewer_info_;
-    float max_fps_ = 60.f;
 };
 
 // parametric impl
@@ -120,6 +126,7 @@ class engine_base<Derived, shading_system_list<S...>, actor_list<A...>, compute_
     // common part
     utils::single_ptr<utils::vulkan_config> vulkan_config_;
     utils::single_ptr<graphics_engine_core> graphics_engine_core_;
+    utils::single_ptr<utils::frame_arena> frame_arena_;
 
     float dt_;
 
@@ -147,6 +154,7 @@ ENGN_API typename ENGN_TYPE::actor_map ENGN_TYPE::update_target_actors_;
 ENGN_API ENGN_TYPE::engine_base(const std::string &application_name, utils::vulkan_config vk_config)
  : vulkan_config_(utils::singleton<utils::vulkan_config>::build_instance(vk_config)),
    graphics_engine_core_(utils::singleton<graphics_engine_core>::build_instance(application_name)),
+   frame_arena_(utils::singleton<utils::frame_arena>::build_instance()),
    core_(utils::singleton<engine_core>::build_instance(application_name))
 {
   graphics_engine_ = graphics_engine<S...>::create(application_name);
@@ -169,18 +177,45 @@ ENGN_API ENGN_TYPE::~engine_base()
 
 ENGN_API void ENGN_TYPE::run()
 {
+  HNLL_PROFILE_THREAD_NAME("main");
+  HNLL_PERF_THREAD_NAME("main");
   while (!graphics_engine_core_->should_close_window()) {
-    glfwPollEvents();
-    update();
-    render();
+    {
+      HNLL_PROFILE_SCOPE("frame");
+      HNLL_STAT_SCOPE("frame");
+      HNLL_PERF_SCOPE("frame");
+      glfwPollEvents();
+      // frame-local allocations of the oldest frame in flight are released here
+      frame_arena_->begin_frame();
+      update();
+      render();
+    }
+    // move the events out of the per-thread buffers before they fill up
+    HNLL_PROFILE_COLLECT();
+    // summarize the scope statistics every N frames
+    HNLL_STAT_END_FRAME();
+    // allocations per frame of each subsystem
+    HNLL_MEMORY_END_FRAME();
   }
   graphics_engine_core_->wait_idle();
+  HNLL_PROFILE_WRITE(utils::create_cache_directory() + "/trace.json");
+  HNLL_STAT_WRITE_JSON(utils::create_cache_directory() + "/scope_stats.json");
+  HNLL_MEMORY_WRITE_CSV(utils::create_cache_directory() + "/memory.csv");
+  HNLL_PERF_WRITE_CSV(utils::create_cache_directory() + "/perf_counters.csv");
 }
 
 ENGN_API void ENGN_TYPE::update()
 {
   // calc delta time
-  dt_ = core_->get_dt();
+  {
+    HNLL_PROFILE_SCOPE("wait for next frame");
+    dt_ = core_->get_dt();
+  }
+  HNLL_PROFILE_SCOPE("update");
+  HNLL_STAT_SCOPE("update");
+  HNLL_PERF_SCOPE("update");
+  HNLL_PROFILE_COUNTER("dt [ms]", dt_ * 1000.f);
+  HNLL_MEMORY_SCOPE(GAME);
 
   core_->begin_imgui();
 
@@ -193,9 +228,16 @@ ENGN_API void ENGN_TYPE::update()
 
 ENGN_API void ENGN_TYPE::render()
 {
-  if constexpr (sizeof...(C) >= 1)
+  if constexpr (sizeof...(C) >= 1) {
+    HNLL_PROFILE_SCOPE("compute");
+    HNLL_STAT_SCOPE("compute");
+    HNLL_PERF_SCOPE("compute");
     compute_engine_->render(dt_);
+  }
 
+  HNLL_PROFILE_SCOPE("render");
+  HNLL_STAT_SCOPE("render");
+  HNLL_PERF_SCOPE("render");
   utils::game_frame_info game_frame_info = { 0, core_->get_viewer_info() };
   graphics_engine_->render(game_frame_info);
   core_->render_gui();
@@ -4,6 +4,8 @@
 #include <utils/common_alias.hpp>
 #include <utils/vulkan_config.hpp>
 #include <utils/singleton.hpp>
+#include <utils/profiler.hpp>
+#include <utils/scope_stats.hpp>
 #include <game/concepts.hpp>
 #include <graphics/device.hpp>
 #include <graphics/timeline_semaphore.hpp>
@@ -92,8 +94,11 @@ CMPT_ENGN_API void CMPT_ENGN_TYPE::render(float dt)
   };
 
   // visit all active shaders
-  for (auto &shader : shaders_) {
-    std::visit([&frame_info](auto &shader) { shader->render(frame_info); }, shader.second);
+  {
+    HNLL_STAT_SCOPE("record compute shaders");
+    for (auto &shader : shaders_) {
+      std::visit([&frame_info](auto &shader) { shader->render(frame_info); }, shader.second);
+    }
   }
 
   end_frame();
@@ -110,7 +115,11 @@ CMPT_ENGN_API void CMPT_ENGN_TYPE::begin_frame()
   wait_info.pSemaphores = compute_semaphore_.get_vk_semaphore_r();
   wait_info.pValues = &semaphore_value_cache_[current_frame_index_];
 
-  vkWaitSemaphores(device_->get_device(), &wait_info, std::numeric_limits<uint64_t>::max());
+  {
+    HNLL_PROFILE_SCOPE("wait for compute");
+    HNLL_STAT_SCOPE("wait for compute");
+    vkWaitSemaphores(device_->get_device(), &wait_info, std::numeric_limits<uint64_t>::max());
+  }
 
   // begin command recording
   VkCommandBufferBeginInfo begin_info{};
@@ -7,6 +7,8 @@
 #include <utils/common_alias.hpp>
 #include <utils/singleton.hpp>
 #include <utils/frame_info.hpp>
+#include <utils/profiler.hpp>
+#include <utils/scope_stats.hpp>
 #include <utils/vulkan_config.hpp>
 
 #ifndef IMGUI_DISABLED
@@ -66,6 +68,11 @@ class graphics_engine_core
     static M& get_graphics_model(const std::string& name)
     { return model_pool_->get_model<M>(name); }
 
+    // the model becomes ready at the beginning of a later frame
+    template <graphics::GraphicsModel M>
+    static graphics::model_request<M> request_graphics_model(const std::string& name)
+    { return model_pool_->request_model<M>(name); }
+
     bool should_close_window() const;
     GLFWwindow* get_glfw_window() const ;
     graphics::renderer& get_renderer_r();
@@ -151,7 +158,15 @@ GRPH_ENGN_API GRPH_ENGN_TYPE::graphics_engine(const std::string &application_nam
 
 GRPH_ENGN_API void GRPH_ENGN_TYPE::render(const utils::game_frame_info& frame_info)
 {
-  if (core_->begin_frame()) {
+  bool frame_started;
+  {
+    // waits for the fence of the frame in flight and acquires the swap chain image
+    HNLL_PROFILE_SCOPE("acquire image");
+    HNLL_STAT_SCOPE("acquire image");
+    frame_started = core_->begin_frame();
+  }
+
+  if (frame_started) {
     int frame_index = core_->get_frame_index();
 
     // update
@@ -192,10 +207,16 @@ GRPH_ENGN_API void GRPH_ENGN_TYPE::render(const utils::game_frame_info& frame_in
       {}
     };
 
-    for (auto& system_kv : shading_systems_) {
-      std::visit([&graphics_frame_info](auto& system) { system->render(graphics_frame_info); }, system_kv.second);
+    {
+      HNLL_PROFILE_SCOPE("record shading systems");
+      HNLL_STAT_SCOPE("record shading systems");
+      for (auto& system_kv : shading_systems_) {
+        std::visit([&graphics_frame_info](auto& system) { system->render(graphics_frame_info); }, system_kv.second);
+      }
     }
 
+    HNLL_PROFILE_SCOPE("submit and present");
+    HNLL_STAT_SCOPE("submit and present");
     if (rendering_type_ != utils::rendering_type::RAY_TRACING) {
       core_->end_render_pass_and_frame(command_buffer);
     }
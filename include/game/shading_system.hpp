@@ -9,6 +9,7 @@
 #include <utils/singleton.hpp>
 
 // std
+#include <span>
 #include <unordered_map>
 
 #define DEFINE_SHADING_SYSTEM(new_system, rc) class new_system : public game::shading_system<new_system, rc>
@@ -84,7 +85,9 @@ class shading_system {
 
     void bind_pipeline();
 
-    void bind_desc_sets(const std::vector<VkDescriptorSet>& desc_sets);
+    void bind_desc_sets(std::span<const VkDescriptorSet> desc_sets);
+    void bind_desc_sets(const std::vector<VkDescriptorSet>& desc_sets)
+    { bind_desc_sets(std::span<const VkDescriptorSet>(desc_sets)); }
 
     template <typename PushConstants>
     void bind_push(const PushConstants& push, VkShaderStageFlags stages);
@@ -212,7 +215,7 @@ SS_API void SS_TYPE::set_current_command_buffer(VkCommandBuffer command)
 SS_API void SS_TYPE::bind_pipeline()
 { pipeline_->bind(current_command_); }
 
-SS_API void SS_TYPE::bind_desc_sets(const std::vector<VkDescriptorSet> &desc_sets)
+SS_API void SS_TYPE::bind_desc_sets(std::span<const VkDescriptorSet> desc_sets)
 {
   vkCmdBindDescriptorSets(
     current_command_,
@@ -4,6 +4,11 @@
 #include <utils/utils.hpp>
 #include <utils/common_alias.hpp>
 
+// std
+#include <cassert>
+#include <ranges>
+#include <span>
+
 namespace hnll {
 
 namespace geometry {
@@ -30,10 +35,13 @@ class bounding_volume
 
     // for aabb
     // currently bounding_volumes are owned only by rigid_component
-    static u_ptr<bounding_volume> create_aabb(const std::vector<vec3d> &vertices);
+    // any range of positions without copying, e.g. a vector or he_mesh::get_positions()
+    template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, const vec3d&>
+    static u_ptr<bounding_volume> create_aabb(R&& positions);
     static u_ptr<bounding_volume> create_aabb(const vec3d& center, const vec3d& radius);
     // for sphere
-    static u_ptr<bounding_volume> create_sphere(const std::vector<vec3d>& vertices);
+    static u_ptr<bounding_volume> create_sphere(std::span<const vec3d> vertices);
     static u_ptr<bounding_volume> create_sphere(const vec3d& center, const double radius);
     // for mesh separation
     static u_ptr<bounding_volume> create_empty_bv(bv_type type, const vec3d& initial_point = {0.f, 0.f, 0.f});
@@ -69,8 +77,26 @@ class bounding_volume
     bv_type type_;
 };
 
+template <std::ranges::input_range R>
+requires std::convertible_to<std::ranges::range_reference_t<R>, const vec3d&>
+u_ptr<bounding_volume> bounding_volume::create_aabb(R&& positions)
+{
+  auto it = std::ranges::begin(positions);
+  const auto end = std::ranges::end(positions);
+  assert(it != end && "aabb needs at least one point.");
+
+  vec3d min = *it;
+  vec3d max = min;
+  for (++it; it != end; ++it) {
+    const vec3d& position = *it;
+    min = min.cwiseMin(position);
+    max = max.cwiseMax(position);
+  }
+  return std::make_unique<bounding_volume>((max + min) / 2, (max - min) / 2);
+}
+
 // support functions
-std::pair<int, int> most_separated_points_on_aabb(const std::vector<vec3d> &vertices);
+std::pair<int, int> most_separated_points_on_aabb(std::span<const vec3d> vertices);
 
 } // namespace geometry
 } // namespace hnll
\ No newline at end of file
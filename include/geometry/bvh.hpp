@@ -0,0 +1,113 @@
+#pragma once
+
+// hnll
+#include <geometry/primitives.hpp>
+
+// std
+#include <array>
+#include <limits>
+#include <span>
+#include <vector>
+
+// forward declaration
+namespace hnll::utils { class thread_pool; }
+
+namespace hnll::geometry {
+
+class bounding_volume;
+class he_mesh;
+
+struct ray
+{
+  vec3d origin;
+  // needn't be normalized, t is measured in the length of the direction
+  vec3d direction;
+};
+
+struct ray_hit
+{
+  // index of the triangle or the volume given to the bvh, NULL_ID for a miss
+  uint32_t primitive = NULL_ID;
+  double t = std::numeric_limits<double>::infinity();
+  // barycentric coordinates of the hit point (triangles only)
+  double u = 0.0;
+  double v = 0.0;
+
+  bool is_hit() const { return primitive != NULL_ID; }
+};
+
+// bounding volume hierarchy over triangles or bounding volumes.
+// built with the binned sah (in parallel on thread_pool if given),
+// and flattened in the depth first order so that the first child always follows its parent.
+class bvh
+{
+  public:
+    enum class primitive_type { TRIANGLE, VOLUME };
+
+    // 32 bytes, two nodes per cache line
+    struct node
+    {
+      // bounds are rounded outward from the double precision ones
+      vec3     min;
+      // leaf : first primitive, inner : index of the second child
+      uint32_t offset;
+      vec3     max;
+      // primitive count, 0 for inner nodes
+      uint16_t count;
+      // split axis of inner nodes, the child on the negative side comes first
+      uint16_t axis;
+
+      bool is_leaf() const { return count > 0; }
+    };
+
+    static constexpr uint32_t BIN_COUNT     = 16;
+    static constexpr uint32_t MAX_LEAF_SIZE = 8;
+    // relative to the cost of a primitive test
+    static constexpr double   TRAVERSAL_COST = 1.0;
+
+    // primitive ids are the triangle indices (index / 3)
+    static u_ptr<bvh> create(std::span<const vec3d> positions, std::span<const vertex_id> indices, utils::thread_pool* pool = nullptr);
+    // primitive ids are the face ids
+    static u_ptr<bvh> create(const he_mesh& mesh, utils::thread_pool* pool = nullptr);
+    // primitive ids are the indices of the span.
+    // the volumes are referred, so they must outlive the bvh, and refit() follows their movement
+    static u_ptr<bvh> create(std::span<const bounding_volume* const> volumes, utils::thread_pool* pool = nullptr);
+
+    bvh() = default;
+
+    // closest hit in [0, t_max)
+    ray_hit intersect(const ray& r, double t_max = std::numeric_limits<double>::infinity()) const;
+    // appends the primitives which intersect with the sphere or the aabb
+    void query(const bounding_volume& volume, std::vector<uint32_t>& primitives) const;
+
+    // updates the bounds to the current volumes without changing the topology.
+    // the tree gets looser as they move, rebuild it once in a while
+    void refit();
+
+    // getter
+    primitive_type get_primitive_type() const { return type_; }
+    size_t get_primitive_count() const { return primitive_ids_.size(); }
+    size_t get_node_count() const { return nodes_.size(); }
+    uint32_t get_depth() const { return depth_; }
+    std::span<const node> get_nodes() const { return nodes_; }
+    // leaf order -> primitive id
+    std::span<const uint32_t> get_primitive_ids() const { return primitive_ids_; }
+
+  private:
+    using triangle = std::array<vec3d, 3>;
+
+    static u_ptr<bvh> create_from_triangles(std::vector<triangle>&& triangles, std::vector<uint32_t>&& ids, utils::thread_pool* pool);
+
+    bool intersect_primitive(uint32_t index, const ray& r, ray_hit& hit) const;
+    bool overlap_primitive(uint32_t index, const bounding_volume& volume) const;
+
+    primitive_type type_ = primitive_type::TRIANGLE;
+    std::vector<node> nodes_;
+    std::vector<uint32_t> primitive_ids_;
+    // in the leaf order, only one of them is used
+    std::vector<triangle> triangles_;
+    std::vector<const bounding_volume*> volumes_;
+    uint32_t depth_ = 0;
+};
+
+} // namespace hnll::geometry
@@ -0,0 +1,90 @@
+#pragma once
+
+// hnll
+#include <geometry/primitives.hpp>
+
+// std
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+
+// forward declaration
+namespace hnll::graphics { struct vertex; }
+
+namespace hnll::geometry {
+
+// half-edge mesh of triangles on contiguous index based arrays (structure of arrays).
+//
+// ids are the indices into the arrays and stay valid as long as the mesh lives:
+// the vertex ids are the indices of the vertex buffer, the face ids are the triangle indices,
+// and the half-edges of face f are 3f, 3f + 1 and 3f + 2 starting from its first vertex.
+// these are the same ids as he_mesh::create_from_obj_file assigns.
+// a boundary half-edge has NULL_ID as its pair.
+class dense_he_mesh
+{
+  public:
+    static u_ptr<dense_he_mesh> create_from_obj_file(const std::string& filename);
+    // indices are a triangle list, normals may be empty
+    static u_ptr<dense_he_mesh> create(
+      std::vector<vec3d>&& positions,
+      std::vector<vec3d>&& normals,
+      const std::vector<vertex_id>& indices);
+    static u_ptr<dense_he_mesh> create(const std::vector<graphics::vertex>& vertices, const std::vector<vertex_id>& indices);
+
+    dense_he_mesh() = default;
+
+    size_t get_vertex_count()    const { return positions_.size(); }
+    size_t get_face_count()      const { return face_normals_.size(); }
+    size_t get_half_edge_count() const { return he_vertex_.size(); }
+
+    // vertex
+    const vec3d& get_position(vertex_id v) const { return positions_[v]; }
+    const vec3d& get_normal(vertex_id v)   const { return normals_[v]; }
+    // the first half-edge starting from the vertex, NULL_ID if the vertex is isolated
+    half_edge_id get_vertex_he(vertex_id v) const { return vertex_he_[v]; }
+
+    // face
+    const vec3d& get_face_normal(face_id f) const { return face_normals_[f]; }
+    half_edge_id get_face_he(face_id f) const { return static_cast<half_edge_id>(f * 3); }
+    std::array<vertex_id, 3> get_face_vertices(face_id f) const
+    { return { he_vertex_[f * 3], he_vertex_[f * 3 + 1], he_vertex_[f * 3 + 2] }; }
+
+    // half-edge
+    vertex_id    get_he_vertex(half_edge_id he) const { return he_vertex_[he]; }          // start point
+    vertex_id    get_he_target(half_edge_id he) const { return he_vertex_[he_next_[he]]; } // end point
+    half_edge_id get_he_next(half_edge_id he)   const { return he_next_[he]; }
+    half_edge_id get_he_prev(half_edge_id he)   const { return he_next_[he_next_[he]]; }
+    half_edge_id get_he_pair(half_edge_id he)   const { return he_pair_[he]; }
+    face_id      get_he_face(half_edge_id he)   const { return he_face_[he]; }
+    bool         is_boundary(half_edge_id he)   const { return he_pair_[he] == NULL_ID; }
+
+    // whole arrays, for the bulk processing
+    std::span<const vec3d>        get_positions()    const { return positions_; }
+    std::span<const vec3d>        get_normals()      const { return normals_; }
+    std::span<const vec3d>        get_face_normals() const { return face_normals_; }
+    std::span<const vertex_id>    get_he_vertices()  const { return he_vertex_; }
+    std::span<const half_edge_id> get_he_nexts()     const { return he_next_; }
+    std::span<const half_edge_id> get_he_pairs()     const { return he_pair_; }
+    std::span<const face_id>      get_he_faces()     const { return he_face_; }
+
+  private:
+    void build_topology(const std::vector<vertex_id>& indices);
+    void pair_half_edges();
+
+    // vertex
+    std::vector<vec3d> positions_;
+    std::vector<vec3d> normals_;
+    std::vector<half_edge_id> vertex_he_;
+
+    // face
+    std::vector<vec3d> face_normals_;
+
+    // half-edge
+    std::vector<vertex_id>    he_vertex_;
+    std::vector<half_edge_id> he_next_;
+    std::vector<half_edge_id> he_pair_;
+    std::vector<face_id>      he_face_;
+};
+
+} // namespace hnll::geometry
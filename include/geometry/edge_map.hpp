@@ -0,0 +1,105 @@
+#pragma once
+
+// hnll
+#include <geometry/primitives.hpp>
+
+// std
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hnll::geometry {
+
+// directed edge (start, end) -> half-edge id, for pairing the twin half-edges.
+// open addressing with linear probing on a flat array keyed by the packed vertex ids,
+// so that an insert or a lookup hashes a single integer and usually touches a single cache line.
+class edge_map
+{
+  public:
+    explicit edge_map(size_t expected_count = 0) { reserve(expected_count); }
+
+    static uint64_t make_key(vertex_id start, vertex_id end)
+    { return (static_cast<uint64_t>(start) << 32) | end; }
+
+    // keeps the load factor below 1/2 without rehashing up to expected_count edges
+    void reserve(size_t expected_count)
+    {
+      auto capacity = std::bit_ceil(std::max<size_t>(expected_count * 2, MIN_CAPACITY));
+      if (capacity > slots_.size())
+        rehash(capacity);
+    }
+
+    // returns the registered half-edge and true if it's newly registered,
+    // the first registration is kept for the duplicated (non-manifold) edges.
+    std::pair<half_edge_id, bool> emplace(vertex_id start, vertex_id end, half_edge_id he)
+    {
+      if ((size_ + 1) * 2 > slots_.size())
+        rehash(slots_.size() * 2);
+      auto key = make_key(start, end);
+      for (auto i = get_index(key);; i = (i + 1) & mask_) {
+        auto& s = slots_[i];
+        if (s.key == EMPTY_KEY) {
+          s = { key, he };
+          size_++;
+          return { he, true };
+        }
+        if (s.key == key)
+          return { s.he, false };
+      }
+    }
+
+    // NULL_ID if the edge is not registered
+    half_edge_id find(vertex_id start, vertex_id end) const
+    {
+      auto key = make_key(start, end);
+      for (auto i = get_index(key);; i = (i + 1) & mask_) {
+        const auto& s = slots_[i];
+        if (s.key == key)
+          return s.he;
+        if (s.key == EMPTY_KEY)
+          return NULL_ID;
+      }
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear() { slots_.assign(slots_.size(), slot{}); size_ = 0; }
+
+  private:
+    // both of the ids are NULL_ID, never a valid edge
+    static constexpr uint64_t EMPTY_KEY = ~uint64_t(0);
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    struct slot
+    {
+      uint64_t key = EMPTY_KEY;
+      half_edge_id he = NULL_ID;
+    };
+
+    // fibonacci hashing, the upper bits mix both of the ids
+    size_t get_index(uint64_t key) const { return (key * 0x9E3779B97F4A7C15ull) >> shift_; }
+
+    void rehash(size_t capacity)
+    {
+      auto old_slots = std::move(slots_);
+      slots_.assign(capacity, slot{});
+      mask_ = capacity - 1;
+      shift_ = 64 - std::countr_zero(capacity);
+      for (const auto& s : old_slots) {
+        if (s.key == EMPTY_KEY)
+          continue;
+        auto i = get_index(s.key);
+        while (slots_[i].key != EMPTY_KEY)
+          i = (i + 1) & mask_;
+        slots_[i] = s;
+      }
+    }
+
+    std::vector<slot> slots_;
+    size_t size_ = 0;
+    size_t mask_ = 0;
+    int shift_ = 64;
+};
+
+} // namespace hnll::geometry
@@ -3,23 +3,12 @@
 // hnll
 #include <geometry/primitives.hpp>
 #include <geometry/bounding_volume.hpp>
+#include <geometry/edge_map.hpp>
 #include <graphics/utils.hpp>
 
-// hash for half edge map
-namespace std {
-template<>
-struct hash<std::pair<hnll::geometry::vertex, hnll::geometry::vertex>>
-{
-  size_t operator() (const std::pair<hnll::geometry::vertex, hnll::geometry::vertex>& vertex_pair) const
-  {
-    size_t seed = 0;
-    // only positions of vertex matter for half edge
-    hnll::graphics::hash_combine(seed, vertex_pair.first.position, vertex_pair.second.position, vertex_pair.first.normal, vertex_pair.second.normal);
-    return seed;
-  }
-};
-
-} // namespace std
+// std
+#include <iterator>
+#include <ranges>
 
 // forward declaration
 namespace hnll::graphics
@@ -29,14 +18,74 @@ namespace hnll::graphics
   struct mesh_builder;
   namespace frame_anim_utils { struct dynamic_attributes; }
 }
+namespace hnll::utils { class thread_pool; }
 
 namespace hnll::geometry {
 
+class he_mesh;
+
+// circulates the half-edges of a face (next), or the outgoing half-edges of a vertex (pair of prev).
+// holds only the ids, so that the traversal never allocates.
+class half_edge_circulator : public std::ranges::view_interface<half_edge_circulator>
+{
+  public:
+    enum class type { FACE, VERTEX };
+
+    class iterator
+    {
+      public:
+        using value_type        = half_edge;
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator() = default;
+        iterator(const he_mesh& mesh, type circulation, half_edge_id first, unsigned max_count);
+
+        const half_edge& operator*() const;
+        iterator& operator++();
+        iterator  operator++(int) { auto ret = *this; ++*this; return ret; }
+
+        bool operator==(const iterator& other) const
+        { return current_ == other.current_ && remaining_ == other.remaining_; }
+        bool operator==(std::default_sentinel_t) const { return current_ == NULL_ID; }
+
+      private:
+        const he_mesh* mesh_ = nullptr;
+        type type_ = type::FACE;
+        half_edge_id first_ = NULL_ID;
+        half_edge_id current_ = NULL_ID;
+        // reached the boundary, and goes the other way around the vertex from the first one
+        bool reversed_ = false;
+        // bounds the loop even if the pairs of non-manifold edges don't close the ring
+        unsigned remaining_ = 0;
+    };
+
+    half_edge_circulator() = default;
+    half_edge_circulator(const he_mesh& mesh, type circulation, half_edge_id first, unsigned max_count)
+      : mesh_(&mesh), type_(circulation), first_(first), max_count_(max_count) {}
+
+    iterator begin() const { return { *mesh_, type_, first_, max_count_ }; }
+    std::default_sentinel_t end() const { return {}; }
+
+  private:
+    const he_mesh* mesh_ = nullptr;
+    type type_ = type::FACE;
+    half_edge_id first_ = NULL_ID;
+    unsigned max_count_ = 0;
+};
+
 class he_mesh
 {
   public:
     static s_ptr<he_mesh> create();
     static s_ptr<he_mesh> create_from_obj_file(const std::string& filename);
+    static s_ptr<he_mesh> create_from_obj_file(utils::thread_pool& pool, const std::string& filename);
+    // builds the vertices, faces, half-edges and their pairs in parallel from the loader's buffers.
+    // the result is identical to the serial add_face path regardless of the thread count.
+    static s_ptr<he_mesh> create_from_indexed_buffers(
+      utils::thread_pool& pool,
+      std::vector<graphics::vertex>&& vertices,
+      const std::vector<vertex_id>& indices);
     // for frame_anim_meshlet_model
     static std::vector<s_ptr<he_mesh>> create_from_dynamic_attributes(
       const std::vector<std::vector<graphics::frame_anim_utils::dynamic_attributes>>& vertices,
@@ -50,14 +99,14 @@ class he_mesh
     face_id   add_face(vertex& v0, vertex& v1, vertex& v2, face_id id);
 
     // getter
-    vertex_map       get_vertex_map() const         { return vertex_map_; }
-    face_map         get_face_map() const           { return face_map_; }
-    half_edge_map    get_half_edge_map() const      { return half_edge_map_; }
+    const vertex_map& get_vertex_map() const        { return vertex_map_; }
+    const face_map&  get_face_map() const           { return face_map_; }
     size_t           get_face_count() const         { return face_map_.size(); }
     size_t           get_vertex_count() const       { return vertex_map_.size(); }
-    size_t           get_half_edge_count() const    { return half_edge_map_.size(); }
+    size_t           get_half_edge_count() const    { return half_edge_id_map_.size(); }
     face&            get_face_r(face_id id)         { return face_map_.at(id); }
     vertex&          get_vertex_r(vertex_id id)     { return vertex_map_.at(id); }
+    // the half-edges are identified by the vertex ids
     half_edge&       get_half_edge_r(const vertex& v0, const vertex& v1);
     half_edge&       get_half_edge_r(half_edge_id id) { return half_edge_id_map_.at(id); }
 
@@ -65,6 +114,41 @@ class he_mesh
     const vertex&    get_vertex(vertex_id id) const { return vertex_map_.at(id); }
     const half_edge& get_half_edge(half_edge_id id)  const { return half_edge_id_map_.at(id); }
 
+    // non-owning views in the order of the maps
+    auto get_vertices()   const { return std::views::values(vertex_map_); }
+    auto get_faces()      const { return std::views::values(face_map_); }
+    auto get_half_edges() const { return std::views::values(half_edge_id_map_); }
+    auto get_vertex_ids() const { return std::views::keys(vertex_map_); }
+    auto get_face_ids()   const { return std::views::keys(face_map_); }
+    auto get_positions()  const { return get_vertices() | std::views::transform(&vertex::position); }
+
+    // one-ring circulators (faces are triangles)
+    half_edge_circulator get_face_half_edges(face_id id) const
+    { return { *this, half_edge_circulator::type::FACE, get_face(id).he_id, 3 }; }
+    auto get_face_vertices(face_id id) const
+    {
+      return get_face_half_edges(id)
+        | std::views::transform([this](const half_edge& he) -> const vertex& { return get_vertex(he.v_id); });
+    }
+    // faces sharing an edge with the face, skips the boundary edges
+    auto get_adjacent_faces(face_id id) const
+    {
+      return get_face_half_edges(id)
+        | std::views::filter([](const half_edge& he) { return he.pair != NULL_ID; })
+        | std::views::transform([this](const half_edge& he) -> const face& { return get_face(get_half_edge(he.pair).f_id); });
+    }
+    // outgoing half-edges, a non-manifold vertex only circulates the fan of its he_id
+    half_edge_circulator get_vertex_half_edges(vertex_id id) const
+    {
+      const auto& v = get_vertex(id);
+      return { *this, half_edge_circulator::type::VERTEX, v.he_id, v.face_count };
+    }
+    auto get_vertex_faces(vertex_id id) const
+    {
+      return get_vertex_half_edges(id)
+        | std::views::transform([this](const half_edge& he) -> const face& { return get_face(he.f_id); });
+    }
+
     // for test
     bool exist_half_edge(half_edge_id id) { return half_edge_id_map_.find(id) != half_edge_id_map_.end(); }
     bool exist_half_edge(const vertex& v0, const vertex& v1);
@@ -78,7 +162,7 @@ class he_mesh
     bool associate_half_edge_pair(half_edge& he);
 
     // geometric primitives
-    half_edge_map half_edge_map_;
+    edge_map      edge_map_; // (start, end) -> half-edge id, for the pairing
     half_edge_id_map half_edge_id_map_;
     face_map      face_map_;
     vertex_map    vertex_map_;
@@ -87,6 +171,48 @@ class he_mesh
     std::vector<graphics::vertex> raw_vertices_;
 };
 
+// half_edge_circulator -----------------------------------------------------------
+
+inline half_edge_circulator::iterator::iterator(const he_mesh& mesh, type circulation, half_edge_id first, unsigned max_count)
+  : mesh_(&mesh), type_(circulation), first_(first), current_(first), remaining_(max_count)
+{
+  if (remaining_ == 0)
+    current_ = NULL_ID;
+}
+
+inline const half_edge& half_edge_circulator::iterator::operator*() const
+{ return mesh_->get_half_edge(current_); }
+
+inline half_edge_circulator::iterator& half_edge_circulator::iterator::operator++()
+{
+  if (--remaining_ == 0) {
+    current_ = NULL_ID;
+    return *this;
+  }
+
+  if (type_ == type::FACE) {
+    current_ = mesh_->get_half_edge(current_).next;
+  }
+  else {
+    // rotate until the boundary, then from the first one in the other direction
+    if (!reversed_) {
+      auto pair = mesh_->get_half_edge(mesh_->get_half_edge(current_).prev).pair;
+      if (pair != NULL_ID) {
+        current_ = pair == first_ ? NULL_ID : pair;
+        return *this;
+      }
+      reversed_ = true;
+      current_ = first_;
+    }
+    auto pair = mesh_->get_half_edge(current_).pair;
+    current_ = pair == NULL_ID ? NULL_ID : mesh_->get_half_edge(pair).next;
+  }
+
+  if (current_ == first_)
+    current_ = NULL_ID;
+  return *this;
+}
+
 template <bv_type type>
 class bv_mesh
 {
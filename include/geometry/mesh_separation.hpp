@@ -27,9 +27,11 @@ class he_mesh;
 // ---------------------------------------------------------------------------------------
 namespace mesh_separation {
 
-std::vector<graphics::meshletBS> separate_meshletBS(const he_mesh& original, const std::string& name);
+std::vector<graphics::meshletBS> separate_meshletBS(const he_mesh& original);
 
-// meshlet cache file format
+// meshlets are cached in $HNLL_ENGN/cache/meshlets by utils::asset_cache,
+// keyed by the content of the source obj and the meshlet constants.
+// meshlet cache payload format
 /*
  * model path
  * separation strategy (greedy...)
@@ -45,10 +47,10 @@ std::vector<graphics::meshletBS> separate_meshletBS(const he_mesh& original, con
 void write_meshlet_cache(
   const std::vector<graphics::meshletBS>& meshlets,
   const size_t vertex_count,
-  const std::string& filename);
+  const std::string& source_path);
 
-// returns true if the cache exists
-std::vector<graphics::meshletBS> load_meshlet_cache(const std::string& _filename);
+// returns empty vector if there is no valid cache for the current content of the source
+std::vector<graphics::meshletBS> load_meshlet_cache(const std::string& source_path);
 
 } // namespace mesh_separation
 
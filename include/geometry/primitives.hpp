@@ -25,8 +25,6 @@ using face_id_set   = std::set<face_id>;
 using face_map      = std::unordered_map<face_id, face>;
 using half_edge_id  = uint32_t;
 using half_edge_set = std::set<half_edge_id>;
-using half_edge_key = std::pair<vertex, vertex>; // consists of two vertex_ids
-using half_edge_map = std::unordered_map<half_edge_key, half_edge&>;
 using half_edge_id_map = std::unordered_map<half_edge_id, half_edge>;
 static uint32_t NULL_ID = static_cast<uint32_t>(-1);
 
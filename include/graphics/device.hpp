@@ -8,6 +8,7 @@
 #include <vulkan/vulkan.hpp>
 
 // std
+#include <span>
 #include <string>
 #include <vector>
 #include <optional>
@@ -108,7 +109,7 @@ class device
       VkImage &image,
       VkDeviceMemory &image_memory);
 
-    VkShaderModule create_shader_module(const std::vector<char>& code);
+    VkShaderModule create_shader_module(std::span<const char> code);
 
     VkPhysicalDeviceProperties properties;
 
@@ -6,25 +6,89 @@
 #include <graphics/utils.hpp>
 #include <graphics/graphics_models/static_mesh.hpp>
 #include <graphics/graphics_models/static_meshlet.hpp>
+#include <utils/thread_pool.hpp>
+#include <utils/logger.hpp>
 #include <utils/utils.hpp>
 
 // std
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <stdexcept>
 
 namespace hnll::graphics {
 
+enum class model_status
+{
+  LOADING,   // cpu stage is running on the thread pool
+  UPLOADING, // waiting for process_requests()
+  READY,
+  FAILED,
+};
+
+template <GraphicsModel M>
+struct model_request_state
+{
+  std::string path;
+  std::atomic<model_status> status = model_status::LOADING;
+  typename M::cpu_data data;
+  std::shared_future<void> cpu_stage;
+  // set by the thread which uploads the data, guarded by the pool mutex
+  bool upload_claimed = false;
+  // owned by the pool
+  M* model = nullptr;
+};
+
+class graphics_model_pool;
+
+// handle of an asynchronous load, requests for the same path share the state
+template <GraphicsModel M>
+class model_request
+{
+  public:
+    model_request() = default;
+    explicit model_request(s_ptr<model_request_state<M>> state) : state_(std::move(state)) {}
+
+    bool is_valid()  const { return state_ != nullptr; }
+    bool is_ready()  const { return get_status() == model_status::READY; }
+    bool is_failed() const { return get_status() == model_status::FAILED; }
+    model_status get_status() const { return state_->status.load(std::memory_order_acquire); }
+
+    M& get() const
+    {
+      assert(is_ready() && "model is not ready.");
+      return *state_->model;
+    }
+    const std::string& get_path() const { return state_->path; }
+
+  private:
+    friend class graphics_model_pool;
+    s_ptr<model_request_state<M>> state_;
+};
+
 class graphics_model_pool
 {
     template <GraphicsModel M>
     using model_map = std::unordered_map<std::string, u_ptr<M>>;
+    template <GraphicsModel M>
+    using request_map = std::unordered_map<std::string, s_ptr<model_request_state<M>>>;
 
   public:
-    static u_ptr<graphics_model_pool> create(device& device)
-    { return std::make_unique<graphics_model_pool>(device); }
+    static u_ptr<graphics_model_pool> create(device& device, const utils::lane_config& loader_config = {})
+    { return std::make_unique<graphics_model_pool>(device, nullptr, loader_config); }
 
-    graphics_model_pool(device& device) : device_(device) {}
+    // cpu stages run on the BACKGROUND lane of the pool.
+    // without a pool, the own one is created with loader_config for its BACKGROUND lane
+    // (worker_count 0 is the hardware concurrency)
+    graphics_model_pool(device& device, utils::thread_pool* thread_pool = nullptr, const utils::lane_config& loader_config = {})
+      : device_(device), thread_pool_(thread_pool), loader_config_(loader_config) {}
     ~graphics_model_pool()
     {
+      // cpu stages refer to the request states, the thread pool may be shared with other users
+      wait_for_cpu_stages(static_mesh_requests_);
+      wait_for_cpu_stages(static_meshlet_requests_);
       static_mesh_map_.clear();
       static_meshlet_map_.clear();
 //      skinning_mesh_map_.clear();
@@ -32,35 +96,166 @@ class graphics_model_pool
 //      frame_anim_meshlet_map_.clear();
     }
 
+    // loads synchronously if it's not requested yet, throws if the load fails
     template <GraphicsModel M>
     M& get_model(const std::string& name)
     {
-      auto full_path = utils::get_full_path(name);
-
-      if constexpr (M::get_shading_type() == utils::shading_type::MESH) {
-        load_model(full_path, static_mesh_map_, ".obj");
-        return *static_mesh_map_[full_path];
+      auto request = request_model<M>(name);
+      if (!request.is_ready())
+        wait_for_request(request);
+      if (request.is_failed()) {
+        // a later request retries
+        erase_request(request);
+        throw std::runtime_error("failed to load \"" + request.get_path() + "\".");
       }
+      return request.get();
+    }
 
-      if constexpr (M::get_shading_type() == utils::shading_type::MESHLET) {
-        load_model(full_path, static_meshlet_map_, ".obj");
-        return *static_meshlet_map_[full_path];
+    // starts the cpu stage (obj parsing, meshlet separation, etc.) on the thread pool.
+    // the model is uploaded by process_requests() on the main thread.
+    template <GraphicsModel M>
+    model_request<M> request_model(const std::string& name);
+
+    // uploads the models whose cpu stage has finished, call from the main thread (once per frame)
+    void process_requests()
+    {
+      process_requests(static_mesh_requests_, static_mesh_map_);
+      process_requests(static_meshlet_requests_, static_meshlet_map_);
+    }
+
+    // blocks until the model is ready or failed, call from the main thread
+    template <GraphicsModel M>
+    void wait_for_request(const model_request<M>& request)
+    {
+      auto& state = *request.state_;
+      state.cpu_stage.wait();
+      if (claim_upload(state)) {
+        if constexpr (M::get_shading_type() == utils::shading_type::MESH)
+          upload(state, static_mesh_map_);
+        if constexpr (M::get_shading_type() == utils::shading_type::MESHLET)
+          upload(state, static_meshlet_map_);
       }
+      // uploaded by another thread
+      state.status.wait(model_status::UPLOADING, std::memory_order_acquire);
     }
 
   private:
     template <GraphicsModel M>
-    void load_model(const std::string &path, model_map<M>& map_, const std::string& extension) {
-      // if already loaded
-      if (map_.find(path) != map_.end()) return;
+    request_map<M>& get_requests()
+    {
+      if constexpr (M::get_shading_type() == utils::shading_type::MESH)
+        return static_mesh_requests_;
+      if constexpr (M::get_shading_type() == utils::shading_type::MESHLET)
+        return static_meshlet_requests_;
+    }
+
+    template <GraphicsModel M>
+    static std::string get_extension()
+    {
+      if constexpr (M::get_shading_type() == utils::shading_type::MESH)
+        return ".obj";
+      if constexpr (M::get_shading_type() == utils::shading_type::MESHLET)
+        return ".obj";
+    }
+
+    template <GraphicsModel M>
+    void process_requests(request_map<M>& requests, model_map<M>& map)
+    {
+      std::vector<s_ptr<model_request_state<M>>> uploads;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::erase_if(requests, [&uploads](const auto& request) {
+          auto& state = *request.second;
+          auto status = state.status.load(std::memory_order_acquire);
+          if (status == model_status::UPLOADING && !state.upload_claimed) {
+            state.upload_claimed = true;
+            uploads.emplace_back(request.second);
+          }
+          // failed requests are forgotten once their cpu stage returns, so that a later request retries
+          return status == model_status::FAILED
+            && state.cpu_stage.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+      }
+      // the other threads can request and poll the models meanwhile
+      for (auto& state : uploads)
+        upload(*state, map);
+    }
+
+    // true if the calling thread should upload the state
+    template <GraphicsModel M>
+    bool claim_upload(model_request_state<M>& state)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (state.status.load(std::memory_order_acquire) != model_status::UPLOADING || state.upload_claimed)
+        return false;
+      state.upload_claimed = true;
+      return true;
+    }
+
+    template <GraphicsModel M>
+    void erase_request(const model_request<M>& request)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& requests = get_requests<M>();
+      if (auto it = requests.find(request.get_path()); it != requests.end() && it->second == request.state_)
+        requests.erase(it);
+    }
 
-      if (std::filesystem::path(path).extension().string() == extension) {
-        auto model = M::create_from_file(device_, path);
-        map_.emplace(path, std::move(model));
+    template <GraphicsModel M>
+    void wait_for_cpu_stages(request_map<M>& requests)
+    {
+      std::vector<std::shared_future<void>> cpu_stages;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cpu_stages.reserve(requests.size());
+        for (auto& request : requests)
+          cpu_stages.emplace_back(request.second->cpu_stage);
+      }
+      // the other threads can request and poll the models meanwhile
+      for (auto& cpu_stage : cpu_stages)
+        cpu_stage.wait();
+    }
+
+    // the state should be claimed by claim_upload() or process_requests(), mutex_ should not be locked
+    template <GraphicsModel M>
+    void upload(model_request_state<M>& state, model_map<M>& map)
+    {
+      u_ptr<M> model;
+      try {
+        model = M::create_from_cpu_data(device_, std::move(state.data));
       }
-      else {
-        std::cerr << "failed to load \"" << path << "\"." << std::endl;
+      catch (const std::exception& e) {
+        HNLL_LOG_ERROR("failed to upload \"", state.path, "\" : ", e.what());
+        state.status.store(model_status::FAILED, std::memory_order_release);
+        state.status.notify_all();
+        return;
       }
+      state.model = model.get();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        map.emplace(state.path, std::move(model));
+      }
+      state.status.store(model_status::READY, std::memory_order_release);
+      state.status.notify_all();
+    }
+
+    // mutex_ should not be locked, creating the pool spawns the workers
+    utils::thread_pool& get_thread_pool()
+    {
+      // created on the first request, workers only for the BACKGROUND lane
+      std::call_once(thread_pool_flag_, [this]() {
+        if (thread_pool_)
+          return;
+        auto config = loader_config_;
+        // hardware_concurrency() may be 0, a lane without workers would never run the loads
+        if (config.worker_count == 0)
+          config.worker_count = std::max(1u, std::thread::hardware_concurrency());
+        utils::lane_configs configs;
+        configs[static_cast<size_t>(utils::task_priority::BACKGROUND)] = config;
+        own_thread_pool_ = std::make_unique<utils::thread_pool>(configs);
+        thread_pool_ = own_thread_pool_.get();
+      });
+      return *thread_pool_;
     }
 
     device& device_;
@@ -70,6 +265,70 @@ class graphics_model_pool
 //    model_map<utils::shading_type::SKINNING_MESH> skinning_mesh_map_;
 //    model_map<utils::shading_type::FRAME_ANIM_MESH> frame_anim_mesh_map_;
 //    model_map<utils::shading_type::FRAME_ANIM_MESHLET> frame_anim_meshlet_map_;
+
+    // guards the request maps and the model maps
+    std::mutex mutex_;
+    request_map<static_mesh> static_mesh_requests_;
+    request_map<static_meshlet> static_meshlet_requests_;
+
+    utils::thread_pool* thread_pool_;
+    utils::lane_config loader_config_;
+    u_ptr<utils::thread_pool> own_thread_pool_;
+    std::once_flag thread_pool_flag_;
 };
 
-} // namespace hnll::game
\ No newline at end of file
+template <GraphicsModel M>
+model_request<M> graphics_model_pool::request_model(const std::string& name)
+{
+  auto full_path = utils::get_full_path(name);
+  auto& requests = get_requests<M>();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // already requested or loaded
+    if (auto it = requests.find(full_path); it != requests.end())
+      return model_request<M>(it->second);
+  }
+
+  auto state = std::make_shared<model_request_state<M>>();
+  state->path = full_path;
+
+  // not registered, a later request retries
+  if (std::filesystem::path(full_path).extension().string() != get_extension<M>()) {
+    HNLL_LOG_ERROR("failed to load \"", full_path, "\" : unsupported extension.");
+    state->status = model_status::FAILED;
+    std::promise<void> promise;
+    promise.set_value();
+    state->cpu_stage = promise.get_future().share();
+    return model_request<M>(state);
+  }
+
+  // only a new cpu stage starts the loader threads
+  auto& thread_pool = get_thread_pool();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // requested by another thread meanwhile
+  if (auto it = requests.find(full_path); it != requests.end())
+    return model_request<M>(it->second);
+  requests.emplace(full_path, state);
+
+  // the state outlives the task, the destructor waits for the cpu stages and
+  // failed states are erased only after their cpu stage returns
+  state->cpu_stage = thread_pool.submit(utils::task_priority::BACKGROUND, [raw = state.get()]() {
+    try {
+      raw->data = M::load_cpu_data(raw->path);
+      raw->status.store(model_status::UPLOADING, std::memory_order_release);
+    }
+    catch (const std::exception& e) {
+      HNLL_LOG_ERROR("failed to load \"", raw->path, "\" : ", e.what());
+      raw->status.store(model_status::FAILED, std::memory_order_release);
+    }
+    catch (...) {
+      HNLL_LOG_ERROR("failed to load \"", raw->path, "\" : unknown exception.");
+      raw->status.store(model_status::FAILED, std::memory_order_release);
+    }
+  }).share();
+
+  return model_request<M>(state);
+}
+
+} // namespace hnll::graphics
@@ -2,6 +2,7 @@
 
 // hnll
 #include <graphics/graphics_model.hpp>
+#include <graphics/image_resource.hpp>
 
 // forward declaration
 namespace hnll::geometry { class he_mesh; }
@@ -20,11 +21,24 @@ DEFINE_GRAPHICS_MODEL(static_mesh, utils::shading_type::MESH) {
       const obj_loader &builder,
       bool for_ray_tracing);
 
+    // result of the cpu stage, which doesn't touch the device
+    struct cpu_data
+    {
+      std::vector<vertex>   vertices;
+      std::vector<uint32_t> indices;
+      // decoded on the cpu stage, only the image is created on the upload
+      image_pixels          texture;
+    };
+
     static u_ptr<static_mesh> create_from_file(
       device &device,
       const std::string &filename,
       bool for_ray_tracing = false);
 
+    // create_from_file() split into the thread safe cpu stage and the upload
+    static cpu_data load_cpu_data(const std::string& filename);
+    static u_ptr<static_mesh> create_from_cpu_data(device& device, cpu_data&& data, bool for_ray_tracing = false);
+
     static u_ptr<static_mesh> create_from_geometry_mesh_model(device &device, const s_ptr<geometry::he_mesh> &gm);
 
     void bind(VkCommandBuffer command_buffer);
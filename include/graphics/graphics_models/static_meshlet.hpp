@@ -23,8 +23,19 @@ DEFINE_GRAPHICS_MODEL(static_meshlet, utils::shading_type::MESHLET)
 
     static_meshlet(device& device, std::vector<vertex>&& raw_vertices, std::vector<meshletBS>&& meshlets);
 
+    // result of the cpu stage, which doesn't touch the device
+    struct cpu_data
+    {
+      std::vector<vertex>    raw_vertices;
+      std::vector<meshletBS> meshlets;
+    };
+
     static u_ptr<static_meshlet> create_from_file(device& device, std::string filename);
 
+    // create_from_file() split into the thread safe cpu stage and the upload
+    static cpu_data load_cpu_data(const std::string& filename);
+    static u_ptr<static_meshlet> create_from_cpu_data(device& device, cpu_data&& data);
+
     void draw(VkCommandBuffer  command_buffer) const;
 
     // getter
@@ -4,7 +4,9 @@
 #include <utils/common_alias.hpp>
 
 // std
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // lib
 #include <vulkan/vulkan.h>
@@ -14,10 +16,21 @@ namespace hnll::graphics {
 class device;
 class buffer;
 
+// decoded rgba8 pixels
+struct image_pixels
+{
+  std::vector<uint8_t> data;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
 class image_resource
 {
   public:
     static u_ptr<image_resource> create_from_file(device& device, const std::string& filepath);
+    // create_from_file() split into the decoding, which doesn't touch the device, and the upload
+    static image_pixels load_pixels(const std::string& filepath);
+    static u_ptr<image_resource> create_from_pixels(device& device, const image_pixels& pixels);
     static u_ptr<image_resource> create(
       device& device,
       VkExtent3D extent,
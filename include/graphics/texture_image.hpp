@@ -13,13 +13,17 @@ class desc_pool;
 class desc_layout;
 class desc_sets;
 class image_resource;
+struct image_pixels;
 
 class texture_image
 {
   public:
     static u_ptr<texture_image> create(device&, const std::string& filepath);
+    // from the pixels decoded by image_resource::load_pixels()
+    static u_ptr<texture_image> create_from_pixels(device&, const image_pixels& pixels);
 
     texture_image(device& device, const std::string& filepath);
+    texture_image(device& device, u_ptr<image_resource>&& image);
     ~texture_image();
 
     static void setup_desc_layout(device& device);
@@ -1,21 +1,57 @@
 #pragma once
 
 // std
-#include <variant>
+#include <limits>
+#include <utility>
+#include <vector>
 
 // hnll
 #include <utils/common_alias.hpp>
+#include <geometry/bvh.hpp>
 
-namespace hnll::physics {
+// forward declaration
+namespace hnll::utils { class thread_pool; }
 
-struct bvh;
+namespace hnll::physics {
 
+// broad phase over the registered bounding volumes through a bvh
 class collision_detector
 {
   public:
+    using volume_id = uint32_t;
+    using collision_pair = std::pair<volume_id, volume_id>;
+
+    // refits loosen the tree as the volumes move, so it's rebuilt once in a while
+    static constexpr uint32_t REBUILD_INTERVAL = 64;
+
+    // builds and queries in parallel if the pool is given
+    explicit collision_detector(utils::thread_pool* pool = nullptr) : pool_(pool) {}
+
+    // the volume is owned by the caller (e.g. rigid_component), and must outlive the registration
+    volume_id add_volume(const geometry::bounding_volume& volume);
+    void clear_volumes();
+
+    // call after the volumes have moved.
+    // rebuilds the bvh if the volumes have been added, otherwise refits it to their current positions
+    void update();
+
+    // pairs of the intersecting volumes (first < second, in the ascending order), valid until the next call
+    const std::vector<collision_pair>& detect_collisions();
+    geometry::ray_hit cast_ray(const geometry::ray& ray, double t_max = std::numeric_limits<double>::infinity()) const;
+    // appends the registered volumes intersecting with the volume
+    void query(const geometry::bounding_volume& volume, std::vector<volume_id>& ids) const;
+
+    // getter
+    size_t get_volume_count() const { return volumes_.size(); }
+    const geometry::bvh* get_bvh() const { return bvh_.get(); }
 
   private:
-    u_ptr<bvh> bvh_;
+    std::vector<const geometry::bounding_volume*> volumes_;
+    u_ptr<geometry::bvh> bvh_;
+    utils::thread_pool* pool_;
+    bool dirty_ = true;
+    uint32_t refit_count_ = 0;
+    std::vector<collision_pair> collisions_;
 };
 
-} // namespace hnll::physics
\ No newline at end of file
+} // namespace hnll::physics
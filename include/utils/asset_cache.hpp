@@ -0,0 +1,89 @@
+#pragma once
+
+// hnll
+#include <utils/mapped_file.hpp>
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace hnll::utils {
+
+// on-disk cache of assets generated from a source file (meshlets of an obj, etc.).
+//
+// an entry is keyed by the source path and a hash of the generator parameters, and it is valid
+// as long as the content of the source is the same.
+// the entry header records the size, mtime and content hash of the source, so that a hit only costs
+// a stat of the source and a header check. if only the mtime differs (e.g. a fresh checkout), lookup
+// hashes the first and last 64 KiB of the source, and then the whole source synchronously if they match.
+// this reads the entire file once, and the entry is re-stamped to take the fast path again.
+//
+// entries are written to a temporary file and renamed into place, so that concurrent writers
+// (threads or processes) never expose a partial entry, the last rename wins.
+// the least recently used entries are evicted when the directory exceeds the size limit.
+// the total size is scanned once at the construction and then tracked in memory by store() and remove(),
+// so that the directory is walked again only when the total goes over the limit.
+class asset_cache
+{
+  public:
+    static constexpr uint64_t DEFAULT_MAX_SIZE = 1024ull * 1024 * 1024;
+    static constexpr std::string_view ENTRY_EXTENSION = ".cache";
+    // last use of an entry is recorded at most this often
+    static constexpr std::chrono::seconds TOUCH_INTERVAL{ 60 * 60 };
+
+    // valid entry, the payload is mapped and stays valid even if the entry is replaced
+    class entry
+    {
+      public:
+        entry(mapped_file&& file, size_t offset) : file_(std::move(file)), offset_(offset) {}
+
+        const char* data() const { return file_.data() + offset_; }
+        size_t size() const { return file_.size() - offset_; }
+        std::string_view get_string_view() const { return { data(), size() }; }
+
+      private:
+        mapped_file file_;
+        size_t offset_;
+    };
+
+    // creates the directory if it doesn't exist
+    explicit asset_cache(const std::string& directory, uint64_t max_size = DEFAULT_MAX_SIZE);
+
+    // nullopt if there is no valid entry, an outdated entry is removed
+    std::optional<entry> lookup(const std::string& source_path, uint64_t params_hash);
+
+    // returns false if the entry couldn't be written, the cache is optional so it doesn't throw.
+    // the payload may be binary.
+    bool store(const std::string& source_path, uint64_t params_hash, std::string_view payload);
+
+    void remove(const std::string& source_path, uint64_t params_hash);
+
+    // removes the least recently used entries until the total size fits in max_size.
+    // also removes the temporary files left by crashed writers, and re-syncs the tracked size with the directory.
+    void evict();
+
+    // sum of the entry sizes, scans the directory
+    uint64_t get_total_size() const;
+    std::string get_entry_path(const std::string& source_path, uint64_t params_hash) const;
+    const std::string& get_directory() const { return directory_; }
+    uint64_t get_max_size() const { return max_size_; }
+    void set_max_size(uint64_t max_size) { max_size_ = max_size; }
+
+  private:
+    bool write_entry(const std::string& entry_path, const void* header, size_t header_size, std::string_view payload);
+
+    std::string directory_;
+    uint64_t max_size_;
+    // sum of the entry sizes as of the last scan plus the changes of this instance since then,
+    // the changes of the other processes are picked up by the next scan
+    std::atomic<uint64_t> tracked_size_ = 0;
+    // serializes the eviction of this process, other processes may remove the same files
+    std::mutex evict_mutex_;
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,83 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace hnll::utils {
+
+// thread-caching allocator for small blocks (up to MAX_BLOCK_SIZE bytes).
+// each thread allocates from and frees to its own free lists without locking.
+// surplus blocks move to a global depot in batches, so that blocks freed on
+// another thread (e.g. tasks run by workers) are recycled by the allocating thread.
+class block_pool
+{
+  public:
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+    // blocks are aligned as well as ::operator new does
+    static constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+    static void* allocate(size_t size);
+    // size should be the same as the one passed to allocate()
+    static void deallocate(void* ptr, size_t size);
+
+    template <typename T>
+    static constexpr bool is_poolable(size_t count = 1)
+    { return sizeof(T) * count <= MAX_BLOCK_SIZE && alignof(T) <= BLOCK_ALIGNMENT; }
+};
+
+// std compatible allocator, falls back to std::allocator for large or over-aligned types
+template <typename T>
+struct pool_allocator
+{
+  using value_type = T;
+
+  pool_allocator() = default;
+  template <typename U>
+  pool_allocator(const pool_allocator<U>&) {}
+
+  T* allocate(size_t count)
+  {
+    if (block_pool::is_poolable<T>(count))
+      return static_cast<T*>(block_pool::allocate(sizeof(T) * count));
+    return std::allocator<T>{}.allocate(count);
+  }
+
+  void deallocate(T* ptr, size_t count)
+  {
+    if (block_pool::is_poolable<T>(count))
+      block_pool::deallocate(ptr, sizeof(T) * count);
+    else
+      std::allocator<T>{}.deallocate(ptr, count);
+  }
+
+  template <typename U>
+  bool operator==(const pool_allocator<U>&) const { return true; }
+};
+
+template <typename T, typename... Args>
+T* pool_new(Args&&... args)
+{
+  pool_allocator<T> allocator;
+  auto ptr = allocator.allocate(1);
+  try {
+    return new (ptr) T(std::forward<Args>(args)...);
+  }
+  catch (...) {
+    allocator.deallocate(ptr, 1);
+    throw;
+  }
+}
+
+template <typename T>
+void pool_delete(T* ptr)
+{
+  if (ptr == nullptr)
+    return;
+  ptr->~T();
+  pool_allocator<T>{}.deallocate(ptr, 1);
+}
+
+} // namespace hnll::utils
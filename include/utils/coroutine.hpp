@@ -0,0 +1,339 @@
+#pragma once
+
+// hnll
+#include <utils/thread_pool.hpp>
+
+// std
+#include <cassert>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// coroutines on thread_pool
+//
+//   utils::task<mesh> load(utils::thread_pool& pool, std::string path)
+//   {
+//     co_await pool.schedule();          // continue on a worker
+//     auto obj = co_await load_obj(path); // suspend without blocking the worker
+//     co_return build_mesh(obj);
+//   }
+//
+// a task is lazy, it starts when it's awaited and its awaiter resumes on the thread which completes it.
+
+namespace hnll::utils {
+
+template <typename T = void>
+class task;
+
+template <typename T>
+class task_promise_base
+{
+    // resume the awaiting coroutine by symmetric transfer
+    struct final_awaiter
+    {
+      bool await_ready() const noexcept { return false; }
+
+      template <typename Promise>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+      {
+        if (auto continuation = handle.promise().continuation_; continuation)
+          return continuation;
+        return std::noop_coroutine();
+      }
+
+      void await_resume() const noexcept {}
+    };
+
+  public:
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { exception_ = std::current_exception(); }
+
+    void set_continuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+
+  protected:
+    void rethrow_if_exception()
+    {
+      if (exception_)
+        std::rethrow_exception(exception_);
+    }
+
+  private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr exception_;
+};
+
+template <typename T>
+class task_promise : public task_promise_base<T>
+{
+  public:
+    task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& value) { value_.emplace(std::forward<U>(value)); }
+
+    T& get_result() &
+    {
+      this->rethrow_if_exception();
+      return *value_;
+    }
+
+    T&& get_result() &&
+    {
+      this->rethrow_if_exception();
+      return std::move(*value_);
+    }
+
+  private:
+    std::optional<T> value_;
+};
+
+template <>
+class task_promise<void> : public task_promise_base<void>
+{
+  public:
+    task<void> get_return_object();
+
+    void return_void() {}
+    void get_result() { rethrow_if_exception(); }
+};
+
+// ---------------------------------------------------------------------------
+
+template <typename T>
+class task
+{
+  public:
+    using promise_type = task_promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit task(handle_type handle) : handle_(handle) {}
+    ~task() { if (handle_) handle_.destroy(); }
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    task& operator=(task&& other) noexcept
+    {
+      if (this != &other) {
+        if (handle_)
+          handle_.destroy();
+        handle_ = std::exchange(other.handle_, nullptr);
+      }
+      return *this;
+    }
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    bool is_ready() const { return !handle_ || handle_.done(); }
+
+    // co_await task returns the result or rethrows the exception
+    auto operator co_await() & noexcept { return awaiter<false>{ handle_ }; }
+    auto operator co_await() && noexcept { return awaiter<true>{ handle_ }; }
+
+    // co_await task.when_ready() only waits for the completion
+    auto when_ready() noexcept
+    {
+      struct ready_awaiter : awaiter<false>
+      { void await_resume() const noexcept {} };
+      return ready_awaiter{ { handle_ } };
+    }
+
+  private:
+    template <bool IsRvalue>
+    struct awaiter
+    {
+      handle_type handle;
+
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+
+      // start the task, it resumes the awaiting coroutine at the end
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+      {
+        handle.promise().set_continuation(awaiting);
+        return handle;
+      }
+
+      decltype(auto) await_resume()
+      {
+        assert(handle && "awaiting an empty task.");
+        if constexpr (IsRvalue)
+          return std::move(handle.promise()).get_result();
+        else
+          return handle.promise().get_result();
+      }
+    };
+
+    handle_type handle_;
+};
+
+template <typename T>
+task<T> task_promise<T>::get_return_object()
+{ return task<T>{ std::coroutine_handle<task_promise<T>>::from_promise(*this) }; }
+
+inline task<void> task_promise<void>::get_return_object()
+{ return task<void>{ std::coroutine_handle<task_promise<void>>::from_promise(*this) }; }
+
+// ---------------------------------------------------------------------------
+
+// lazily started coroutine which notifies the end of the awaited task, runs from start().
+// at the final suspend it transfers to the handle returned by notifier->notify() and stays suspended,
+// so that the owner destroys the frame
+template <typename Notifier>
+class notify_task
+{
+  public:
+    struct promise_type
+    {
+      notify_task get_return_object() { return notify_task{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+
+      struct final_awaiter
+      {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+        { return handle.promise().notifier->notify(); }
+        void await_resume() const noexcept {}
+      };
+      final_awaiter final_suspend() const noexcept { return {}; }
+
+      void return_void() {}
+      // task exceptions are caught by the awaited task itself
+      void unhandled_exception() { std::terminate(); }
+
+      Notifier* notifier = nullptr;
+    };
+
+    explicit notify_task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    ~notify_task() { if (handle_) handle_.destroy(); }
+    notify_task(notify_task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    notify_task(const notify_task&) = delete;
+
+    void start(Notifier& notifier)
+    {
+      handle_.promise().notifier = &notifier;
+      handle_.resume();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename Notifier, typename T>
+notify_task<Notifier> make_notify_task(task<T>& awaited)
+{ co_await awaited.when_ready(); }
+
+// ---------------------------------------------------------------------------
+
+// blocks the calling thread until the task finishes, don't call on a worker thread
+class sync_wait_event
+{
+  public:
+    std::coroutine_handle<> notify()
+    {
+      // notify under the lock, so that the waiter can't destroy this before notify_one() returns
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+      cond_.notify_one();
+      return std::noop_coroutine();
+    }
+
+    void wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return done_; });
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool done_ = false;
+};
+
+template <typename T>
+T sync_wait(task<T> awaited)
+{
+  sync_wait_event event;
+  auto notifier = make_notify_task<sync_wait_event>(awaited);
+  notifier.start(event);
+  event.wait();
+  return std::move(awaited).operator co_await().await_resume();
+}
+
+// ---------------------------------------------------------------------------
+
+// resumes the awaiting coroutine when the last task finishes
+class when_all_counter
+{
+  public:
+    explicit when_all_counter(size_t count) : count_(count) {}
+
+    void set_continuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+
+    std::coroutine_handle<> notify()
+    {
+      if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        return continuation_;
+      return std::noop_coroutine();
+    }
+
+  private:
+    std::atomic<size_t> count_;
+    std::coroutine_handle<> continuation_;
+};
+
+template <typename T>
+class when_all_awaiter
+{
+  public:
+    // +1 is released after all the tasks are started
+    explicit when_all_awaiter(std::vector<task<T>>& tasks) : tasks_(tasks), counter_(tasks.size() + 1) {}
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> awaiting)
+    {
+      counter_.set_continuation(awaiting);
+      notifiers_.reserve(tasks_.size());
+      for (auto& t : tasks_) {
+        notifiers_.emplace_back(make_notify_task<when_all_counter>(t));
+        notifiers_.back().start(counter_);
+      }
+      // resume immediately if all the tasks have already finished
+      return counter_.notify() != awaiting;
+    }
+
+    void await_resume() const noexcept {}
+
+  private:
+    std::vector<task<T>>& tasks_;
+    when_all_counter counter_;
+    std::vector<notify_task<when_all_counter>> notifiers_;
+};
+
+// start all the tasks and wait for them without blocking a thread.
+// the tasks run concurrently only if they schedule themselves to the pool (co_await pool.schedule()).
+template <typename T>
+task<void> when_all_ready(std::vector<task<T>>& tasks)
+{ co_await when_all_awaiter<T>(tasks); }
+
+template <typename T>
+task<std::vector<T>> when_all(std::vector<task<T>> tasks)
+{
+  co_await when_all_ready(tasks);
+  std::vector<T> results;
+  results.reserve(tasks.size());
+  for (auto& t : tasks)
+    results.emplace_back(co_await std::move(t));
+  co_return results;
+}
+
+inline task<void> when_all(std::vector<task<void>> tasks)
+{
+  co_await when_all_ready(tasks);
+  for (auto& t : tasks)
+    co_await t;
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,82 @@
+#pragma once
+
+// hnll
+#include <utils/common_alias.hpp>
+#include <utils/vulkan_config.hpp>
+
+// std
+#include <array>
+#include <atomic>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace hnll::utils {
+
+// per-frame linear allocator for short-lived containers in hot paths.
+// each frame in flight has its own region, which is reset when the frame comes round again,
+// so memory allocated in frame N stays valid until FRAMES_IN_FLIGHT - 1 frames later.
+//
+//   std::pmr::vector<VkDescriptorSet> desc_sets(&frame_arena);
+//
+// deallocation is a no-op. allocation is a lock-free bump, which is safe from worker threads.
+// requests which don't fit fall back to the upstream resource until the frame is reset,
+// and the region grows to the frame's peak usage at the reset.
+class frame_arena : public std::pmr::memory_resource
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20; // per frame
+
+    explicit frame_arena(
+      size_t capacity = DEFAULT_CAPACITY,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~frame_arena() override;
+
+    frame_arena(const frame_arena&) = delete;
+    frame_arena& operator=(const frame_arena&) = delete;
+
+    // call at a frame boundary, no allocation of the reused region should be alive
+    void begin_frame();
+
+    size_t get_frame_index() const { return frame_index_; }
+    // of the current frame
+    size_t get_used_bytes() const;
+    size_t get_capacity() const { return regions_[frame_index_].capacity; }
+    // peak usage of the finished frames, including the overflow
+    size_t get_high_water_mark() const { return high_water_mark_; }
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    // released together at begin_frame()
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    { return this == &other; }
+
+    void* allocate_overflow(size_t bytes, size_t alignment);
+    void reset_region(size_t index);
+
+    struct overflow_block
+    {
+      void* ptr;
+      size_t bytes;
+      size_t alignment;
+    };
+
+    struct region
+    {
+      std::byte* data = nullptr;
+      size_t capacity = 0;
+      std::atomic<size_t> offset = 0;
+      // guards overflow
+      std::mutex mutex;
+      std::vector<overflow_block> overflow;
+      std::atomic<size_t> overflow_bytes = 0;
+    };
+
+    std::pmr::memory_resource* upstream_;
+    std::array<region, FRAMES_IN_FLIGHT> regions_;
+    size_t frame_index_ = 0;
+    size_t high_water_mark_ = 0;
+};
+
+} // namespace hnll::utils
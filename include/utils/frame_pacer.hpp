@@ -0,0 +1,81 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <cstdint>
+
+namespace hnll::utils {
+
+// caps the frame rate without burning a core.
+// sleeps until shortly before the deadline, then spins the rest of the way.
+// the spin tail is calibrated from the observed oversleep of the os scheduler,
+// so that it's as short as the platform allows.
+//
+// deadlines are advanced by the period (not by now + period), so that the
+// rate doesn't drift with the per-frame overshoot. after a hitch longer than half
+// the period, the schedule restarts from now instead of catching up with short frames.
+class frame_pacer
+{
+  public:
+    using clock = std::chrono::steady_clock;
+    using duration = std::chrono::nanoseconds;
+
+    // bounds of the calibrated spin tail
+    static constexpr duration MIN_SPIN = std::chrono::microseconds(50);
+    static constexpr duration MAX_SPIN = std::chrono::milliseconds(2);
+
+    // frame intervals since the last reset_statistics(), in milliseconds
+    struct statistics
+    {
+      uint64_t frame_count = 0;
+      double mean = 0.0;
+      double variance = 0.0;
+      double min = 0.0;
+      double max = 0.0;
+      // frames which started more than MAX_SPIN after their deadline
+      uint64_t missed_count = 0;
+      // mean of |frame start - deadline|
+      double mean_error = 0.0;
+    };
+
+    // max_fps <= 0 disables the cap
+    explicit frame_pacer(float max_fps = 60.f);
+
+    // blocks until the next frame should start, returns the delta time in seconds
+    float wait_for_next_frame();
+
+    // restarts the schedule from now (e.g. after loading)
+    void reset();
+    void reset_statistics();
+
+    void set_max_fps(float max_fps);
+    float get_max_fps() const { return max_fps_; }
+    duration get_period() const { return period_; }
+    duration get_spin_threshold() const { return spin_threshold_; }
+    statistics get_statistics() const;
+
+  private:
+    void calibrate(duration oversleep);
+    void record(duration interval, duration error);
+
+    float max_fps_;
+    duration period_{};
+    clock::time_point last_frame_;
+    clock::time_point deadline_;
+
+    // running estimate of the oversleep (mean and mean absolute deviation)
+    duration spin_threshold_ = std::chrono::milliseconds(1);
+    double oversleep_mean_ = 0.0;
+    double oversleep_deviation_ = 0.0;
+
+    // welford's online variance of the frame intervals
+    uint64_t frame_count_ = 0;
+    double interval_mean_ = 0.0;
+    double interval_m2_ = 0.0;
+    double interval_min_ = 0.0;
+    double interval_max_ = 0.0;
+    uint64_t missed_count_ = 0;
+    double error_sum_ = 0.0;
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,21 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace hnll::utils {
+
+// fast non-cryptographic 64 bit hash (xxh64), for content keys and hash tables.
+// the result is stable across runs and platforms of the same endianness, so it can be stored in files.
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t hash_string(std::string_view str, uint64_t seed = 0)
+{ return hash_bytes(str.data(), str.size(), seed); }
+
+// mixes the value into the seed, for building keys from several parameters
+inline uint64_t hash_combine(uint64_t seed, uint64_t value)
+{ return hash_bytes(&value, sizeof(value), seed); }
+
+} // namespace hnll::utils
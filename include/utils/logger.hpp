@@ -0,0 +1,157 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// asynchronous logger
+//
+//   HNLL_LOG_INFO(filename, " vertex count: ", vertex_count);
+//
+// the arguments are formatted into a buffer of the calling thread without allocation,
+// and the line is handed off to a background writer through a lock-free queue.
+// logging never blocks (from thread_pool tasks or the audio thread), the lines are dropped
+// and counted while the queue is full.
+// levels below HNLL_LOG_LEVEL (cmake -DHNLL_LOG_LEVEL=DEBUG, INFO by default) are removed
+// at compile time, and their arguments are not evaluated.
+
+#define HNLL_LOG_LEVEL_TRACE 0
+#define HNLL_LOG_LEVEL_DEBUG 1
+#define HNLL_LOG_LEVEL_INFO  2
+#define HNLL_LOG_LEVEL_WARN  3
+#define HNLL_LOG_LEVEL_ERROR 4
+#define HNLL_LOG_LEVEL_OFF   5
+
+#ifndef HNLL_LOG_LEVEL
+#define HNLL_LOG_LEVEL HNLL_LOG_LEVEL_INFO
+#endif
+
+namespace hnll::utils {
+
+enum class log_level : uint8_t
+{
+  TRACE = HNLL_LOG_LEVEL_TRACE,
+  DEBUG = HNLL_LOG_LEVEL_DEBUG,
+  INFO  = HNLL_LOG_LEVEL_INFO,
+  WARN  = HNLL_LOG_LEVEL_WARN,
+  ERROR = HNLL_LOG_LEVEL_ERROR,
+  OFF   = HNLL_LOG_LEVEL_OFF,
+};
+
+constexpr log_level COMPILED_LOG_LEVEL = static_cast<log_level>(HNLL_LOG_LEVEL);
+
+// a formatted line, copied into the queue as is
+struct log_record
+{
+  static constexpr size_t MAX_LENGTH = 224;
+
+  uint64_t time_ns;
+  uint32_t thread_id;
+  log_level level;
+  bool truncated;
+  uint16_t length;
+  char text[MAX_LENGTH];
+};
+
+// appends the arguments to a log_record, the overflow is truncated
+class log_formatter
+{
+  public:
+    explicit log_formatter(log_record& record) : record_(record) {}
+
+    void append(std::string_view str)
+    {
+      auto count = std::min(str.size(), log_record::MAX_LENGTH - record_.length);
+      std::memcpy(record_.text + record_.length, str.data(), count);
+      record_.length += static_cast<uint16_t>(count);
+      if (count < str.size())
+        record_.truncated = true;
+    }
+    void append(const char* str) { append(std::string_view(str ? str : "(null)")); }
+    void append(const std::string& str) { append(std::string_view(str)); }
+    void append(char c) { append(std::string_view(&c, 1)); }
+    void append(bool value) { append(value ? std::string_view("true") : std::string_view("false")); }
+    void append(const void* ptr)
+    {
+      append(std::string_view("0x"));
+      append_number(reinterpret_cast<uintptr_t>(ptr), 16);
+    }
+
+    template <typename T> requires std::is_arithmetic_v<T>
+    void append(T value) { append_number(value); }
+
+    template <typename T> requires std::is_enum_v<T>
+    void append(T value) { append_number(static_cast<std::underlying_type_t<T>>(value)); }
+
+  private:
+    template <typename T, typename... Args>
+    void append_number(T value, Args... args)
+    {
+      char buffer[64];
+      auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, args...);
+      append(std::string_view(buffer, result.ptr - buffer));
+    }
+
+    log_record& record_;
+};
+
+class logger
+{
+  public:
+    // lines in the queue, about 256 bytes each
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+
+    // the writer thread starts on the first line
+    template <typename... Args>
+    static void write(log_level level, Args&&... args)
+    {
+      if (level < get_level())
+        return;
+      auto& record = begin_record(level);
+      log_formatter formatter(record);
+      (formatter.append(std::forward<Args>(args)), ...);
+      commit_record(record);
+    }
+
+    // runtime filter on top of COMPILED_LOG_LEVEL
+    static log_level get_level();
+    static void set_level(log_level level);
+
+    // the lines are also appended to the file, returns false if it can't be opened.
+    // an empty path closes the file.
+    static bool set_file(const std::string& path);
+    // stdout by default
+    static void set_console_enabled(bool enabled);
+
+    // blocks until the lines logged before the call are written
+    static void flush();
+    // lines dropped because the queue was full
+    static uint64_t get_dropped_count();
+
+    static const char* get_level_name(log_level level);
+
+  private:
+    // the record of the calling thread
+    static log_record& begin_record(log_level level);
+    static void commit_record(log_record& record);
+};
+
+} // namespace hnll::utils
+
+#define HNLL_LOG_IMPL(level, ...) \
+  do { \
+    if constexpr (::hnll::utils::log_level::level >= ::hnll::utils::COMPILED_LOG_LEVEL) \
+      ::hnll::utils::logger::write(::hnll::utils::log_level::level, __VA_ARGS__); \
+  } while (0)
+
+#define HNLL_LOG_TRACE(...) HNLL_LOG_IMPL(TRACE, __VA_ARGS__)
+#define HNLL_LOG_DEBUG(...) HNLL_LOG_IMPL(DEBUG, __VA_ARGS__)
+#define HNLL_LOG_INFO(...)  HNLL_LOG_IMPL(INFO, __VA_ARGS__)
+#define HNLL_LOG_WARN(...)  HNLL_LOG_IMPL(WARN, __VA_ARGS__)
+#define HNLL_LOG_ERROR(...) HNLL_LOG_IMPL(ERROR, __VA_ARGS__)
+#define HNLL_LOG_FLUSH() ::hnll::utils::logger::flush()
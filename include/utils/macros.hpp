@@ -0,0 +1,5 @@
+#pragma once
+
+// pastes the tokens after expanding them, HNLL_CONCAT(name_, __LINE__) -> name_42
+#define HNLL_CONCAT_IMPL(a, b) a##b
+#define HNLL_CONCAT(a, b) HNLL_CONCAT_IMPL(a, b)
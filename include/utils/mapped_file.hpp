@@ -0,0 +1,81 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <istream>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hnll::utils {
+
+// read-only view of a whole file.
+// large files are mmap-ed, so that the pages are read lazily by the os and never copied.
+// files smaller than SMALL_FILE_SIZE are just read into a buffer, mapping them costs more than a copy.
+// the data is at least 16 byte aligned (e.g. for spir-v words).
+class mapped_file
+{
+  public:
+    static constexpr size_t SMALL_FILE_SIZE = 16 * 1024;
+
+    // madvise hints, ignored for the buffered files
+    enum class access_hint
+    {
+      NORMAL,
+      SEQUENTIAL, // read once from the head (parsers)
+      RANDOM,
+      WILL_NEED,  // start reading ahead now
+    };
+
+    // throws std::runtime_error if the file can't be opened
+    explicit mapped_file(const std::string& path, access_hint hint = access_hint::SEQUENTIAL);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    void advise(access_hint hint) const;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    std::span<const std::byte> get_bytes() const { return { reinterpret_cast<const std::byte*>(data_), size_ }; }
+    std::string_view get_string_view() const { return { data_, size_ }; }
+
+    // false for the buffered small files
+    bool is_mapped() const { return mapped_; }
+
+  private:
+    void release();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+};
+
+// std::istream over a memory range without copying, for the stream based parsers
+class memory_istream : public std::istream
+{
+  public:
+    memory_istream(const char* data, size_t size);
+    explicit memory_istream(const mapped_file& file) : memory_istream(file.data(), file.size()) {}
+
+  private:
+    struct memory_streambuf : public std::streambuf
+    {
+      memory_streambuf(const char* data, size_t size);
+      pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+      pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+    };
+
+    memory_streambuf buf_;
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,100 @@
+#pragma once
+
+// hnll
+#include <utils/macros.hpp>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// heap usage per subsystem
+//
+//   s_ptr<he_mesh> he_mesh::create_from_obj_file(const std::string& filename)
+//   {
+//     HNLL_MEMORY_SCOPE(GEOMETRY);
+//     ...
+//   }
+//
+// operator new / delete are replaced to attribute every allocation to the innermost scope
+// of the allocating thread. a deallocation is charged to the tag of its allocation,
+// even if it happens outside of the scope or on another thread.
+// live bytes, peak bytes and allocations per frame can be queried at runtime.
+// the tracking is compiled only if HNLL_TRACK_ALLOCATIONS is defined (cmake -DHNLL_TRACK_ALLOCATIONS=ON),
+// otherwise the macros expand to nothing and operator new is untouched.
+
+namespace hnll::utils {
+
+enum class memory_tag : uint8_t
+{
+  UNTAGGED,
+  GEOMETRY,
+  GRAPHICS,
+  AUDIO,
+  PHYSICS,
+  GAME,
+};
+constexpr size_t MEMORY_TAG_COUNT = 6;
+
+class memory_tracker
+{
+  public:
+    struct report
+    {
+      memory_tag tag;
+      const char* name;
+      int64_t live_bytes;
+      int64_t peak_bytes;
+      uint64_t alloc_count;
+      uint64_t free_count;
+      // allocations during the last frame
+      uint64_t frame_alloc_count;
+    };
+
+    // true if operator new is replaced
+    static bool is_enabled();
+
+    static memory_tag get_current_tag();
+    // returns the previous tag of this thread
+    static memory_tag set_current_tag(memory_tag tag);
+
+    // called by operator new / delete
+    static void on_allocate(memory_tag tag, size_t size);
+    static void on_deallocate(memory_tag tag, size_t size);
+
+    // closes the per-frame allocation counts
+    static void end_frame();
+    // peak bytes restart from the current live bytes
+    static void reset_peaks();
+
+    static report get_report(memory_tag tag);
+    static std::vector<report> get_reports();
+    static const char* get_tag_name(memory_tag tag);
+    static bool write_csv(const std::string& path);
+};
+
+class memory_scope
+{
+  public:
+    explicit memory_scope(memory_tag tag) : previous_(memory_tracker::set_current_tag(tag)) {}
+    ~memory_scope() { memory_tracker::set_current_tag(previous_); }
+
+    memory_scope(const memory_scope&) = delete;
+    memory_scope& operator=(const memory_scope&) = delete;
+
+  private:
+    memory_tag previous_;
+};
+
+} // namespace hnll::utils
+
+#ifdef HNLL_TRACK_ALLOCATIONS
+#define HNLL_MEMORY_SCOPE(tag) ::hnll::utils::memory_scope HNLL_CONCAT(hnll_memory_scope_, __LINE__){ ::hnll::utils::memory_tag::tag }
+#define HNLL_MEMORY_END_FRAME() ::hnll::utils::memory_tracker::end_frame()
+#define HNLL_MEMORY_WRITE_CSV(path) ::hnll::utils::memory_tracker::write_csv(path)
+#else
+#define HNLL_MEMORY_SCOPE(tag)
+#define HNLL_MEMORY_END_FRAME()
+#define HNLL_MEMORY_WRITE_CSV(path)
+#endif
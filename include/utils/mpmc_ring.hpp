@@ -0,0 +1,249 @@
+#pragma once
+
+// hnll
+#include <utils/common_alias.hpp>
+#include <utils/mt_queue.hpp>
+
+// std
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+namespace hnll::utils {
+
+// bounded lock-free multi-producer multi-consumer queue on a ring buffer
+// each slot has a turn counter : 2 * lap for writers, 2 * lap + 1 for readers.
+// try_xxx claims an index by CAS only if its slot is ready,
+// blocking push/pop claim an index by fetch_add and wait for their turn (futex after spinning).
+template <typename T>
+class mpmc_ring
+{
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+      "mpmc_ring requires nothrow move construction and destruction.");
+
+    // each slot occupies its own cache lines to avoid false sharing
+    struct alignas(CACHE_LINE_SIZE) slot
+    {
+      ~slot()
+      {
+        // odd turn means the slot holds an element
+        if (turn.load(std::memory_order_relaxed) & 1)
+          get()->~T();
+      }
+
+      T* get() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+      std::atomic<size_t> turn = 0;
+      alignas(T) std::byte storage[sizeof(T)];
+    };
+
+  public:
+    // capacity is rounded up to a power of 2
+    explicit mpmc_ring(size_t capacity) : capacity_(round_up(capacity)), mask_(capacity_ - 1)
+    { slots_ = std::make_unique<slot[]>(capacity_); }
+
+    mpmc_ring(const mpmc_ring&) = delete;
+    mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+    // blocks while the ring is full
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+      auto head = head_.fetch_add(1, std::memory_order_relaxed);
+      write(head, std::forward<Args>(args)...);
+    }
+    void push(T&& value) { emplace(std::move(value)); }
+    void push(const T& value) { emplace(value); }
+
+    // returns false if the ring is full
+    template <typename... Args>
+    bool try_emplace(Args&&... args)
+    {
+      auto head = head_.load(std::memory_order_acquire);
+      while (true) {
+        if (get_slot(head).turn.load(std::memory_order_acquire) == write_turn(head)) {
+          if (head_.compare_exchange_strong(head, head + 1, std::memory_order_relaxed)) {
+            write(head, std::forward<Args>(args)...);
+            return true;
+          }
+        }
+        else {
+          auto prev_head = head;
+          head = head_.load(std::memory_order_acquire);
+          // the slot is still occupied by the previous lap
+          if (head == prev_head)
+            return false;
+        }
+      }
+    }
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+    bool try_push(const T& value) { return try_emplace(value); }
+
+    // blocks while the ring is empty
+    T pop()
+    {
+      auto tail = tail_.fetch_add(1, std::memory_order_relaxed);
+      return read(tail);
+    }
+
+    std::optional<T> try_pop()
+    {
+      auto tail = tail_.load(std::memory_order_acquire);
+      while (true) {
+        if (get_slot(tail).turn.load(std::memory_order_acquire) == read_turn(tail)) {
+          if (tail_.compare_exchange_strong(tail, tail + 1, std::memory_order_relaxed))
+            return read(tail);
+        }
+        else {
+          auto prev_tail = tail;
+          tail = tail_.load(std::memory_order_acquire);
+          if (tail == prev_tail)
+            return std::nullopt;
+        }
+      }
+    }
+
+    // batch variants claim consecutive indices with a single atomic operation
+
+    // blocks until all the elements are pushed
+    template <typename InputIt>
+    void push_batch(InputIt first, size_t count)
+    {
+      auto head = head_.fetch_add(count, std::memory_order_relaxed);
+      for (size_t i = 0; i < count; i++, ++first)
+        write(head + i, std::move(*first));
+    }
+
+    // pushes as many elements as the free slots, returns the pushed count
+    template <typename InputIt>
+    size_t try_push_batch(InputIt first, size_t count)
+    {
+      auto head = head_.load(std::memory_order_acquire);
+      while (true) {
+        // count ready slots from the head
+        size_t ready = 0;
+        while (ready < count && ready < capacity_ &&
+               get_slot(head + ready).turn.load(std::memory_order_acquire) == write_turn(head + ready))
+          ready++;
+        if (ready == 0) {
+          auto prev_head = head;
+          head = head_.load(std::memory_order_acquire);
+          if (head == prev_head)
+            return 0;
+          continue;
+        }
+        if (head_.compare_exchange_strong(head, head + ready, std::memory_order_relaxed)) {
+          for (size_t i = 0; i < ready; i++, ++first)
+            write(head + i, std::move(*first));
+          return ready;
+        }
+      }
+    }
+
+    // blocks until count elements are popped
+    template <typename OutputIt>
+    OutputIt pop_batch(OutputIt out, size_t count)
+    {
+      auto tail = tail_.fetch_add(count, std::memory_order_relaxed);
+      for (size_t i = 0; i < count; i++, ++out)
+        *out = read(tail + i);
+      return out;
+    }
+
+    // pops up to max_count elements, returns the popped count
+    template <typename OutputIt>
+    size_t try_pop_batch(OutputIt out, size_t max_count)
+    {
+      auto tail = tail_.load(std::memory_order_acquire);
+      while (true) {
+        size_t ready = 0;
+        while (ready < max_count && ready < capacity_ &&
+               get_slot(tail + ready).turn.load(std::memory_order_acquire) == read_turn(tail + ready))
+          ready++;
+        if (ready == 0) {
+          auto prev_tail = tail;
+          tail = tail_.load(std::memory_order_acquire);
+          if (tail == prev_tail)
+            return 0;
+          continue;
+        }
+        if (tail_.compare_exchange_strong(tail, tail + ready, std::memory_order_relaxed)) {
+          for (size_t i = 0; i < ready; i++, ++out)
+            *out = read(tail + i);
+          return ready;
+        }
+      }
+    }
+
+    // approximate while other threads are running
+    size_t size() const
+    {
+      auto head = head_.load(std::memory_order_relaxed);
+      auto tail = tail_.load(std::memory_order_relaxed);
+      return head > tail ? head - tail : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+    // indices claimed by the pushes so far. a single consumer pops them in this order,
+    // so it can use them as the tickets of the elements.
+    size_t get_push_ticket() const { return head_.load(std::memory_order_acquire); }
+
+  private:
+    static size_t round_up(size_t capacity)
+    {
+      size_t ret = 1;
+      while (ret < capacity)
+        ret <<= 1;
+      return ret;
+    }
+
+    slot& get_slot(size_t index) { return slots_[index & mask_]; }
+    size_t write_turn(size_t index) const { return (index / capacity_) * 2; }
+    size_t read_turn(size_t index) const { return (index / capacity_) * 2 + 1; }
+
+    template <typename... Args>
+    void write(size_t index, Args&&... args)
+    {
+      auto& s = get_slot(index);
+      wait_for_turn(s.turn, write_turn(index));
+      new (s.storage) T(std::forward<Args>(args)...);
+      s.turn.store(read_turn(index), std::memory_order_release);
+      s.turn.notify_all();
+    }
+
+    T read(size_t index)
+    {
+      auto& s = get_slot(index);
+      wait_for_turn(s.turn, read_turn(index));
+      T value = std::move(*s.get());
+      s.get()->~T();
+      s.turn.store(write_turn(index) + 2, std::memory_order_release);
+      s.turn.notify_all();
+      return value;
+    }
+
+    static void wait_for_turn(std::atomic<size_t>& turn, size_t expected)
+    {
+      // the turn usually comes soon, so spin before sleeping
+      constexpr int spin_count = 64;
+      for (int i = 0; ; i++) {
+        auto current = turn.load(std::memory_order_acquire);
+        if (current == expected)
+          return;
+        if (i >= spin_count)
+          turn.wait(current, std::memory_order_acquire);
+      }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    u_ptr<slot[]> slots_;
+
+    // written by producers and consumers respectively
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_ = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_ = 0;
+};
+
+} // namespace hnll::utils
@@ -4,10 +4,18 @@
 #include <utils/common_alias.hpp>
 
 // std
+#include <atomic>
+#include <cassert>
 #include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 namespace hnll::utils {
 
+// to avoid false sharing between frequently updated atomics
+constexpr size_t CACHE_LINE_SIZE = 64;
+
 // thread-safe queue on a double-linked list
 template<typename T>
 class mt_deque {
@@ -138,4 +146,172 @@ class mt_deque {
     std::condition_variable data_cond_;
 };
 
+// ---------------------------------------------------------------------------
+
+// lock-free work-stealing deque (chase-lev)
+// the owner thread pushes and pops at the bottom, other threads steal from the top.
+// https://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+template<typename T>
+class ws_deque {
+    static_assert(std::is_trivially_copyable_v<T>, "ws_deque : T should be trivially copyable.");
+
+    // circular buffer whose capacity is 2^k
+    struct ring {
+      explicit ring(int64_t cap) : capacity(cap), mask(cap - 1), slots(std::make_unique<std::atomic<T>[]>(cap)) {}
+
+      T load(int64_t i) const      { return slots[i & mask].load(std::memory_order_relaxed); }
+      void store(int64_t i, T val) { slots[i & mask].store(val, std::memory_order_relaxed); }
+
+      int64_t capacity;
+      int64_t mask;
+      u_ptr<std::atomic<T>[]> slots;
+    };
+
+  public:
+    // capacity should be 2^k
+    explicit ws_deque(int64_t capacity = 256) : top_(0), bottom_(0)
+    {
+      assert((capacity & (capacity - 1)) == 0 && "ws_deque : capacity should be 2^k.");
+      rings_.emplace_back(std::make_unique<ring>(capacity));
+      ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    ws_deque(const ws_deque &) = delete;
+
+    ws_deque &operator=(const ws_deque &) = delete;
+
+    // owner only
+    void push(T value) {
+      auto b = bottom_.load(std::memory_order_relaxed);
+      auto t = top_.load(std::memory_order_acquire);
+      auto r = ring_.load(std::memory_order_relaxed);
+
+      if (b - t > r->capacity - 1)
+        r = grow(r, b, t);
+
+      r->store(b, value);
+      // publish the element to thieves
+      bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only
+    std::optional<T> pop() {
+      auto b = bottom_.load(std::memory_order_relaxed) - 1;
+      auto r = ring_.load(std::memory_order_relaxed);
+      bottom_.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto t = top_.load(std::memory_order_relaxed);
+
+      // empty
+      if (t > b) {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+
+      std::optional<T> ret = r->load(b);
+      // the last element : race against thieves
+      if (t == b) {
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          ret = std::nullopt;
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+      return ret;
+    }
+
+    // any thread
+    // returns nullopt if the deque is empty or another thread won the race
+    std::optional<T> steal() {
+      auto t = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto b = bottom_.load(std::memory_order_acquire);
+
+      if (t >= b)
+        return std::nullopt;
+
+      auto r = ring_.load(std::memory_order_acquire);
+      T ret = r->load(t);
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return std::nullopt;
+      return ret;
+    }
+
+    // approximate values if other threads are working on this deque
+    bool empty() const { return size() == 0; }
+
+    size_t size() const {
+      auto b = bottom_.load(std::memory_order_relaxed);
+      auto t = top_.load(std::memory_order_relaxed);
+      return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+  private:
+    // owner only
+    ring* grow(ring* old_ring, int64_t b, int64_t t) {
+      auto new_ring = std::make_unique<ring>(old_ring->capacity * 2);
+      for (auto i = t; i < b; i++)
+        new_ring->store(i, old_ring->load(i));
+
+      // old rings are kept alive until destruction, since thieves may still be reading them
+      auto ret = new_ring.get();
+      rings_.emplace_back(std::move(new_ring));
+      ring_.store(ret, std::memory_order_release);
+      return ret;
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top_;
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_;
+    alignas(CACHE_LINE_SIZE) std::atomic<ring*> ring_;
+    std::vector<u_ptr<ring>> rings_;
+};
+
+// ---------------------------------------------------------------------------
+
+// thread-safe fifo of caller-owned nodes linked by T::next, doesn't allocate
+template <typename T>
+class mt_intrusive_queue
+{
+  public:
+    mt_intrusive_queue() = default;
+    mt_intrusive_queue(const mt_intrusive_queue&) = delete;
+    mt_intrusive_queue& operator=(const mt_intrusive_queue&) = delete;
+
+    void push_tail(T* new_node)
+    {
+      new_node->next = nullptr;
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (tail_)
+        tail_->next = new_node;
+      else
+        head_ = new_node;
+      tail_ = new_node;
+      size_.store(size_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // returns nullptr if empty
+    T* try_pop_front()
+    {
+      // skip locking for the common empty case
+      if (empty())
+        return nullptr;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto node = head_;
+      if (node == nullptr)
+        return nullptr;
+      head_ = node->next;
+      if (head_ == nullptr)
+        tail_ = nullptr;
+      size_.store(size_.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+      return node;
+    }
+
+    bool empty() const { return size_.load(std::memory_order_acquire) == 0; }
+
+  private:
+    std::mutex mutex_;
+    T* head_ = nullptr;
+    T* tail_ = nullptr;
+    std::atomic<size_t> size_ = 0;
+};
+
 } // namespace hnll::utils
\ No newline at end of file
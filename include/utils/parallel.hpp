@@ -0,0 +1,216 @@
+#pragma once
+
+// hnll
+#include <utils/thread_pool.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+// range based parallel algorithms on thread_pool
+// ranges are split recursively in half until they get smaller than the grain size.
+// the latter half is spawned to the local queue, so that thieves take the largest chunks.
+// no future is allocated per chunk, completion is tracked by a single atomic counter.
+
+namespace hnll::utils {
+
+// ~8 chunks per worker by default
+inline size_t default_grain_size(const thread_pool& pool, size_t count)
+{ return std::max<size_t>(1, count / (pool.get_thread_count() * 8)); }
+
+// ---------------------------------------------------------------------------
+
+// shared by every chunk of a single parallel call
+class parallel_context
+{
+  public:
+    void add_pending(uint32_t count = 1) { pending_count_.fetch_add(count, std::memory_order_relaxed); }
+
+    void finish_pending()
+    {
+      if (pending_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        pending_count_.notify_all();
+    }
+
+    // keep the first exception thrown by the chunks
+    void set_exception(std::exception_ptr exception)
+    {
+      if (!has_exception_.test_and_set(std::memory_order_acq_rel))
+        exception_ = exception;
+    }
+
+    // help other workers until all the chunks are done
+    void wait(thread_pool& pool)
+    {
+      for (auto count = pending_count_.load(std::memory_order_acquire);
+           count != 0;
+           count = pending_count_.load(std::memory_order_acquire)) {
+        // remaining chunks are being run by other threads
+        if (!pool.run_pending_task())
+          pending_count_.wait(count, std::memory_order_acquire);
+      }
+      if (exception_)
+        std::rethrow_exception(exception_);
+    }
+
+    // for reuse, call after wait()
+    void reset()
+    {
+      assert(pending_count_ == 0);
+      has_exception_.clear();
+      exception_ = nullptr;
+    }
+
+  private:
+    std::atomic<uint32_t> pending_count_ = 0;
+    std::atomic_flag has_exception_;
+    std::exception_ptr exception_;
+};
+
+template <typename Func>
+void parallel_for_range(
+  thread_pool& pool,
+  const s_ptr<parallel_context>& context,
+  size_t begin,
+  size_t end,
+  size_t grain_size,
+  Func& f)
+{
+  // split the range and give away the latter half
+  while (end - begin > grain_size) {
+    auto mid = begin + (end - begin) / 2;
+    context->add_pending();
+    pool.spawn([&pool, context, mid, end, grain_size, &f]() {
+      try { parallel_for_range(pool, context, mid, end, grain_size, f); }
+      catch (...) { context->set_exception(std::current_exception()); }
+      context->finish_pending();
+    });
+    end = mid;
+  }
+
+  if constexpr (std::is_invocable_v<Func&, size_t, size_t>) {
+    f(begin, end);
+  }
+  else {
+    for (auto i = begin; i < end; i++)
+      f(i);
+  }
+}
+
+// f is called either per index f(i) or per chunk f(chunk_begin, chunk_end)
+// grain_size : max chunk size, 0 for default_grain_size()
+template <typename Func>
+void parallel_for(thread_pool& pool, size_t begin, size_t end, Func&& f, size_t grain_size = 0)
+{
+  if (begin >= end)
+    return;
+  if (grain_size == 0)
+    grain_size = default_grain_size(pool, end - begin);
+
+  // run in place if the range is small enough
+  if (end - begin <= grain_size) {
+    parallel_for_range(pool, nullptr, begin, end, grain_size, f);
+    return;
+  }
+
+  auto context = std::allocate_shared<parallel_context>(pool_allocator<parallel_context>{});
+  try {
+    parallel_for_range(pool, context, begin, end, grain_size, f);
+  }
+  catch (...) {
+    context->set_exception(std::current_exception());
+  }
+  context->wait(pool);
+}
+
+// ---------------------------------------------------------------------------
+
+// reduce(chunk_begin, chunk_end, init) -> T folds a chunk into init
+// combine(T, T) -> T joins two partial results
+// chunk partials are combined in order, so the result doesn't depend on the scheduling
+template <typename T, typename Reduce, typename Combine>
+T parallel_reduce(
+  thread_pool& pool,
+  size_t begin,
+  size_t end,
+  T identity,
+  Reduce&& reduce,
+  Combine&& combine,
+  size_t grain_size = 0)
+{
+  if (begin >= end)
+    return identity;
+  if (grain_size == 0)
+    grain_size = default_grain_size(pool, end - begin);
+
+  const auto chunk_count = (end - begin + grain_size - 1) / grain_size;
+  std::vector<T> partials(chunk_count, identity);
+
+  parallel_for(pool, 0, chunk_count, [&](size_t chunk) {
+    auto chunk_begin = begin + chunk * grain_size;
+    auto chunk_end = std::min(chunk_begin + grain_size, end);
+    partials[chunk] = reduce(chunk_begin, chunk_end, identity);
+  }, 1);
+
+  auto result = std::move(identity);
+  for (auto& partial : partials)
+    result = combine(std::move(result), std::move(partial));
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+
+// inclusive scan : out[i] = op(in[0], ..., in[i]), in place if out == first
+// two passes : chunk sums -> serial prefix of the sums -> per chunk scan with the offset
+template <typename InputIt, typename OutputIt, typename T, typename Op>
+void parallel_scan(
+  thread_pool& pool,
+  InputIt first,
+  InputIt last,
+  OutputIt out,
+  T identity,
+  Op&& op,
+  size_t grain_size = 0)
+{
+  static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>,
+    "parallel_scan requires random access iterators.");
+
+  const auto count = static_cast<size_t>(std::distance(first, last));
+  if (count == 0)
+    return;
+  if (grain_size == 0)
+    grain_size = default_grain_size(pool, count);
+
+  const auto chunk_count = (count + grain_size - 1) / grain_size;
+  std::vector<T> offsets(chunk_count, identity);
+
+  // 1st pass : sum of each chunk (the last chunk is not needed)
+  parallel_for(pool, 0, chunk_count - 1, [&](size_t chunk) {
+    auto sum = identity;
+    auto chunk_end = (chunk + 1) * grain_size;
+    for (auto i = chunk * grain_size; i < chunk_end; i++)
+      sum = op(std::move(sum), first[i]);
+    offsets[chunk + 1] = std::move(sum);
+  }, 1);
+
+  // exclusive prefix of the chunk sums
+  for (size_t chunk = 1; chunk < chunk_count; chunk++)
+    offsets[chunk] = op(offsets[chunk - 1], offsets[chunk]);
+
+  // 2nd pass : scan each chunk from its offset
+  parallel_for(pool, 0, chunk_count, [&](size_t chunk) {
+    auto sum = offsets[chunk];
+    auto chunk_end = std::min((chunk + 1) * grain_size, count);
+    for (auto i = chunk * grain_size; i < chunk_end; i++) {
+      sum = op(std::move(sum), first[i]);
+      out[i] = sum;
+    }
+  }, 1);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,178 @@
+#pragma once
+
+// hnll
+#include <utils/macros.hpp>
+#include <utils/scope_registry.hpp>
+
+// std
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// hardware performance counters (linux perf_event_open) of named scopes and threads
+//
+//   void update_field()
+//   {
+//     HNLL_PERF_SCOPE("fdtd update");
+//     ...
+//   }
+//
+// each thread opens its own counter group on the first scope, and the group is read at the both ends
+// of the scope with one syscall per kernel group (two at most, see perf_counter_group). the totals per
+// scope and per thread (thread_pool workers are named by HNLL_PERF_THREAD_NAME) can be written to csv.
+// if the kernel doesn't allow the counters (containers, perf_event_paranoid, virtual machines, non-linux),
+// the unavailable counters are just skipped, and the scopes cost a null check when none is available.
+// the macros expand to nothing unless HNLL_PERF_COUNTERS is defined (cmake -DHNLL_PERF_COUNTERS=ON).
+
+namespace hnll::utils {
+
+enum class perf_counter : uint8_t
+{
+  CYCLES,
+  INSTRUCTIONS,
+  CACHE_REFERENCES, // last level cache
+  CACHE_MISSES,
+  BRANCHES,
+  BRANCH_MISSES,
+  STALLED_CYCLES_FRONTEND,
+  STALLED_CYCLES_BACKEND,
+  // software counters, available where the hardware ones are not
+  TASK_CLOCK, // ns on cpu
+  PAGE_FAULTS,
+};
+constexpr size_t PERF_COUNTER_COUNT = 10;
+
+struct perf_sample
+{
+  bool has(perf_counter counter) const { return valid_mask & (1u << static_cast<uint32_t>(counter)); }
+  uint64_t get(perf_counter counter) const { return values[static_cast<size_t>(counter)]; }
+
+  // 0 if the counters are unavailable
+  double get_ipc() const { return get_ratio(perf_counter::INSTRUCTIONS, perf_counter::CYCLES); }
+  double get_cache_miss_rate() const { return get_ratio(perf_counter::CACHE_MISSES, perf_counter::CACHE_REFERENCES); }
+  double get_branch_miss_rate() const { return get_ratio(perf_counter::BRANCH_MISSES, perf_counter::BRANCHES); }
+  double get_ratio(perf_counter numerator, perf_counter denominator) const;
+
+  perf_sample& operator+=(const perf_sample& other);
+  perf_sample operator-(const perf_sample& other) const;
+
+  std::array<uint64_t, PERF_COUNTER_COUNT> values{};
+  // opened counters
+  uint32_t valid_mask = 0;
+};
+
+// counters of the thread which opened the group.
+// read() may be called from the other threads.
+// the counters are opened as two kernel groups (the core events and the others), the pmu schedules
+// a group all or nothing and eight hardware events don't fit at once on the common x86 cores.
+// a kernel group which is never scheduled is reported as unavailable.
+class perf_counter_group
+{
+  public:
+    static constexpr uint32_t ALL_COUNTERS = (1u << PERF_COUNTER_COUNT) - 1;
+    static constexpr size_t KERNEL_GROUP_COUNT = 2;
+
+    // starts counting the user space of the calling thread, the counters which can't be opened are skipped
+    explicit perf_counter_group(uint32_t counter_mask = ALL_COUNTERS);
+    ~perf_counter_group();
+
+    perf_counter_group(const perf_counter_group&) = delete;
+    perf_counter_group& operator=(const perf_counter_group&) = delete;
+    perf_counter_group(perf_counter_group&& other) noexcept;
+    perf_counter_group& operator=(perf_counter_group&& other) noexcept;
+
+    bool is_available() const { return valid_mask_ != 0; }
+    bool has(perf_counter counter) const { return valid_mask_ & (1u << static_cast<uint32_t>(counter)); }
+    uint32_t get_valid_mask() const { return valid_mask_; }
+    // why the first unavailable counter failed to open, empty if all are available
+    const std::string& get_error() const { return error_; }
+
+    void reset();
+    void enable();
+    void disable();
+    // counts since the creation or reset(), scaled if the kernel multiplexed the counters
+    perf_sample read() const;
+
+  private:
+    void close();
+
+    std::array<int, KERNEL_GROUP_COUNT> leader_fds_;
+    std::array<int, PERF_COUNTER_COUNT> fds_;
+    std::array<uint64_t, PERF_COUNTER_COUNT> ids_{};
+    uint32_t valid_mask_ = 0;
+    std::string error_;
+};
+
+class perf_counters
+{
+  public:
+    using scope_id = utils::scope_id;
+    static constexpr size_t MAX_SCOPE_COUNT = utils::MAX_SCOPE_COUNT;
+    // returned by register_scope() beyond MAX_SCOPE_COUNT, ignored by record()
+    static constexpr scope_id INVALID_SCOPE_ID = utils::INVALID_SCOPE_ID;
+
+    struct scope_summary
+    {
+      std::string name;
+      uint64_t count;
+      perf_sample total;
+    };
+
+    struct thread_summary
+    {
+      std::string name;
+      perf_sample total;
+    };
+
+    // the same name returns the same id, INVALID_SCOPE_ID if there are too many scopes.
+    // the name is copied.
+    static scope_id register_scope(const char* name);
+    // group of the calling thread, opened on the first call. nullptr if no counter is available.
+    static const perf_counter_group* get_thread_group();
+    // shown in the thread summaries, also opens the group
+    static void set_thread_name(const std::string& name);
+    static void record(scope_id id, const perf_sample& delta);
+
+    // merged over the threads, sorted by the registration
+    static std::vector<scope_summary> get_scope_summaries();
+    // totals of each thread since its group was opened, including the finished threads
+    static std::vector<thread_summary> get_thread_summaries();
+    // resets the scope totals
+    static void clear();
+    static bool write_csv(const std::string& path);
+
+    static const char* get_counter_name(perf_counter counter);
+};
+
+class perf_scope
+{
+  public:
+    explicit perf_scope(perf_counters::scope_id id)
+      : id_(id), group_(id != perf_counters::INVALID_SCOPE_ID ? perf_counters::get_thread_group() : nullptr)
+    { if (group_) start_ = group_->read(); }
+    ~perf_scope() { if (group_) perf_counters::record(id_, group_->read() - start_); }
+
+    perf_scope(const perf_scope&) = delete;
+    perf_scope& operator=(const perf_scope&) = delete;
+
+  private:
+    perf_counters::scope_id id_;
+    const perf_counter_group* group_;
+    perf_sample start_;
+};
+
+} // namespace hnll::utils
+
+#ifdef HNLL_PERF_COUNTERS
+// the scope is registered once per call site
+#define HNLL_PERF_SCOPE(name) \
+  static const auto HNLL_CONCAT(hnll_perf_id_, __LINE__) = ::hnll::utils::perf_counters::register_scope(name); \
+  ::hnll::utils::perf_scope HNLL_CONCAT(hnll_perf_scope_, __LINE__){ HNLL_CONCAT(hnll_perf_id_, __LINE__) }
+#define HNLL_PERF_THREAD_NAME(name) ::hnll::utils::perf_counters::set_thread_name(name)
+#define HNLL_PERF_WRITE_CSV(path) ::hnll::utils::perf_counters::write_csv(path)
+#else
+#define HNLL_PERF_SCOPE(name)
+#define HNLL_PERF_THREAD_NAME(name)
+#define HNLL_PERF_WRITE_CSV(path)
+#endif
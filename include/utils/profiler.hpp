@@ -0,0 +1,103 @@
+#pragma once
+
+// hnll
+#include <utils/macros.hpp>
+
+// std
+#include <cstdint>
+#include <string>
+
+// trace profiler, writes chrome trace json (chrome://tracing or ui.perfetto.dev)
+//
+//   void update()
+//   {
+//     HNLL_PROFILE_SCOPE("update");
+//     ...
+//     HNLL_PROFILE_COUNTER("particle count", particles.size());
+//   }
+//
+// each thread records events into its own wait-free ring buffer,
+// and HNLL_PROFILE_COLLECT() moves them out (the engine calls it once per frame).
+// the collected events of each thread are capped too, the oldest ones are dropped beyond the cap.
+// the macros expand to nothing unless HNLL_PROFILE is defined (cmake -DHNLL_PROFILE=ON).
+// event names should be string literals, only the pointers are recorded.
+
+namespace hnll::utils {
+
+enum class trace_event_type : uint32_t
+{
+  BEGIN,
+  END,
+  INSTANT,
+  COUNTER
+};
+
+class profiler
+{
+  public:
+    // events are dropped while the ring of the thread is full.
+    // a dropped begin drops its end and the nested events too, so that the trace stays balanced
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 15;
+    // collected events kept per thread until clear(), the oldest quarter is dropped when it's exceeded.
+    // the begins of the still open scopes are kept
+    static constexpr size_t MAX_COLLECTED_EVENTS = 1 << 20;
+
+    static void begin(const char* name) { record(trace_event_type::BEGIN, name, 0.0); }
+    static void end() { record(trace_event_type::END, nullptr, 0.0); }
+    static void instant(const char* name) { record(trace_event_type::INSTANT, name, 0.0); }
+    static void counter(const char* name, double value) { record(trace_event_type::COUNTER, name, value); }
+
+    // shown as the track name of the calling thread
+    static void set_thread_name(const std::string& name);
+
+    // moves the recorded events of all the threads to the profiler, thread safe
+    static void collect();
+    // writes the collected events, returns false if the file can't be opened
+    static bool write_trace(const std::string& path);
+    // drops the collected events and the buffers of the finished threads
+    static void clear();
+    static void set_max_collected_events(size_t count);
+
+    static size_t get_event_count();
+    // dropped by the full rings and the collected event cap
+    static size_t get_dropped_count();
+
+    // steady_clock nanoseconds, or the TSC ticks with HNLL_PROFILE_USE_TSC on x86
+    static uint64_t now();
+
+  private:
+    static void record(trace_event_type type, const char* name, double value);
+};
+
+struct profile_scope
+{
+  explicit profile_scope(const char* name) { profiler::begin(name); }
+  ~profile_scope() { profiler::end(); }
+
+  profile_scope(const profile_scope&) = delete;
+  profile_scope& operator=(const profile_scope&) = delete;
+};
+
+} // namespace hnll::utils
+
+#ifdef HNLL_PROFILE
+#define HNLL_PROFILE_SCOPE(name) ::hnll::utils::profile_scope HNLL_CONCAT(hnll_profile_scope_, __LINE__){ name }
+#define HNLL_PROFILE_FUNCTION() HNLL_PROFILE_SCOPE(__func__)
+#define HNLL_PROFILE_BEGIN(name) ::hnll::utils::profiler::begin(name)
+#define HNLL_PROFILE_END() ::hnll::utils::profiler::end()
+#define HNLL_PROFILE_INSTANT(name) ::hnll::utils::profiler::instant(name)
+#define HNLL_PROFILE_COUNTER(name, value) ::hnll::utils::profiler::counter(name, static_cast<double>(value))
+#define HNLL_PROFILE_THREAD_NAME(name) ::hnll::utils::profiler::set_thread_name(name)
+#define HNLL_PROFILE_COLLECT() ::hnll::utils::profiler::collect()
+#define HNLL_PROFILE_WRITE(path) ::hnll::utils::profiler::write_trace(path)
+#else
+#define HNLL_PROFILE_SCOPE(name)
+#define HNLL_PROFILE_FUNCTION()
+#define HNLL_PROFILE_BEGIN(name)
+#define HNLL_PROFILE_END()
+#define HNLL_PROFILE_INSTANT(name)
+#define HNLL_PROFILE_COUNTER(name, value)
+#define HNLL_PROFILE_THREAD_NAME(name)
+#define HNLL_PROFILE_COLLECT()
+#define HNLL_PROFILE_WRITE(path)
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+// std
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// building blocks of the per-scope registries (scope_stats, perf_counters)
+//
+// - scope_names : name -> id table, guarded by the mutex of the owner registry
+// - scope_slots : per thread values of each scope, written by the owner thread without locking
+// - thread_exit_hook : hands the thread's state back to the registry at the thread exit
+
+namespace hnll::utils {
+
+using scope_id = uint32_t;
+constexpr size_t MAX_SCOPE_COUNT = 128;
+// returned by scope_names::add() beyond MAX_SCOPE_COUNT, ignored by the recorders
+constexpr scope_id INVALID_SCOPE_ID = static_cast<scope_id>(-1);
+
+class scope_names
+{
+  public:
+    // the same name returns the same id, INVALID_SCOPE_ID if there are too many scopes.
+    // copied, the callers may pass temporary strings
+    scope_id add(const char* name)
+    {
+      for (scope_id id = 0; id < names_.size(); id++) {
+        if (names_[id] == name)
+          return id;
+      }
+      if (names_.size() >= MAX_SCOPE_COUNT)
+        return INVALID_SCOPE_ID;
+      names_.emplace_back(name);
+      return static_cast<scope_id>(names_.size() - 1);
+    }
+
+    size_t size() const { return names_.size(); }
+    const std::string& operator[](scope_id id) const { return names_[id]; }
+
+  private:
+    std::vector<std::string> names_;
+};
+
+template <typename T>
+class scope_slots
+{
+  public:
+    scope_slots() = default;
+    ~scope_slots()
+    {
+      for (auto& slot : slots_)
+        delete slot.load(std::memory_order_relaxed);
+    }
+
+    scope_slots(const scope_slots&) = delete;
+    scope_slots& operator=(const scope_slots&) = delete;
+
+    // called by the owner thread, the value is created on the first record of each scope
+    T& get_or_create(scope_id id)
+    {
+      auto value = slots_[id].load(std::memory_order_relaxed);
+      if (!value) {
+        value = new T;
+        // publish to the readers
+        slots_[id].store(value, std::memory_order_release);
+      }
+      return *value;
+    }
+
+    // nullptr if the owner hasn't recorded the scope yet, may be called from the other threads
+    T* find(scope_id id) const { return slots_[id].load(std::memory_order_acquire); }
+
+  private:
+    std::array<std::atomic<T*>, MAX_SCOPE_COUNT> slots_{};
+};
+
+// declared static thread_local, calls on_exit(state) when the thread exits
+template <typename T>
+struct thread_exit_hook
+{
+  ~thread_exit_hook() { if (state) on_exit(state); }
+  T* state = nullptr;
+  void (*on_exit)(T*) = nullptr;
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,155 @@
+#pragma once
+
+// hnll
+#include <utils/macros.hpp>
+#include <utils/scope_registry.hpp>
+
+// std
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// aggregate latency statistics of named scopes
+//
+//   void update()
+//   {
+//     HNLL_STAT_SCOPE("update");
+//     ...
+//   }
+//
+// each thread records into its own histogram without locking.
+// HNLL_STAT_END_FRAME() summarizes min / mean / p50 / p99 / max of every scope per N frames,
+// and the latest summaries can be written to csv or json at any time.
+// the macros expand to nothing unless HNLL_STATS is defined (cmake -DHNLL_STATS=ON).
+
+namespace hnll::utils {
+
+struct histogram_snapshot;
+
+// log-linear (hdr style) histogram of nanoseconds, relative error is below 1 / SUB_BUCKET_COUNT
+class latency_histogram
+{
+  public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    // up to 2^40 ns (~18 min), larger values are clamped
+    static constexpr uint32_t MAX_VALUE_BITS = 40;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT * (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1);
+
+    // called by the owner thread
+    void record(uint64_t value);
+    // moves the recorded values into the snapshot, safe while the owner is recording.
+    // the calls should be serialized
+    void drain_into(histogram_snapshot& snapshot);
+
+    static size_t get_bucket_index(uint64_t value);
+    // middle of the bucket range
+    static uint64_t get_bucket_value(size_t index);
+
+  private:
+    struct counts
+    {
+      std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+      std::atomic<uint64_t> sum = 0;
+      std::atomic<uint64_t> min = std::numeric_limits<uint64_t>::max();
+      std::atomic<uint64_t> max = 0;
+    };
+
+    // the owner records into counts_[active_], drain_into() swaps them
+    // and reads the other one after the owner leaves it, so that a snapshot is consistent
+    std::array<counts, 2> counts_;
+    std::atomic<uint32_t> active_ = 0;
+    // odd while the owner is recording
+    std::atomic<uint64_t> sequence_ = 0;
+};
+
+struct histogram_snapshot
+{
+  void merge(const histogram_snapshot& other);
+  // percentile in [0, 100]
+  uint64_t get_percentile(double percentile) const;
+  double get_mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+
+  std::array<uint64_t, latency_histogram::BUCKET_COUNT> buckets{};
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = std::numeric_limits<uint64_t>::max();
+  uint64_t max = 0;
+};
+
+class scope_stats
+{
+  public:
+    using scope_id = utils::scope_id;
+    static constexpr size_t MAX_SCOPE_COUNT = utils::MAX_SCOPE_COUNT;
+    // returned by register_scope() beyond MAX_SCOPE_COUNT, ignored by record()
+    static constexpr scope_id INVALID_SCOPE_ID = utils::INVALID_SCOPE_ID;
+    static constexpr uint32_t DEFAULT_FRAME_WINDOW = 300;
+
+    // in microseconds
+    struct summary
+    {
+      std::string name;
+      uint64_t count;
+      double min;
+      double mean;
+      double p50;
+      double p99;
+      double max;
+    };
+
+    // the same name returns the same id, INVALID_SCOPE_ID if there are too many scopes.
+    // the name is copied.
+    static scope_id register_scope(const char* name);
+    static void record(scope_id id, uint64_t nanoseconds);
+
+    // summarizes every frame_window frames
+    static void end_frame();
+    static void set_frame_window(uint32_t frame_window);
+    // summarizes the values recorded since the last summary
+    static void summarize();
+
+    // of the last window, sorted by the registration
+    static std::vector<summary> get_summaries();
+    static bool write_csv(const std::string& path);
+    static bool write_json(const std::string& path);
+};
+
+class stat_scope
+{
+  public:
+    explicit stat_scope(scope_stats::scope_id id) : id_(id), start_(std::chrono::steady_clock::now()) {}
+    ~stat_scope()
+    {
+      auto elapsed = std::chrono::steady_clock::now() - start_;
+      scope_stats::record(id_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    stat_scope(const stat_scope&) = delete;
+    stat_scope& operator=(const stat_scope&) = delete;
+
+  private:
+    scope_stats::scope_id id_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace hnll::utils
+
+#ifdef HNLL_STATS
+// the scope is registered once per call site
+#define HNLL_STAT_SCOPE(name) \
+  static const auto HNLL_CONCAT(hnll_stat_id_, __LINE__) = ::hnll::utils::scope_stats::register_scope(name); \
+  ::hnll::utils::stat_scope HNLL_CONCAT(hnll_stat_scope_, __LINE__){ HNLL_CONCAT(hnll_stat_id_, __LINE__) }
+#define HNLL_STAT_END_FRAME() ::hnll::utils::scope_stats::end_frame()
+#define HNLL_STAT_WRITE_JSON(path) ::hnll::utils::scope_stats::write_json(path)
+#define HNLL_STAT_WRITE_CSV(path) ::hnll::utils::scope_stats::write_csv(path)
+#else
+#define HNLL_STAT_SCOPE(name)
+#define HNLL_STAT_END_FRAME()
+#define HNLL_STAT_WRITE_JSON(path)
+#define HNLL_STAT_WRITE_CSV(path)
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+
+// hnll
+#include <utils/common_alias.hpp>
+#include <utils/mt_queue.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace hnll::utils {
+
+// wait-free single-producer single-consumer ring buffer of POD samples
+// e.g. a simulation thread writes audio samples, an audio thread reads them.
+//
+//   auto span = ring.prepare_write(count); // contiguous free region
+//   fill(span);
+//   ring.commit_write(span.size());        // publish to the reader
+//
+// every function finishes in a bounded number of steps and never allocates.
+template <typename T>
+class spsc_ring
+{
+    static_assert(std::is_trivially_copyable_v<T>, "spsc_ring is for POD samples.");
+
+  public:
+    // capacity is rounded up to a power of 2
+    explicit spsc_ring(size_t capacity) : capacity_(round_up(capacity)), mask_(capacity_ - 1)
+    { buffer_ = std::make_unique<T[]>(capacity_); }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // producer side ----------------------------------------------------------
+
+    // contiguous free region up to max_count, shorter than the free space where the buffer wraps
+    std::span<T> prepare_write(size_t max_count = SIZE_MAX)
+    {
+      auto head = head_.load(std::memory_order_relaxed);
+      auto free_count = capacity_ - (head - cached_tail_);
+      // refresh the reader's index only if the cached one is not enough
+      if (free_count < max_count) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        free_count = capacity_ - (head - cached_tail_);
+      }
+      auto offset = head & mask_;
+      auto count = std::min({ max_count, free_count, capacity_ - offset });
+      return { buffer_.get() + offset, count };
+    }
+
+    void commit_write(size_t count)
+    {
+      auto head = head_.load(std::memory_order_relaxed);
+      assert(head + count - tail_.load(std::memory_order_relaxed) <= capacity_ && "committed more than prepared.");
+      head_.store(head + count, std::memory_order_release);
+    }
+
+    // copies as many samples as fit, returns the written count
+    size_t write(std::span<const T> samples)
+    {
+      size_t written = 0;
+      // at most 2 copies because of the wrap
+      for (int i = 0; i < 2 && written < samples.size(); i++) {
+        auto dst = prepare_write(samples.size() - written);
+        if (dst.empty())
+          break;
+        std::memcpy(dst.data(), samples.data() + written, dst.size_bytes());
+        commit_write(dst.size());
+        written += dst.size();
+      }
+      return written;
+    }
+
+    size_t writable_count()
+    {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      return capacity_ - (head_.load(std::memory_order_relaxed) - cached_tail_);
+    }
+
+    // consumer side ----------------------------------------------------------
+
+    // contiguous readable region up to max_count
+    std::span<const T> peek_read(size_t max_count = SIZE_MAX)
+    {
+      auto tail = tail_.load(std::memory_order_relaxed);
+      auto readable_count = cached_head_ - tail;
+      if (readable_count < max_count) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        readable_count = cached_head_ - tail;
+      }
+      auto offset = tail & mask_;
+      auto count = std::min({ max_count, readable_count, capacity_ - offset });
+      return { buffer_.get() + offset, count };
+    }
+
+    void commit_read(size_t count)
+    {
+      auto tail = tail_.load(std::memory_order_relaxed);
+      assert(tail + count <= head_.load(std::memory_order_relaxed) && "consumed more than peeked.");
+      tail_.store(tail + count, std::memory_order_release);
+    }
+
+    // copies as many samples as available, returns the read count
+    size_t read(std::span<T> samples)
+    {
+      size_t read_count = 0;
+      for (int i = 0; i < 2 && read_count < samples.size(); i++) {
+        auto src = peek_read(samples.size() - read_count);
+        if (src.empty())
+          break;
+        std::memcpy(samples.data() + read_count, src.data(), src.size_bytes());
+        commit_read(src.size());
+        read_count += src.size();
+      }
+      return read_count;
+    }
+
+    size_t readable_count()
+    {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      return cached_head_ - tail_.load(std::memory_order_relaxed);
+    }
+
+    // ------------------------------------------------------------------------
+
+    size_t capacity() const { return capacity_; }
+
+  private:
+    static size_t round_up(size_t capacity)
+    {
+      size_t ret = 1;
+      while (ret < capacity)
+        ret <<= 1;
+      return ret;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    u_ptr<T[]> buffer_;
+
+    // written by the producer, with the reader's index cached to reduce cache line transfers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_ = 0;
+    size_t cached_tail_ = 0;
+    // written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_ = 0;
+    size_t cached_head_ = 0;
+};
+
+} // namespace hnll::utils
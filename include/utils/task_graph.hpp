@@ -0,0 +1,82 @@
+#pragma once
+
+// hnll
+#include <utils/parallel.hpp>
+
+// std
+#include <functional>
+#include <vector>
+
+namespace hnll::utils {
+
+// dependency graph of tasks, built once and run many times (e.g. every frame).
+// a task is pushed to the pool as soon as all of its predecessors finish.
+// the first ready successor runs on the same thread as a continuation.
+// run() only resets the counters, so re-running a graph doesn't allocate graph nodes.
+class task_graph
+{
+  public:
+    using task_id = uint32_t;
+
+    task_graph() : context_(std::make_shared<parallel_context>()) {}
+
+    template <typename Func>
+    task_id add_task(Func&& f);
+
+    // successor starts after predecessor finishes
+    void add_dependency(task_id predecessor, task_id successor);
+
+    // add a task which starts after predecessor finishes
+    template <typename Func>
+    task_id add_continuation(task_id predecessor, Func&& f);
+
+    // run all the tasks and block until they finish, the caller also runs pending tasks.
+    // every task runs even if another one throws, the first exception is rethrown here.
+    void run(thread_pool& pool);
+
+    void clear();
+
+    size_t get_task_count() const { return nodes_.size(); }
+
+  private:
+    struct node
+    {
+      std::function<void()> func;
+      std::vector<task_id> successors;
+      uint32_t predecessor_count = 0;
+      // reset to predecessor_count on each run
+      std::atomic<uint32_t> pending_count = 0;
+    };
+
+    // check cycles and collect root tasks
+    void validate();
+    void spawn_task(thread_pool& pool, task_id id);
+    void run_task(thread_pool& pool, task_id id);
+
+    std::vector<u_ptr<node>> nodes_;
+    std::vector<task_id> roots_;
+    // the graph has been modified since the last validation
+    bool dirty_ = true;
+    // shared with the spawned tasks, so that the last one can notify safely
+    s_ptr<parallel_context> context_;
+};
+
+template <typename Func>
+task_graph::task_id task_graph::add_task(Func&& f)
+{
+  auto new_node = std::make_unique<node>();
+  new_node->func = std::forward<Func>(f);
+  nodes_.emplace_back(std::move(new_node));
+  dirty_ = true;
+  return static_cast<task_id>(nodes_.size() - 1);
+}
+
+template <typename Func>
+task_graph::task_id task_graph::add_continuation(task_id predecessor, Func&& f)
+{
+  auto id = add_task(std::forward<Func>(f));
+  add_dependency(predecessor, id);
+  return id;
+}
+
+} // namespace hnll::utils
@@ -3,10 +3,16 @@
 // hnll
 #include <utils/common_alias.hpp>
 #include <utils/mt_queue.hpp>
+#include <utils/block_pool.hpp>
 
 // std
+#include <array>
+#include <coroutine>
 #include <iostream>
 #include <future>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 // mt is synonym for "multi thread"
 
@@ -33,103 +39,272 @@ class threads_joiner
 
 // ---------------------------------------------------------------------------
 
+// move-only callable, small callables are stored in place without heap allocation
 class function_wrapper
 {
-    struct impl_base
+    // 64 bytes cover a promise + a few captured pointers
+    static constexpr size_t BUFFER_SIZE = 64;
+
+    struct vtable
     {
-      virtual void call() = 0;
-      virtual ~impl_base() {}
+      void (*call)(void* storage);
+      // move-construct dst from src and destroy src
+      void (*move)(void* dst, void* src);
+      void (*destroy)(void* storage);
     };
 
     template <typename F>
-    struct impl_type : impl_base
-    {
-      F f;
-      explicit impl_type(F&& f_) : f(std::move(f_)) {}
-      void call() override { f(); }
+    static constexpr bool is_small = sizeof(F) <= BUFFER_SIZE
+      && alignof(F) <= alignof(std::max_align_t)
+      && std::is_nothrow_move_constructible_v<F>;
+
+    // stored in the buffer
+    template <typename F>
+    static constexpr vtable small_vtable = {
+      [](void* storage) { (*static_cast<F*>(storage))(); },
+      [](void* dst, void* src) {
+        new (dst) F(std::move(*static_cast<F*>(src)));
+        static_cast<F*>(src)->~F();
+      },
+      [](void* storage) { static_cast<F*>(storage)->~F(); }
     };
 
-  public:
+    // the buffer holds a ptr to the heap
     template <typename F>
-    explicit function_wrapper(F&& f) : impl_(new impl_type<F>(std::move(f))) {}
+    static constexpr vtable large_vtable = {
+      [](void* storage) { (**static_cast<F**>(storage))(); },
+      [](void* dst, void* src) { *static_cast<F**>(dst) = *static_cast<F**>(src); },
+      [](void* storage) { delete *static_cast<F**>(storage); }
+    };
 
-    void operator()() { impl_->call(); }
+  public:
+    template <typename F, typename Callable = std::decay_t<F>,
+      typename = std::enable_if_t<!std::is_same_v<Callable, function_wrapper>>>
+    explicit function_wrapper(F&& f)
+    {
+      if constexpr (is_small<Callable>) {
+        new (buffer_) Callable(std::forward<F>(f));
+        vtable_ = &small_vtable<Callable>;
+      }
+      else {
+        *reinterpret_cast<Callable**>(buffer_) = new Callable(std::forward<F>(f));
+        vtable_ = &large_vtable<Callable>;
+      }
+    }
+
+    void operator()() { vtable_->call(buffer_); }
     function_wrapper() = default;
-    function_wrapper(function_wrapper&& other) : impl_(std::move(other.impl_)) {}
-    function_wrapper& operator=(function_wrapper&& other)
+    ~function_wrapper() { reset(); }
+    function_wrapper(function_wrapper&& other) noexcept { take(other); }
+    function_wrapper& operator=(function_wrapper&& other) noexcept
     {
-      impl_ = std::move(other.impl_);
+      if (this != &other) {
+        reset();
+        take(other);
+      }
       return *this;
     }
     function_wrapper(const function_wrapper&) = delete;
     function_wrapper(function_wrapper&) = delete;
     function_wrapper& operator=(const function_wrapper&) = delete;
 
+    explicit operator bool() const { return vtable_ != nullptr; }
+
   private:
-    u_ptr<impl_base> impl_;
+    void reset()
+    {
+      if (vtable_) {
+        vtable_->destroy(buffer_);
+        vtable_ = nullptr;
+      }
+    }
+
+    void take(function_wrapper& other)
+    {
+      if (other.vtable_) {
+        other.vtable_->move(buffer_, other.buffer_);
+        vtable_ = std::exchange(other.vtable_, nullptr);
+      }
+    }
+
+    alignas(std::max_align_t) std::byte buffer_[BUFFER_SIZE];
+    const vtable* vtable_ = nullptr;
 };
 
 // ---------------------------------------------------------------------------
 
+// queue entry of thread_pool, recycled through block_pool
+struct task_node
+{
+  explicit task_node(function_wrapper&& f) : task(std::move(f)) {}
+
+  function_wrapper task;
+  task_node* next = nullptr;
+};
+
+// ---------------------------------------------------------------------------
+
+// workers are split into lanes, a worker only runs the tasks of its own lane.
+// so that a flood of background tasks can't delay real-time or per-frame tasks.
+enum class task_priority : uint32_t
+{
+  REALTIME,   // e.g. audio synthesis
+  FRAME,      // per-frame work (default)
+  BACKGROUND, // e.g. asset loading, meshlet separation
+};
+constexpr size_t LANE_COUNT = 3;
+
+// os hints are linux only and silently ignored without the privileges
+struct lane_config
+{
+  unsigned worker_count = 0;
+  // pin the workers to these cpus, empty for no pinning
+  std::vector<int> cpu_ids = {};
+  // nice value of the workers (negative values need CAP_SYS_NICE)
+  int nice = 0;
+  // SCHED_FIFO priority (1 ~ 99) if positive, needs CAP_SYS_NICE
+  int fifo_priority = 0;
+};
+// indexed by task_priority
+using lane_configs = std::array<lane_config, LANE_COUNT>;
+
 class thread_pool
 {
   public:
+    // all the workers belong to the FRAME lane
     thread_pool(int thread_count = 0);
+    // a lane without workers falls back to the FRAME lane (or any lane with workers)
+    explicit thread_pool(const lane_configs& configs);
     ~thread_pool();
 
     // add task to the queue by perfect forwarding arguments
+    // tasks go to the lane of the calling worker, or the FRAME lane from non-worker threads
+    template <typename Func, typename... Args, typename Result = std::invoke_result_t<Func, Args...>>
+    requires (!std::is_same_v<std::decay_t<Func>, task_priority>)
+    std::future<Result> submit(Func&& f, Args&&... args)
+    { return submit_to_lane(get_default_lane(), std::forward<Func>(f), std::forward<Args>(args)...); }
+
     template <typename Func, typename... Args, typename Result = std::invoke_result_t<Func, Args...>>
-    std::future<Result> submit(Func&& f, Args&&... args);
+    std::future<Result> submit(task_priority priority, Func&& f, Args&&... args)
+    { return submit_to_lane(get_lane(priority), std::forward<Func>(f), std::forward<Args>(args)...); }
+
+    // add task without future, the caller tracks its completion by itself
+    template <typename Func>
+    requires (!std::is_same_v<std::decay_t<Func>, task_priority>)
+    void spawn(Func&& f)
+    { push_task(function_wrapper{ std::decay_t<Func>(std::forward<Func>(f)) }, get_default_lane()); }
 
-    void run_pending_task();
+    template <typename Func>
+    void spawn(task_priority priority, Func&& f)
+    { push_task(function_wrapper{ std::decay_t<Func>(std::forward<Func>(f)) }, get_lane(priority)); }
+
+    // co_await pool.schedule() resumes the coroutine on a worker thread
+    struct schedule_awaiter
+    {
+      thread_pool& pool;
+      unsigned lane_index;
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> handle)
+      { pool.push_task(function_wrapper{ [handle]() { handle.resume(); } }, lane_index); }
+      void await_resume() const noexcept {}
+    };
+    schedule_awaiter schedule() { return { *this, get_default_lane() }; }
+    schedule_awaiter schedule(task_priority priority) { return { *this, get_lane(priority) }; }
+
+    // returns false if there is no task to run
+    // a worker runs the tasks of its lane, other threads run REALTIME and FRAME tasks
+    bool run_pending_task();
+    // blocks until every submitted task has finished (call from non-worker threads)
     void wait_for_all_tasks();
 
+    size_t get_thread_count() const { return threads_.size(); }
+    size_t get_thread_count(task_priority priority) const
+    { return lanes_[static_cast<size_t>(priority)]->worker_count; }
+
   private:
-    void worker_thread(unsigned queue_index);
+    struct lane
+    {
+      // tasks from non-worker threads and other lanes
+      mt_intrusive_queue<task_node> global_queue;
+      // workers [first_worker, first_worker + worker_count)
+      unsigned first_worker = 0;
+      unsigned worker_count = 0;
+      // bumped on every submission, parked workers wait (futex) on this value
+      alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> epoch = 0;
+      std::atomic<uint32_t> parked_count = 0;
+    };
 
-    u_ptr<function_wrapper> try_pop_from_local_queue();
-    u_ptr<function_wrapper> try_pop_from_global_queue();
-    u_ptr<function_wrapper> try_steal_task();
+    void init(const lane_configs& configs);
+    void worker_thread(unsigned queue_index, unsigned lane_index, lane_config config);
+
+    template <typename Func, typename... Args, typename Result = std::invoke_result_t<Func, Args...>>
+    std::future<Result> submit_to_lane(unsigned lane_index, Func&& f, Args&&... args);
+    void push_task(function_wrapper&& task, unsigned lane_index);
+
+    // lane which actually runs the tasks of the priority
+    unsigned get_lane(task_priority priority) const { return lane_map_[static_cast<size_t>(priority)]; }
+    unsigned get_default_lane() const { return is_worker_thread() ? lane_index_ : get_lane(task_priority::FRAME); }
+
+    task_node* try_pop_from_local_queue();
+    task_node* try_pop_from_global_queue();
+    task_node* try_steal_task();
+
+    // true if the caller is a worker thread of this pool
+    bool is_worker_thread() const { return current_pool_ == this; }
+    // non-worker threads don't run background tasks while they help
+    bool is_helped_lane(unsigned lane_index) const
+    { return lane_index == get_lane(task_priority::REALTIME) || lane_index == get_lane(task_priority::FRAME); }
+
+    // sleep until a task is submitted to the lane or the pool is destroyed
+    void park(lane& lane);
+    // wake one parked worker of the lane if any
+    void notify_task_pushed(lane& lane);
+    void notify_task_finished();
+    void wake_all_workers();
 
     std::atomic_bool done_;
 
-    // each thread takes a task only if it's local queue is empty
-    mt_deque<function_wrapper> global_queue_;
-    // local queues and threads is initialized in worker_thread()
-    std::vector<u_ptr<mt_deque<function_wrapper>>> local_queues_;
+    // submitted but not finished tasks
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> outstanding_count_ = 0;
+
+    std::array<u_ptr<lane>, LANE_COUNT> lanes_;
+    std::array<unsigned, LANE_COUNT> lane_map_;
+    // each thread takes a task from the global queue only if it's local queue is empty
+    // lock-free local queues, only the owner worker pushes and pops, others steal
+    std::vector<u_ptr<ws_deque<task_node*>>> local_queues_;
     std::vector<std::thread> threads_;
     threads_joiner joiner_;
 
-    std::mutex submit_mutex_;
-
-    static thread_local mt_deque<function_wrapper>* local_queue_;
+    static thread_local ws_deque<task_node*>* local_queue_;
     static thread_local unsigned queue_index_;
+    static thread_local unsigned lane_index_;
+    static thread_local thread_pool* current_pool_;
 };
 
 template <typename Func, typename... Args, typename Result>
-std::future<Result> thread_pool::submit(Func&& f, Args&&... args)
+std::future<Result> thread_pool::submit_to_lane(unsigned lane_index, Func&& f, Args&&... args)
 {
-  // init task with future
-  auto task = std::packaged_task<Result()>(
-    [f = std::tuple<Func>(std::forward<Func>(f)), args = std::tuple<Args...>(std::forward<Args>(args)...)]()
-    { return std::apply(std::get<0>(f), args); }
-  );
-
-  // preserve the future before moving this to the queue
-  auto task_future = task.get_future();
-  auto task_wrapper = function_wrapper{ std::move(task) };
+  // the shared state of the future comes from block_pool
+  auto promise = std::promise<Result>(std::allocator_arg, pool_allocator<Result>{});
+  auto task_future = promise.get_future();
 
-  {
-    std::lock_guard<std::mutex> lock(submit_mutex_);
-
-    if (local_queue_) {
-      local_queue_->push_front(std::move(task_wrapper));
-    }
-      // main thread doesn't have local queue
-    else {
-      global_queue_.push_tail(std::move(task_wrapper));
+  push_task(function_wrapper{
+    [promise = std::move(promise), f = std::tuple<Func>(std::forward<Func>(f)), args = std::tuple<Args...>(std::forward<Args>(args)...)]() mutable
+    {
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          std::apply(std::get<0>(f), args);
+          promise.set_value();
+        }
+        else {
+          promise.set_value(std::apply(std::get<0>(f), args));
+        }
+      }
+      catch (...) {
+        promise.set_exception(std::current_exception());
+      }
     }
-  }
+  }, lane_index);
   return task_future;
 }
 
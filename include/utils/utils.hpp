@@ -2,6 +2,8 @@
 
 // hnll
 #include <utils/common_alias.hpp>
+#include <utils/logger.hpp>
+#include <utils/mapped_file.hpp>
 
 // std
 #include <memory>
@@ -26,7 +28,8 @@ std::string create_cache_directory();
 // returns sub cache directory
 std::string create_sub_cache_directory(const std::string& _dir_name);
 
-std::vector<char> read_file_for_shader(const std::string& filepath);
+// spir-v is mapped, not copied
+mapped_file read_file_for_shader(const std::string& filepath);
 
 // 3d transformation -------------------------------------------------
 struct transform
@@ -54,45 +57,46 @@ enum class timer_type
     MICRO
 };
 
+// prints the elapsed time of a one-off task.
+// use HNLL_PROFILE_SCOPE (utils/profiler.hpp) for per-frame scopes
 struct scope_timer {
   // start timer by ctor
   explicit scope_timer(const std::string& _entry = "", timer_type type = timer_type::MILLI) {
     entry = _entry;
-    start = std::chrono::system_clock::now();
+    start = std::chrono::steady_clock::now();
     type_ = type;
   }
 
   // stop and output elapsed time by dtor
   ~scope_timer() {
-    auto end = std::chrono::system_clock::now();
-    std::cout << "\x1b[35m" << "SCOPE TIMER : " << entry << std::endl;
+    auto end = std::chrono::steady_clock::now();
 
     long elapsed;
 
     switch (type_) {
       case timer_type::SEC :
         elapsed = std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
-        std::cout << "\t elapsed time : " << elapsed << " s" << "\x1b[0m" << std::endl;
+        HNLL_LOG_INFO("scope timer : ", entry, " : ", elapsed, " s");
         break;
 
       case timer_type::MILLI :
         elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        std::cout << "\t elapsed time : " << elapsed << " ms" << "\x1b[0m" << std::endl;
+        HNLL_LOG_INFO("scope timer : ", entry, " : ", elapsed, " ms");
         break;
 
       case timer_type::MICRO :
         elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        std::cout << "\t elapsed time : " << elapsed << " micro s" << "\x1b[0m" << std::endl;
+        HNLL_LOG_INFO("scope timer : ", entry, " : ", elapsed, " us");
         break;
 
       default :
-        std::cout << "\t invalid timer type" << "\x1b[0m" << std::endl;
+        HNLL_LOG_WARN("scope timer : ", entry, " : invalid timer type");
         break;
     }
   }
 
   std::string entry;
-  std::chrono::system_clock::time_point start;
+  std::chrono::steady_clock::time_point start;
   timer_type type_;
 };
 
@@ -1,6 +1,7 @@
 // hnll
 #include <audio/convolver.hpp>
 #include <audio/utils.hpp>
+#include <utils/memory_tracker.hpp>
 
 namespace hnll::audio {
 
@@ -9,6 +10,7 @@ u_ptr<convolver> convolver::create(size_t data_size)
 
 convolver::convolver(size_t data_size)
 {
+  HNLL_MEMORY_SCOPE(AUDIO);
   data_size_ = data_size;
   buffers_[0].resize(data_size);
   buffers_[1].resize(data_size);
@@ -16,6 +18,7 @@ convolver::convolver(size_t data_size)
 
 void convolver::add_segment(std::vector<ALshort>&& data, std::vector<double>&& filter)
 {
+  HNLL_MEMORY_SCOPE(AUDIO);
   assert(data.size() == data_size_);
   assert(filter.size() == data_size_);
   // zero padding
@@ -1,9 +1,7 @@
 // hnll
 #include <audio/engine.hpp>
 #include <audio/audio_data.hpp>
-
-// std
-#include <iostream>
+#include <utils/logger.hpp>
 
 namespace hnll::audio {
 
@@ -122,7 +120,7 @@ source_id engine::get_available_source_id()
   }
   else {
     ret = -1;
-    std::cerr << "all the openAL sources are not available." << std::endl;
+    HNLL_LOG_WARN("all the openAL sources are not available.");
   }
 
   return ret;
@@ -1,11 +1,10 @@
 // hnll
 #include <game/components/key_move_comp.hpp>
+#include <utils/logger.hpp>
 
 void joystickCallback(int jid, int event)
 {
-  std::cout << jid << std::endl;
-  if (event == GLFW_CONNECTED) std::cout << "connected" << std::endl;
-  else std::cout << "disconnected" << std::endl;
+  HNLL_LOG_INFO("joystick ", jid, event == GLFW_CONNECTED ? " connected" : " disconnected");
 }
 
 namespace hnll::game {
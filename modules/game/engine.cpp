@@ -23,7 +23,7 @@ engine_core::engine_core(const std::string &application_name)
   graphics_engine_core_->get_renderer_r().set_next_renderer(gui_engine_->renderer_p());
 #endif
 
-  old_time_ = std::chrono::system_clock::now();;
+  frame_pacer_.reset();
   // glfw
   set_glfw_callbacks();
 }
@@ -42,17 +42,6 @@ void engine_core::render_gui()
 
 void engine_core::cleanup() {  }
 
-float engine_core::get_dt()
-{
-  std::chrono::system_clock::time_point new_time = std::chrono::system_clock::now();
-  while (std::chrono::duration<float, std::chrono::seconds::period>(new_time - old_time_).count() < 1.f / max_fps_) {
-    new_time = std::chrono::system_clock::now();
-  }
-  float dt = std::chrono::duration<float, std::chrono::seconds::period>(new_time - old_time_).count();
-  old_time_ = new_time;
-  return dt;
-}
-
 // glfw
 void engine_core::set_glfw_callbacks()
 {
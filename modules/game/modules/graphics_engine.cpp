@@ -95,7 +95,12 @@ void graphics_engine_core::cleanup()
 void graphics_engine_core::wait_idle() { vkDeviceWaitIdle(device_->get_device()); }
 
 // for graphics_engine::render()
-bool graphics_engine_core::begin_frame() { return renderer_->begin_frame(); }
+bool graphics_engine_core::begin_frame()
+{
+  // upload the models loaded in the background
+  model_pool_->process_requests();
+  return renderer_->begin_frame();
+}
 void graphics_engine_core::record_default_render_command()
 { renderer_->record_default_render_command(); }
 
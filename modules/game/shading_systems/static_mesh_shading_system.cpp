@@ -1,6 +1,7 @@
 // hnll
 #include <game/shading_systems/static_mesh_shading_system.hpp>
 #include <game/modules/graphics_engine.hpp>
+#include <utils/frame_arena.hpp>
 
 namespace hnll {
 
@@ -45,6 +46,9 @@ void static_mesh_shading_system::render(const utils::graphics_frame_info& frame_
   set_current_command_buffer(frame_info.command_buffer);
   bind_pipeline();
 
+  // frame-local, reused by all the targets
+  std::pmr::vector<VkDescriptorSet> desc_sets(utils::singleton<utils::frame_arena>::get_single_ptr().ptr);
+
   for (auto& target : targets_) {
     auto obj = target.second;
 
@@ -54,10 +58,10 @@ void static_mesh_shading_system::render(const utils::graphics_frame_info& frame_
     push.normal_matrix = tf.normal_matrix();
 
     // desc_set
-    std::vector<VkDescriptorSet> desc_sets = {
+    desc_sets.assign({
       frame_info.global_descriptor_set,
       obj.get_texture_desc_set()
-    };
+    });
 
     bind_desc_sets(desc_sets);
     bind_push(push, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -4,6 +4,7 @@
 #include <graphics/desc_set.hpp>
 #include <graphics/swap_chain.hpp>
 #include <graphics/device.hpp>
+#include <utils/frame_arena.hpp>
 
 namespace hnll {
 
@@ -94,6 +95,9 @@ void static_meshlet_shading_system::render(const utils::graphics_frame_info &fra
   set_current_command_buffer(frame_info.command_buffer);
   bind_pipeline();
 
+  // frame-local, reused by all the targets
+  std::pmr::vector<VkDescriptorSet> vk_desc_sets(utils::singleton<utils::frame_arena>::get_single_ptr().ptr);
+
   for (auto &target: targets_) {
     const auto& obj = target.second;
 
@@ -110,12 +114,12 @@ void static_meshlet_shading_system::render(const utils::graphics_frame_info &fra
 
     const auto& mesh_desc_sets = obj.get_model().get_desc_sets();
 
-    std::vector<VkDescriptorSet> vk_desc_sets = {
+    vk_desc_sets.assign({
       frame_info.global_descriptor_set,
       task_desc_sets_->get_vk_desc_sets(frame_info.frame_index)[0],
       mesh_desc_sets[0],
       mesh_desc_sets[1]
-    };
+    });
 
     bind_desc_sets(vk_desc_sets);
 
@@ -17,30 +17,6 @@ bounding_volume::bounding_volume(const vec3d &center_point, const double radius)
   type_(bv_type::SPHERE)
 {}
 
-u_ptr<bounding_volume> bounding_volume::create_aabb(const std::vector<vec3d>& vertices)
-{
-  // TODO : compute convex-hull
-  auto convex_hull = vertices;
-  double minx = convex_hull[0].x(),
-    maxx = convex_hull[0].x(),
-    miny = convex_hull[0].y(),
-    maxy = convex_hull[0].y(),
-    minz = convex_hull[0].z(),
-    maxz = convex_hull[0].z();
-  for (int i = 1; i < convex_hull.size(); i++) {
-    const auto& vertex = convex_hull[i];
-    if (minx > vertex.x()) minx = vertex.x();
-    if (maxx < vertex.x()) maxx = vertex.x();
-    if (miny > vertex.y()) miny = vertex.y();
-    if (maxy < vertex.y()) maxy = vertex.y();
-    if (minz > vertex.z()) minz = vertex.z();
-    if (maxz < vertex.z()) maxz = vertex.z();
-  }
-  vec3d center_point = {(maxx + minx) / 2, (maxy + miny) / 2, (maxz + minz) / 2};
-  vec3d radius = {(maxx - minx) / 2, (maxy - miny) / 2, (maxz - minz) / 2};
-  return std::make_unique<bounding_volume>(center_point, radius);
-}
-
 u_ptr<bounding_volume> bounding_volume::create_aabb(const vec3d &center, const vec3d &radius)
 { return std::make_unique<bounding_volume>(center, radius); }
 
@@ -54,7 +30,7 @@ u_ptr<bounding_volume> bounding_volume::create_empty_bv(bv_type type, const hnll
   return ret;
 }
 
-std::pair<int,int> most_separated_points_on_aabb(const std::vector<vec3d> &vertices)
+std::pair<int,int> most_separated_points_on_aabb(std::span<const vec3d> vertices)
 {
   // represents min/max point's index of each axis
   int minx = 0, maxx = 0, miny = 0, maxy = 0, minz = 0, maxz = 0, min = 0, max = 0;
@@ -83,7 +59,7 @@ std::pair<int,int> most_separated_points_on_aabb(const std::vector<vec3d> &verti
   return {min, max};
 }
 
-u_ptr<bounding_volume> sphere_from_distant_points(const std::vector<vec3d> &vertices)
+u_ptr<bounding_volume> sphere_from_distant_points(std::span<const vec3d> vertices)
 {
   auto separated_idx = most_separated_points_on_aabb(vertices);
   auto center_point = (vertices[separated_idx.first] + vertices[separated_idx.second]) * 0.5f;
@@ -106,7 +82,7 @@ void extend_sphere_to_point(bounding_volume& sphere, const vec3d& point)
 }
 
 // currently only support ritter's algorithm
-u_ptr<bounding_volume> bounding_volume::create_sphere(const std::vector<vec3d>& vertices)
+u_ptr<bounding_volume> bounding_volume::create_sphere(std::span<const vec3d> vertices)
 {
   auto sphere = sphere_from_distant_points(vertices);
   for (const auto& vertex : vertices)
@@ -0,0 +1,774 @@
+// hnll
+#include <geometry/bvh.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/he_mesh.hpp>
+#include <geometry/intersection.hpp>
+#include <utils/memory_tracker.hpp>
+#include <utils/parallel.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace hnll::geometry {
+
+static_assert(sizeof(bvh::node) == 32);
+
+// nodes larger than these are binned / built by multiple tasks
+constexpr uint32_t PARALLEL_BINNING_THRESHOLD = 16 * 1024;
+constexpr uint32_t PARALLEL_BUILD_THRESHOLD = 4 * 1024;
+// deeper nodes are split at the median, which bounds the depth of the tree
+constexpr uint32_t MAX_SAH_DEPTH = 48;
+// the median splits halve the 32 bit primitive count
+constexpr uint32_t MAX_MEDIAN_DEPTH = 32;
+// a traversal pushes at most one node per level
+constexpr uint32_t TRAVERSAL_STACK_SIZE = 96;
+static_assert(TRAVERSAL_STACK_SIZE >= MAX_SAH_DEPTH + MAX_MEDIAN_DEPTH, "the traversal stack may overflow.");
+
+// builder ---------------------------------------------------------------------------
+
+struct bounds
+{
+  vec3d min = vec3d::Constant(std::numeric_limits<double>::infinity());
+  vec3d max = vec3d::Constant(-std::numeric_limits<double>::infinity());
+
+  struct uninitialized {};
+
+  bounds() = default;
+  bounds(const vec3d& min_, const vec3d& max_) : min(min_), max(max_) {}
+  explicit bounds(uninitialized) : min(), max() {}
+
+  void extend(const vec3d& p) { min = min.cwiseMin(p); max = max.cwiseMax(p); }
+  void extend(const bounds& b) { min = min.cwiseMin(b.min); max = max.cwiseMax(b.max); }
+  vec3d get_center() const { return (min + max) * 0.5; }
+
+  // half of the surface area
+  double get_area() const
+  {
+    if (min.x() > max.x())
+      return 0.0;
+    vec3d d = max - min;
+    return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+  }
+};
+
+static bounds get_bounds(const std::array<vec3d, 3>& tri)
+{
+  bounds b;
+  for (const auto& p : tri)
+    b.extend(p);
+  return b;
+}
+
+static bounds get_bounds(const bounding_volume& volume)
+{
+  vec3d radius = volume.is_sphere() ? vec3d::Constant(volume.get_sphere_radius()) : volume.get_aabb_radius();
+  vec3d center = volume.get_world_center_point();
+  return { center - radius, center + radius };
+}
+
+// rounds outward, so that the float bounds never get smaller than the double ones
+static vec3 round_down(const vec3d& v)
+{
+  vec3 ret = v.cast<float>();
+  for (int i = 0; i < 3; i++)
+    if (static_cast<double>(ret[i]) > v[i])
+      ret[i] = std::nextafter(ret[i], -std::numeric_limits<float>::infinity());
+  return ret;
+}
+
+static vec3 round_up(const vec3d& v)
+{
+  vec3 ret = v.cast<float>();
+  for (int i = 0; i < 3; i++)
+    if (static_cast<double>(ret[i]) < v[i])
+      ret[i] = std::nextafter(ret[i], std::numeric_limits<float>::infinity());
+  return ret;
+}
+
+// left uninitialized, the nodes reset only as many bins as they use since most of them are small
+struct bin
+{
+  bin() : box(bounds::uninitialized{}), centroid_box(bounds::uninitialized{}) {}
+  void reset() { box = {}; centroid_box = {}; count = 0; }
+
+  bounds box;
+  bounds centroid_box;
+  uint32_t count;
+};
+
+using bin_set = std::array<std::array<bin, bvh::BIN_COUNT>, 3>;
+
+struct build_node
+{
+  bounds box;
+  bounds centroid_box;
+  uint32_t begin = 0;
+  uint32_t count = 0;
+  uint32_t left = NULL_ID;
+  uint32_t axis = 0;
+};
+
+struct build_primitive
+{
+  bounds box;
+  vec3d centroid;
+  uint32_t id;
+};
+
+class bvh_builder
+{
+  public:
+    bvh_builder(std::span<const bounds> prim_bounds, utils::thread_pool* pool)
+      : pool_(pool)
+    {
+      // partitioned in place rather than through indices, so that the binning reads them sequentially
+      prims_.resize(prim_bounds.size());
+      for_range(0, prims_.size(), [&](size_t i) {
+        prims_[i].box = prim_bounds[i];
+        prims_[i].centroid = prim_bounds[i].get_center();
+        prims_[i].id = static_cast<uint32_t>(i);
+      });
+    }
+
+    // returns the flattened nodes and the leaf order of the primitives
+    void build(std::vector<bvh::node>& nodes, std::vector<uint32_t>& order, uint32_t& depth)
+    {
+      const auto count = static_cast<uint32_t>(prims_.size());
+
+      // a binary tree with n leaves has 2n - 1 nodes
+      nodes_.resize(count > 0 ? 2 * size_t(count) - 1 : 1);
+      node_count_ = 1;
+      auto& root = nodes_[0];
+      root.begin = 0;
+      root.count = count;
+      compute_bounds(root);
+
+      if (pool_ && count > PARALLEL_BUILD_THRESHOLD) {
+        context_ = std::allocate_shared<utils::parallel_context>(utils::pool_allocator<utils::parallel_context>{});
+        try { build_node_recursive(0, 0); }
+        catch (...) { context_->set_exception(std::current_exception()); }
+        context_->wait(*pool_);
+      }
+      else {
+        build_node_recursive(0, 0);
+      }
+
+      // depth first order, independent of the task scheduling
+      nodes.clear();
+      nodes.reserve(node_count_);
+      depth = 0;
+      if (count > 0)
+        flatten(0, nodes, 1, depth);
+      order.resize(count);
+      for_range(0, count, [&](size_t i) { order[i] = prims_[i].id; });
+    }
+
+  private:
+    template <typename Func>
+    void for_range(size_t begin, size_t end, Func&& f)
+    {
+      if (pool_)
+        utils::parallel_for(*pool_, begin, end, f);
+      else
+        for (auto i = begin; i < end; i++) f(i);
+    }
+
+    void compute_bounds(build_node& n)
+    {
+      auto reduce = [this](size_t begin, size_t end, std::pair<bounds, bounds> ret) {
+        for (auto i = begin; i < end; i++) {
+          ret.first.extend(prims_[i].box);
+          ret.second.extend(prims_[i].centroid);
+        }
+        return ret;
+      };
+      std::pair<bounds, bounds> ret;
+      if (pool_ && n.count > PARALLEL_BINNING_THRESHOLD) {
+        ret = utils::parallel_reduce(*pool_, n.begin, n.begin + n.count, ret, reduce,
+          [](std::pair<bounds, bounds> a, const std::pair<bounds, bounds>& b) {
+            a.first.extend(b.first);
+            a.second.extend(b.second);
+            return a;
+          });
+      }
+      else {
+        ret = reduce(n.begin, n.begin + n.count, ret);
+      }
+      n.box = ret.first;
+      n.centroid_box = ret.second;
+    }
+
+    static uint32_t get_bin_index(double c, double min, double scale, uint32_t bin_count)
+    { return std::min(bin_count - 1, static_cast<uint32_t>((c - min) * scale)); }
+
+    // fewer bins for small nodes, there is no point to bin a few primitives into 16
+    static uint32_t get_bin_count(const build_node& n)
+    { return std::min(bvh::BIN_COUNT, n.count); }
+
+    static vec3d get_bin_scale(const build_node& n)
+    {
+      vec3d extent = n.centroid_box.max - n.centroid_box.min;
+      vec3d scale;
+      for (int a = 0; a < 3; a++)
+        scale[a] = extent[a] > 0.0 ? get_bin_count(n) / extent[a] : 0.0;
+      return scale;
+    }
+
+    static void reset_bins(bin_set& bins, uint32_t bin_count)
+    {
+      for (auto& axis_bins : bins)
+        for (uint32_t i = 0; i < bin_count; i++)
+          axis_bins[i].reset();
+    }
+
+    void compute_bins(const build_node& n, bin_set& bins)
+    {
+      const auto bin_count = get_bin_count(n);
+      const auto scale = get_bin_scale(n);
+      reset_bins(bins, bin_count);
+      auto fill = [&](size_t begin, size_t end, bin_set& ret) {
+        for (auto i = begin; i < end; i++) {
+          const auto& prim = prims_[i];
+          const auto& c = prim.centroid;
+          for (int a = 0; a < 3; a++) {
+            auto& b = ret[a][get_bin_index(c[a], n.centroid_box.min[a], scale[a], bin_count)];
+            b.box.extend(prim.box);
+            b.centroid_box.extend(c);
+            b.count++;
+          }
+        }
+      };
+
+      // min / max and counts don't depend on the chunking, so the tree doesn't depend on the thread count
+      if (pool_ && n.count > PARALLEL_BINNING_THRESHOLD) {
+        bins = utils::parallel_reduce(*pool_, n.begin, n.begin + n.count, bins,
+          [&](size_t begin, size_t end, bin_set ret) { fill(begin, end, ret); return ret; },
+          [](bin_set a, const bin_set& b) {
+            for (int axis = 0; axis < 3; axis++) {
+              for (uint32_t i = 0; i < bvh::BIN_COUNT; i++) {
+                a[axis][i].box.extend(b[axis][i].box);
+                a[axis][i].centroid_box.extend(b[axis][i].centroid_box);
+                a[axis][i].count += b[axis][i].count;
+              }
+            }
+            return a;
+          });
+      }
+      else {
+        fill(n.begin, n.begin + n.count, bins);
+      }
+    }
+
+    struct split
+    {
+      bool found = false;
+      uint32_t axis = 0;
+      // the last bin of the left child
+      uint32_t bin = 0;
+      double cost = std::numeric_limits<double>::infinity();
+      build_node left;
+      build_node right;
+    };
+
+    // sweeps the bins of each axis. the bins are local to this function,
+    // so that they don't stay on the stack during the recursion
+    split find_sah_split(const build_node& n)
+    {
+      split ret;
+      bin_set bins;
+      compute_bins(n, bins);
+
+      const auto bin_count = get_bin_count(n);
+      const vec3d extent = n.centroid_box.max - n.centroid_box.min;
+      const auto inv_area = n.box.get_area() > 0.0 ? 1.0 / n.box.get_area() : 0.0;
+      for (uint32_t a = 0; a < 3; a++) {
+        if (extent[a] <= 0.0)
+          continue;
+        // cost of splitting after the i th bin
+        std::array<double, bvh::BIN_COUNT> right_costs;
+        bounds right;
+        uint32_t right_count = 0;
+        for (uint32_t i = bin_count - 1; i > 0; i--) {
+          right.extend(bins[a][i].box);
+          right_count += bins[a][i].count;
+          right_costs[i - 1] = right.get_area() * right_count;
+        }
+        bounds left;
+        uint32_t left_count = 0;
+        for (uint32_t i = 0; i < bin_count - 1; i++) {
+          left.extend(bins[a][i].box);
+          left_count += bins[a][i].count;
+          if (left_count == 0 || left_count == n.count)
+            continue;
+          auto cost = bvh::TRAVERSAL_COST + (left.get_area() * left_count + right_costs[i]) * inv_area;
+          if (cost < ret.cost) {
+            ret.cost = cost;
+            ret.axis = a;
+            ret.bin = i;
+            ret.found = true;
+            ret.left.count = left_count;
+          }
+        }
+      }
+
+      // bounds of the children come from the bins
+      if (ret.found) {
+        for (uint32_t i = 0; i < bin_count; i++) {
+          auto& child = i <= ret.bin ? ret.left : ret.right;
+          child.box.extend(bins[ret.axis][i].box);
+          child.centroid_box.extend(bins[ret.axis][i].centroid_box);
+        }
+      }
+      return ret;
+    }
+
+    // children are written to nodes_[left] and nodes_[left + 1]
+    void build_node_recursive(uint32_t index, uint32_t depth)
+    {
+      auto& n = nodes_[index];
+      if (n.count <= 1)
+        return;
+
+      vec3d extent = n.centroid_box.max - n.centroid_box.min;
+      split best;
+      if (depth < MAX_SAH_DEPTH && extent.maxCoeff() > 0.0) {
+        best = find_sah_split(n);
+        // a leaf is cheaper
+        if (n.count <= bvh::MAX_LEAF_SIZE && (!best.found || best.cost >= n.count))
+          return;
+      }
+      else if (n.count <= bvh::MAX_LEAF_SIZE) {
+        return;
+      }
+
+      auto left_index = node_count_.fetch_add(2, std::memory_order_relaxed);
+      auto& left = nodes_[left_index];
+      auto& right = nodes_[left_index + 1];
+      n.left = left_index;
+
+      auto first = prims_.begin() + n.begin;
+      auto last = first + n.count;
+      if (best.found) {
+        n.axis = best.axis;
+        const auto bin_count = get_bin_count(n);
+        const auto scale = get_bin_scale(n)[best.axis];
+        const auto min = n.centroid_box.min[best.axis];
+        std::partition(first, last, [&](const build_primitive& prim) {
+          return get_bin_index(prim.centroid[best.axis], min, scale, bin_count) <= best.bin;
+        });
+        left.box = best.left.box;
+        left.centroid_box = best.left.centroid_box;
+        left.begin = n.begin;
+        left.count = best.left.count;
+        right.box = best.right.box;
+        right.centroid_box = best.right.centroid_box;
+      }
+      else {
+        // no sah split (same centroids or too deep), the median along the longest axis
+        int axis = 0;
+        extent.maxCoeff(&axis);
+        n.axis = axis;
+        auto mid = first + n.count / 2;
+        std::nth_element(first, mid, last, [&](const build_primitive& a, const build_primitive& b) {
+          return a.centroid[axis] < b.centroid[axis] || (a.centroid[axis] == b.centroid[axis] && a.id < b.id);
+        });
+        left.begin = n.begin;
+        left.count = n.count / 2;
+        right.begin = n.begin + left.count;
+        right.count = n.count - left.count;
+        compute_bounds(left);
+        compute_bounds(right);
+      }
+      right.begin = left.begin + left.count;
+      right.count = n.count - left.count;
+
+      if (context_ && n.count > PARALLEL_BUILD_THRESHOLD) {
+        context_->add_pending();
+        pool_->spawn([this, left_index, depth]() {
+          try { build_node_recursive(left_index, depth + 1); }
+          catch (...) { context_->set_exception(std::current_exception()); }
+          context_->finish_pending();
+        });
+      }
+      else {
+        build_node_recursive(left_index, depth + 1);
+      }
+      build_node_recursive(left_index + 1, depth + 1);
+    }
+
+    uint32_t flatten(uint32_t index, std::vector<bvh::node>& nodes, uint32_t depth, uint32_t& max_depth)
+    {
+      const auto& n = nodes_[index];
+      auto flat_index = static_cast<uint32_t>(nodes.size());
+      max_depth = std::max(max_depth, depth);
+
+      auto& flat = nodes.emplace_back();
+      flat.min = round_down(n.box.min);
+      flat.max = round_up(n.box.max);
+      if (n.left == NULL_ID) {
+        flat.offset = n.begin;
+        flat.count = static_cast<uint16_t>(n.count);
+        flat.axis = 0;
+      }
+      else {
+        flat.count = 0;
+        flat.axis = static_cast<uint16_t>(n.axis);
+        flatten(n.left, nodes, depth + 1, max_depth);
+        auto second = flatten(n.left + 1, nodes, depth + 1, max_depth);
+        // the vector may have been reallocated
+        nodes[flat_index].offset = second;
+      }
+      return flat_index;
+    }
+
+    std::vector<build_primitive> prims_;
+    std::vector<build_node> nodes_;
+    std::atomic<uint32_t> node_count_ = 0;
+    utils::thread_pool* pool_;
+    s_ptr<utils::parallel_context> context_;
+};
+
+// factories -------------------------------------------------------------------------
+
+u_ptr<bvh> bvh::create(std::span<const vec3d> positions, std::span<const vertex_id> indices, utils::thread_pool* pool)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  if (indices.size() % 3 != 0)
+    throw std::runtime_error("index count is not multiple of 3.");
+
+  std::vector<triangle> triangles(indices.size() / 3);
+  std::vector<uint32_t> ids(triangles.size());
+  for (size_t i = 0; i < triangles.size(); i++) {
+    for (size_t j = 0; j < 3; j++) {
+      auto index = indices[i * 3 + j];
+      if (index >= positions.size())
+        throw std::runtime_error("vertex index is out of range.");
+      triangles[i][j] = positions[index];
+    }
+    ids[i] = i;
+  }
+  return create_from_triangles(std::move(triangles), std::move(ids), pool);
+}
+
+u_ptr<bvh> bvh::create(const he_mesh& mesh, utils::thread_pool* pool)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  std::vector<triangle> triangles;
+  std::vector<uint32_t> ids;
+  triangles.reserve(mesh.get_face_count());
+  ids.reserve(mesh.get_face_count());
+  for (auto f_id : mesh.get_face_ids()) {
+    auto& tri = triangles.emplace_back();
+    std::ranges::transform(mesh.get_face_vertices(f_id), tri.begin(), &vertex::position);
+    ids.emplace_back(f_id);
+  }
+  return create_from_triangles(std::move(triangles), std::move(ids), pool);
+}
+
+u_ptr<bvh> bvh::create_from_triangles(std::vector<triangle>&& triangles, std::vector<uint32_t>&& ids, utils::thread_pool* pool)
+{
+  std::vector<bounds> prim_bounds(triangles.size());
+  for (size_t i = 0; i < triangles.size(); i++)
+    prim_bounds[i] = get_bounds(triangles[i]);
+
+  auto ret = std::make_unique<bvh>();
+  ret->type_ = primitive_type::TRIANGLE;
+  std::vector<uint32_t> order;
+  bvh_builder(prim_bounds, pool).build(ret->nodes_, order, ret->depth_);
+
+  // store the primitives in the leaf order
+  ret->triangles_.resize(order.size());
+  ret->primitive_ids_.resize(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    ret->triangles_[i] = triangles[order[i]];
+    ret->primitive_ids_[i] = ids[order[i]];
+  }
+  return ret;
+}
+
+u_ptr<bvh> bvh::create(std::span<const bounding_volume* const> volumes, utils::thread_pool* pool)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  std::vector<bounds> prim_bounds(volumes.size());
+  for (size_t i = 0; i < volumes.size(); i++)
+    prim_bounds[i] = get_bounds(*volumes[i]);
+
+  auto ret = std::make_unique<bvh>();
+  ret->type_ = primitive_type::VOLUME;
+  std::vector<uint32_t> order;
+  bvh_builder(prim_bounds, pool).build(ret->nodes_, order, ret->depth_);
+
+  ret->volumes_.resize(order.size());
+  for (size_t i = 0; i < order.size(); i++)
+    ret->volumes_[i] = volumes[order[i]];
+  ret->primitive_ids_ = std::move(order);
+  return ret;
+}
+
+void bvh::refit()
+{
+  assert(type_ == primitive_type::VOLUME && "only the volumes move.");
+  // children always come after their parent
+  for (auto i = nodes_.size(); i-- > 0;) {
+    auto& n = nodes_[i];
+    bounds b;
+    if (n.is_leaf()) {
+      for (uint32_t p = n.offset; p < n.offset + n.count; p++)
+        b.extend(get_bounds(*volumes_[p]));
+      n.min = round_down(b.min);
+      n.max = round_up(b.max);
+    }
+    else {
+      const auto& first = nodes_[i + 1];
+      const auto& second = nodes_[n.offset];
+      n.min = first.min.cwiseMin(second.min);
+      n.max = first.max.cwiseMax(second.max);
+    }
+  }
+}
+
+// queries ---------------------------------------------------------------------------
+
+// slab test, t is clipped to [t_min, t_max]
+static bool intersect_box(
+  const vec3d& min,
+  const vec3d& max,
+  const vec3d& origin,
+  const vec3d& inv_dir,
+  double& t_min,
+  double t_max)
+{
+  for (int a = 0; a < 3; a++) {
+    double near = (min[a] - origin[a]) * inv_dir[a];
+    double far  = (max[a] - origin[a]) * inv_dir[a];
+    if (near > far) std::swap(near, far);
+    // written so that NaN (0 * inf) keeps the current range
+    t_min = near > t_min ? near : t_min;
+    t_max = far < t_max ? far : t_max;
+    if (t_min > t_max)
+      return false;
+  }
+  return true;
+}
+
+// moller-trumbore, both sides
+static bool intersect_triangle(const std::array<vec3d, 3>& tri, const ray& r, double t_max, double& t, double& u, double& v)
+{
+  vec3d e1 = tri[1] - tri[0];
+  vec3d e2 = tri[2] - tri[0];
+  vec3d p = r.direction.cross(e2);
+  double det = e1.dot(p);
+  if (det == 0.0)
+    return false;
+  double inv_det = 1.0 / det;
+  vec3d s = r.origin - tri[0];
+  u = s.dot(p) * inv_det;
+  if (u < 0.0 || u > 1.0)
+    return false;
+  vec3d q = s.cross(e1);
+  v = r.direction.dot(q) * inv_det;
+  if (v < 0.0 || u + v > 1.0)
+    return false;
+  t = e2.dot(q) * inv_det;
+  return t >= 0.0 && t < t_max;
+}
+
+static bool intersect_sphere(const vec3d& center, double radius, const ray& r, double t_max, double& t)
+{
+  vec3d m = r.origin - center;
+  double a = r.direction.dot(r.direction);
+  double b = m.dot(r.direction);
+  double c = m.dot(m) - radius * radius;
+  // outside and pointing away
+  if (c > 0.0 && b > 0.0)
+    return false;
+  double discriminant = b * b - a * c;
+  if (discriminant < 0.0 || a == 0.0)
+    return false;
+  // the origin may be inside
+  t = std::max(0.0, (-b - std::sqrt(discriminant)) / a);
+  return t < t_max;
+}
+
+bool bvh::intersect_primitive(uint32_t index, const ray& r, ray_hit& hit) const
+{
+  double t, u = 0.0, v = 0.0;
+  if (type_ == primitive_type::TRIANGLE) {
+    if (!intersect_triangle(triangles_[index], r, hit.t, t, u, v))
+      return false;
+  }
+  else {
+    const auto& volume = *volumes_[index];
+    if (volume.is_sphere()) {
+      if (!intersect_sphere(volume.get_world_center_point(), volume.get_sphere_radius(), r, hit.t, t))
+        return false;
+    }
+    else {
+      auto b = get_bounds(volume);
+      t = 0.0;
+      vec3d inv_dir = r.direction.cwiseInverse();
+      if (!intersect_box(b.min, b.max, r.origin, inv_dir, t, hit.t) || t >= hit.t)
+        return false;
+    }
+  }
+  hit = { primitive_ids_[index], t, u, v };
+  return true;
+}
+
+ray_hit bvh::intersect(const ray& r, double t_max) const
+{
+  ray_hit hit;
+  hit.t = t_max;
+  if (nodes_.empty())
+    return hit;
+
+  const vec3d inv_dir = r.direction.cwiseInverse();
+  std::array<uint32_t, TRAVERSAL_STACK_SIZE> stack;
+  uint32_t stack_size = 0;
+  uint32_t current = 0;
+  while (true) {
+    const auto& n = nodes_[current];
+    double t_min = 0.0;
+    if (intersect_box(n.min.cast<double>(), n.max.cast<double>(), r.origin, inv_dir, t_min, hit.t)) {
+      if (n.is_leaf()) {
+        for (uint32_t i = n.offset; i < n.offset + n.count; i++)
+          intersect_primitive(i, r, hit);
+      }
+      else {
+        // near child first, the far one may be culled by the closer hit
+        assert(stack_size < TRAVERSAL_STACK_SIZE);
+        if (r.direction[n.axis] < 0.0) {
+          stack[stack_size++] = current + 1;
+          current = n.offset;
+        }
+        else {
+          stack[stack_size++] = n.offset;
+          current = current + 1;
+        }
+        continue;
+      }
+    }
+    if (stack_size == 0)
+      break;
+    current = stack[--stack_size];
+  }
+
+  if (!hit.is_hit())
+    hit.t = std::numeric_limits<double>::infinity();
+  return hit;
+}
+
+// ericson, real-time collision detection 5.1.5
+static vec3d closest_point_on_triangle(const vec3d& p, const std::array<vec3d, 3>& tri)
+{
+  const auto& a = tri[0];
+  const auto& b = tri[1];
+  const auto& c = tri[2];
+  vec3d ab = b - a, ac = c - a, ap = p - a;
+  double d1 = ab.dot(ap), d2 = ac.dot(ap);
+  if (d1 <= 0.0 && d2 <= 0.0) return a;
+
+  vec3d bp = p - b;
+  double d3 = ab.dot(bp), d4 = ac.dot(bp);
+  if (d3 >= 0.0 && d4 <= d3) return b;
+
+  double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) return a + d1 / (d1 - d3) * ab;
+
+  vec3d cp = p - c;
+  double d5 = ab.dot(cp), d6 = ac.dot(cp);
+  if (d6 >= 0.0 && d5 <= d6) return c;
+
+  double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) return a + d2 / (d2 - d6) * ac;
+
+  double va = d3 * d6 - d5 * d4;
+  if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+
+  double denom = 1.0 / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// separating axis test of akenine-moller
+static bool overlap_aabb_triangle(const vec3d& center, const vec3d& radius, const std::array<vec3d, 3>& tri)
+{
+  std::array<vec3d, 3> v = { tri[0] - center, tri[1] - center, tri[2] - center };
+  std::array<vec3d, 3> e = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+  auto separated = [&](const vec3d& axis) {
+    double p0 = v[0].dot(axis), p1 = v[1].dot(axis), p2 = v[2].dot(axis);
+    double r = radius.dot(axis.cwiseAbs());
+    return std::max({ p0, p1, p2 }) < -r || std::min({ p0, p1, p2 }) > r;
+  };
+
+  // box normals, edge cross products, and the triangle normal
+  for (int i = 0; i < 3; i++)
+    if (separated(vec3d::Unit(i)))
+      return false;
+  for (int i = 0; i < 3; i++)
+    for (const auto& edge : e)
+      if (separated(vec3d::Unit(i).cross(edge)))
+        return false;
+  return !separated(e[0].cross(e[1]));
+}
+
+bool bvh::overlap_primitive(uint32_t index, const bounding_volume& volume) const
+{
+  if (type_ == primitive_type::VOLUME)
+    return intersection::test_bv_intersection(volume, *volumes_[index]) > 0.0;
+
+  const auto& tri = triangles_[index];
+  auto center = volume.get_world_center_point();
+  if (volume.is_sphere()) {
+    auto radius = volume.get_sphere_radius();
+    return (closest_point_on_triangle(center, tri) - center).squaredNorm() <= radius * radius;
+  }
+  return overlap_aabb_triangle(center, volume.get_aabb_radius(), tri);
+}
+
+void bvh::query(const bounding_volume& volume, std::vector<uint32_t>& primitives) const
+{
+  if (nodes_.empty())
+    return;
+
+  const auto query_bounds = get_bounds(volume);
+  const auto center = volume.get_world_center_point();
+  const auto radius2 = volume.get_sphere_radius() * volume.get_sphere_radius();
+  auto overlap_node = [&](const node& n) {
+    vec3d min = n.min.cast<double>(), max = n.max.cast<double>();
+    if (volume.is_sphere()) {
+      vec3d closest = center.cwiseMax(min).cwiseMin(max);
+      return (closest - center).squaredNorm() <= radius2;
+    }
+    return (query_bounds.min.array() <= max.array()).all() && (min.array() <= query_bounds.max.array()).all();
+  };
+
+  std::array<uint32_t, TRAVERSAL_STACK_SIZE> stack;
+  uint32_t stack_size = 0;
+  uint32_t current = 0;
+  while (true) {
+    const auto& n = nodes_[current];
+    if (overlap_node(n)) {
+      if (n.is_leaf()) {
+        for (uint32_t i = n.offset; i < n.offset + n.count; i++)
+          if (overlap_primitive(i, volume))
+            primitives.emplace_back(primitive_ids_[i]);
+      }
+      else {
+        assert(stack_size < TRAVERSAL_STACK_SIZE);
+        stack[stack_size++] = n.offset;
+        current = current + 1;
+        continue;
+      }
+    }
+    if (stack_size == 0)
+      break;
+    current = stack[--stack_size];
+  }
+}
+
+} // namespace hnll::geometry
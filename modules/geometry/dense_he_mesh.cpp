@@ -0,0 +1,116 @@
+// hnll
+#include <geometry/dense_he_mesh.hpp>
+#include <geometry/edge_map.hpp>
+#include <graphics/utils.hpp>
+#include <utils/memory_tracker.hpp>
+
+// std
+#include <stdexcept>
+
+namespace hnll::geometry {
+
+u_ptr<dense_he_mesh> dense_he_mesh::create_from_obj_file(const std::string& filename)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  graphics::obj_loader loader;
+  loader.load_model(filename);
+  return create(loader.vertices, loader.indices);
+}
+
+u_ptr<dense_he_mesh> dense_he_mesh::create(const std::vector<graphics::vertex>& vertices, const std::vector<vertex_id>& indices)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  std::vector<vec3d> positions(vertices.size());
+  std::vector<vec3d> normals(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    positions[i] = vertices[i].position.cast<double>();
+    normals[i]   = vertices[i].normal.cast<double>();
+  }
+  return create(std::move(positions), std::move(normals), indices);
+}
+
+u_ptr<dense_he_mesh> dense_he_mesh::create(
+  std::vector<vec3d>&& positions,
+  std::vector<vec3d>&& normals,
+  const std::vector<vertex_id>& indices)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  if (indices.size() % 3 != 0)
+    throw std::runtime_error("index count is not multiple of 3.");
+  if (!normals.empty() && normals.size() != positions.size())
+    throw std::runtime_error("normal count doesn't match the vertex count.");
+
+  auto mesh = std::make_unique<dense_he_mesh>();
+  mesh->positions_ = std::move(positions);
+  mesh->normals_   = std::move(normals);
+  mesh->build_topology(indices);
+  return mesh;
+}
+
+void dense_he_mesh::build_topology(const std::vector<vertex_id>& indices)
+{
+  auto vertex_count = positions_.size();
+  auto face_count = indices.size() / 3;
+  auto he_count = indices.size();
+
+  vertex_he_.assign(vertex_count, NULL_ID);
+  face_normals_.resize(face_count);
+  he_vertex_.resize(he_count);
+  he_next_.resize(he_count);
+  he_face_.resize(he_count);
+
+  bool compute_normals = normals_.empty();
+  if (compute_normals)
+    normals_.assign(vertex_count, vec3d::Zero());
+
+  for (face_id f = 0; f < face_count; f++) {
+    auto base = f * 3;
+    for (uint32_t i = 0; i < 3; i++) {
+      auto v = indices[base + i];
+      if (v >= vertex_count)
+        throw std::runtime_error("vertex index is out of range.");
+      he_vertex_[base + i] = v;
+      he_next_[base + i]   = base + (i + 1) % 3;
+      he_face_[base + i]   = f;
+      if (vertex_he_[v] == NULL_ID)
+        vertex_he_[v] = base + i;
+    }
+
+    const auto& p0 = positions_[indices[base]];
+    const auto& p1 = positions_[indices[base + 1]];
+    const auto& p2 = positions_[indices[base + 2]];
+    auto cross = (p1 - p0).cross(p2 - p0);
+    face_normals_[f] = cross.normalized();
+    // area weighted
+    if (compute_normals)
+      for (uint32_t i = 0; i < 3; i++)
+        normals_[indices[base + i]] += cross;
+  }
+
+  if (compute_normals)
+    for (auto& n : normals_)
+      n.normalize();
+
+  pair_half_edges();
+}
+
+void dense_he_mesh::pair_half_edges()
+{
+  auto he_count = he_vertex_.size();
+  he_pair_.assign(he_count, NULL_ID);
+
+  edge_map edges(he_count);
+
+  // same order and rule as he_mesh::add_face, so that the non-manifold edges are paired the same way
+  for (half_edge_id he = 0; he < he_count; he++) {
+    auto start = he_vertex_[he];
+    auto end = he_vertex_[he_next_[he]];
+    auto registered = edges.emplace(start, end, he).first;
+    if (auto pair = edges.find(end, start); pair != NULL_ID) {
+      he_pair_[registered] = pair;
+      he_pair_[pair] = he;
+    }
+  }
+}
+
+} // namespace hnll::geometry
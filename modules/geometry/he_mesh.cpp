@@ -3,8 +3,12 @@
 #include <geometry/primitives.hpp>
 #include <graphics/utils.hpp>
 #include <graphics/frame_anim_utils.hpp>
+#include <utils/memory_tracker.hpp>
+#include <utils/parallel.hpp>
 
 // std
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 
 // lib
@@ -25,8 +29,10 @@ s_ptr<he_mesh> he_mesh::create()
 
 half_edge& he_mesh::get_half_edge_r(const vertex& v0, const vertex& v1)
 {
-  half_edge_key hash_key = { v0, v1 };
-  return half_edge_map_.at(hash_key);
+  auto id = edge_map_.find(v0.v_id, v1.v_id);
+  if (id == NULL_ID)
+    throw std::out_of_range("half edge doesn't exist.");
+  return half_edge_id_map_.at(id);
 }
 
 vertex translate_vertex_graphics_to_geometry(const graphics::vertex& pseudo, vertex_id id)
@@ -40,6 +46,7 @@ vertex translate_vertex_graphics_to_geometry(const graphics::vertex& pseudo, ver
 
 s_ptr<he_mesh> he_mesh::create_from_obj_file(const std::string& filename)
 {
+  HNLL_MEMORY_SCOPE(GEOMETRY);
   auto mesh_model = he_mesh::create();
 
   mesh_model->raw_vertices_.clear();
@@ -61,6 +68,11 @@ s_ptr<he_mesh> he_mesh::create_from_obj_file(const std::string& filename)
   if (indices.size() % 3 != 0)
     throw std::runtime_error("vertex count is not multiple of 3");
 
+  // every face adds 3 half-edges
+  mesh_model->half_edge_id_map_.reserve(indices.size());
+  mesh_model->face_map_.reserve(indices.size() / 3);
+  mesh_model->edge_map_.reserve(indices.size());
+
   // recreate all faces
   face_id f_id = 0;
   for (int i = 0; i < indices.size(); i += 3) {
@@ -73,6 +85,177 @@ s_ptr<he_mesh> he_mesh::create_from_obj_file(const std::string& filename)
   return mesh_model;
 }
 
+s_ptr<he_mesh> he_mesh::create_from_obj_file(utils::thread_pool& pool, const std::string& filename)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  graphics::obj_loader loader;
+  loader.load_model(filename);
+  return create_from_indexed_buffers(pool, std::move(loader.vertices), loader.indices);
+}
+
+// the result of associate_half_edge_pair only depends on the order among the half-edges on the same edge.
+// so the half-edges are scattered into buckets by their undirected edge, keeping the order,
+// and each bucket replays the rule independently.
+static void pair_half_edges(utils::thread_pool& pool, std::vector<half_edge>& hes)
+{
+  const auto he_count = hes.size();
+  const auto bucket_count = std::clamp<size_t>(he_count / 4096, 1, pool.get_thread_count() * 8);
+  auto get_bucket = [&hes, bucket_count](half_edge_id he) {
+    auto start = hes[he].v_id;
+    auto end = hes[hes[he].next].v_id;
+    auto key = edge_map::make_key(std::min(start, end), std::max(start, end));
+    // maps the upper 32 bits of the hash to [0, bucket_count).
+    // not the multiplier of edge_map, or the keys in a bucket would be crowded into a few slots of its table
+    return static_cast<uint32_t>((((key * 0xC2B2AE3D27D4EB4Full) >> 32) * bucket_count) >> 32);
+  };
+
+  // count the half-edges of each bucket per chunk
+  const auto chunk_size = utils::default_grain_size(pool, he_count);
+  const auto chunk_count = (he_count + chunk_size - 1) / chunk_size;
+  std::vector<uint32_t> buckets(he_count);
+  std::vector<size_t> offsets(chunk_count * bucket_count, 0);
+  utils::parallel_for(pool, 0, chunk_count, [&](size_t chunk) {
+    auto* chunk_offsets = &offsets[chunk * bucket_count];
+    for (auto he = chunk * chunk_size; he < std::min(he_count, (chunk + 1) * chunk_size); he++) {
+      buckets[he] = get_bucket(he);
+      chunk_offsets[buckets[he]]++;
+    }
+  }, 1);
+
+  // bucket major, so that each bucket holds its half-edges in the ascending order
+  std::vector<size_t> bucket_begins(bucket_count + 1);
+  size_t offset = 0;
+  for (size_t bucket = 0; bucket < bucket_count; bucket++) {
+    bucket_begins[bucket] = offset;
+    for (size_t chunk = 0; chunk < chunk_count; chunk++)
+      offset += std::exchange(offsets[chunk * bucket_count + bucket], offset);
+  }
+  bucket_begins[bucket_count] = offset;
+
+  std::vector<half_edge_id> sorted(he_count);
+  utils::parallel_for(pool, 0, chunk_count, [&](size_t chunk) {
+    auto* chunk_offsets = &offsets[chunk * bucket_count];
+    for (auto he = chunk * chunk_size; he < std::min(he_count, (chunk + 1) * chunk_size); he++)
+      sorted[chunk_offsets[buckets[he]]++] = he;
+  }, 1);
+
+  // both of the half-edges which get paired belong to the bucket
+  utils::parallel_for(pool, 0, bucket_count, [&](size_t bucket) {
+    edge_map edges(bucket_begins[bucket + 1] - bucket_begins[bucket]);
+    for (auto i = bucket_begins[bucket]; i < bucket_begins[bucket + 1]; i++) {
+      auto he = sorted[i];
+      auto start = hes[he].v_id;
+      auto end = hes[hes[he].next].v_id;
+      auto registered = edges.emplace(start, end, he).first;
+      if (auto pair = edges.find(end, start); pair != NULL_ID) {
+        hes[registered].pair = pair;
+        hes[pair].pair = he;
+      }
+    }
+  }, 1);
+}
+
+s_ptr<he_mesh> he_mesh::create_from_indexed_buffers(
+  utils::thread_pool& pool,
+  std::vector<graphics::vertex>&& vertices,
+  const std::vector<vertex_id>& indices)
+{
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  if (indices.size() % 3 != 0)
+    throw std::runtime_error("index count is not multiple of 3.");
+
+  const auto vertex_count = vertices.size();
+  const auto face_count = indices.size() / 3;
+  const auto he_count = indices.size();
+
+  auto max_index = utils::parallel_reduce(pool, 0, he_count, vertex_id(0),
+    [&indices](size_t begin, size_t end, vertex_id max) {
+      for (auto i = begin; i < end; i++)
+        max = std::max(max, indices[i]);
+      return max;
+    },
+    [](vertex_id a, vertex_id b) { return std::max(a, b); });
+  if (he_count > 0 && max_index >= vertex_count)
+    throw std::runtime_error("vertex index is out of range.");
+
+  // eigen leaves the default-constructed members uninitialized, so the fill values are zeroed
+  vertex vertex_fill { vec3d::Zero(), 0 };
+  vertex_fill.uv = vec2d::Zero();
+  std::vector<vertex> geo_vertices(vertex_count, vertex_fill);
+  utils::parallel_for(pool, 0, vertex_count, [&](size_t i) {
+    geo_vertices[i] = translate_vertex_graphics_to_geometry(vertices[i], i);
+  });
+
+  // ids are assigned in the index order as add_face does
+  vertex placeholder { vec3d::Zero(), NULL_ID };
+  placeholder.uv = vec2d::Zero();
+  face face_fill { 0 };
+  face_fill.normal = vec3d::Zero();
+  face_fill.color  = vec3d::Zero();
+  std::vector<face> faces(face_count, face_fill);
+  std::vector<half_edge> hes(he_count, half_edge{ placeholder, NULL_ID });
+  utils::parallel_for(pool, 0, face_count, [&](size_t f) {
+    auto he0 = static_cast<half_edge_id>(f * 3);
+    const auto& p0 = geo_vertices[indices[he0]].position;
+    const auto& p1 = geo_vertices[indices[he0 + 1]].position;
+    const auto& p2 = geo_vertices[indices[he0 + 2]].position;
+    faces[f].f_id = static_cast<face_id>(f);
+    faces[f].he_id = he0;
+    faces[f].color = vec3d::Zero();
+    faces[f].normal = ((p1 - p0).cross(p2 - p0)).normalized();
+
+    for (half_edge_id i = 0; i < 3; i++) {
+      auto& he = hes[he0 + i];
+      he.this_id = he0 + i;
+      he.next = he0 + (i + 1) % 3;
+      he.prev = he0 + (i + 2) % 3;
+      he.v_id = indices[he0 + i];
+      he.f_id = f;
+
+      // a vertex keeps its first half-edge and counts a face per corner
+      auto& v = geo_vertices[he.v_id];
+      std::atomic_ref<unsigned>(v.face_count).fetch_add(1, std::memory_order_relaxed);
+      std::atomic_ref<half_edge_id> v_he(v.he_id);
+      auto current = v_he.load(std::memory_order_relaxed);
+      while (he.this_id < current && !v_he.compare_exchange_weak(current, he.this_id, std::memory_order_relaxed));
+    }
+  });
+
+  pair_half_edges(pool, hes);
+
+  // each map is filled by a single task
+  auto mesh = he_mesh::create();
+  utils::parallel_for(pool, 0, 4, [&](size_t i) {
+    HNLL_MEMORY_SCOPE(GEOMETRY);
+    switch (i) {
+      case 0 :
+        mesh->vertex_map_.reserve(vertex_count);
+        for (auto& v : geo_vertices)
+          mesh->vertex_map_.emplace(v.v_id, std::move(v));
+        break;
+      case 1 :
+        mesh->face_map_.reserve(face_count);
+        for (auto& fc : faces)
+          mesh->face_map_.emplace(fc.f_id, std::move(fc));
+        break;
+      case 2 :
+        mesh->half_edge_id_map_.reserve(he_count);
+        for (const auto& he : hes)
+          mesh->half_edge_id_map_.emplace(he.this_id, he);
+        break;
+      // for the later add_face and the lookups by vertices
+      default :
+        mesh->edge_map_.reserve(he_count);
+        for (const auto& he : hes)
+          mesh->edge_map_.emplace(he.v_id, hes[he.next].v_id, he.this_id);
+        break;
+    }
+  }, 1);
+
+  mesh->raw_vertices_ = std::move(vertices);
+  return mesh;
+}
+
 vertex translate_vertex(const graphics::frame_anim_utils::dynamic_attributes& pseudo, uint32_t id)
 {
   vertex v { pseudo.position.cast<double>(), id};
@@ -98,12 +281,16 @@ std::vector<s_ptr<he_mesh>> he_mesh::create_from_dynamic_attributes(
       model->add_vertex(new_vertex);
     }
 
+    model->half_edge_id_map_.reserve(indices.size());
+    model->face_map_.reserve(indices.size() / 3);
+    model->edge_map_.reserve(indices.size());
+
     // recreate all faces
     face_id f_id = 0;
     for (int i = 0; i < indices.size(); i += 3) {
-      auto v0 = model->get_vertex_r(indices[i]);
-      auto v1 = model->get_vertex_r(indices[i + 1]);
-      auto v2 = model->get_vertex_r(indices[i + 2]);
+      auto& v0 = model->get_vertex_r(indices[i]);
+      auto& v1 = model->get_vertex_r(indices[i + 1]);
+      auto& v2 = model->get_vertex_r(indices[i + 2]);
       model->add_face(v0, v1, v2, f_id++);
     }
     models.emplace_back(std::move(model));
@@ -129,21 +316,18 @@ void he_mesh::colorize_whole_mesh(const vec3d& color)
 // assumes that he.next has already assigned
 bool he_mesh::associate_half_edge_pair(half_edge &he)
 {
-  auto& start_v = vertex_map_.at(he.v_id);
+  auto start_v_id = he.v_id;
   auto end_v_id = half_edge_id_map_.at(he.next).v_id;
-  auto& end_v = vertex_map_.at(end_v_id);
 
-  half_edge_key hash_key = { start_v, end_v };
-  half_edge_key pair_hash_key = { end_v, start_v };
+  // register this half edge (the first one is kept if the edge is duplicated)
+  auto registered = edge_map_.emplace(start_v_id, end_v_id, he.this_id).first;
 
-  // register this half edge
-  half_edge_map_.emplace(hash_key, he);
-
-  // check if those hash_key already have a value
-  if (half_edge_map_.find(pair_hash_key) != half_edge_map_.end()) {
+  // check if the opposite edge already has been registered
+  auto pair = edge_map_.find(end_v_id, start_v_id);
+  if (pair != NULL_ID) {
     // if the pair has added to the map, associate with it
-    half_edge_map_.at(hash_key).pair      = half_edge_map_.at(pair_hash_key).this_id;
-    half_edge_map_.at(pair_hash_key).pair = he.this_id;
+    half_edge_id_map_.at(registered).pair = pair;
+    half_edge_id_map_.at(pair).pair = he.this_id;
 
     return true;
   }
@@ -208,9 +392,6 @@ face_id he_mesh::add_face(vertex& v0, vertex& v1, vertex& v2, face_id id)
 }
 
 bool he_mesh::exist_half_edge(const vertex& v0, const vertex& v1)
-{
-  half_edge_key hash_key = { v0, v1 };
-  return half_edge_map_.find(hash_key) != half_edge_map_.end();
-}
+{ return edge_map_.find(v0.v_id, v1.v_id) != NULL_ID; }
 
 } // namespace hnll::geometry
\ No newline at end of file
@@ -7,10 +7,18 @@
 #include <graphics/graphics_models/static_meshlet.hpp>
 #include <graphics/utils.hpp>
 #include <utils/utils.hpp>
+#include <utils/memory_tracker.hpp>
+#include <utils/perf_counters.hpp>
+#include <utils/asset_cache.hpp>
+#include <utils/hash.hpp>
+#include <utils/logger.hpp>
 
 // std
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <filesystem>
 #include <chrono>
@@ -35,36 +43,17 @@ vec3 meshlet_colors[COLOR_COUNT] = {
   vec3(1,    0.5,  0.5)
 };
 
-template <typename Key, typename Val>
-std::set<Key> extract_keys(const std::unordered_map<Key, Val>& original)
-{
-  std::set<Key> ret;
-  for (const auto& kv : original) {
-    ret.emplace(kv.first);
-  }
-  return ret;
-}
-
 void update_adjoining_face_map(
   face_id_set& adjoining_f_ids,
   const face_id_set& remaining_f_ids,
   const face& fc,
   const he_mesh& original)
 {
-  auto first_he_id = fc.he_id;
-  auto curr_he_id = first_he_id;
-  do {
-    const auto& curr_he = original.get_half_edge(curr_he_id);
-    if (curr_he.pair != NULL_ID) {
-      const auto& pair = original.get_half_edge(curr_he.pair);
-      const auto& new_f = original.get_face(pair.f_id);
-      // if new_f is new
-      if (remaining_f_ids.find(new_f.f_id) != remaining_f_ids.end()) {
-        adjoining_f_ids.emplace(new_f.f_id);
-      }
-    }
-    curr_he_id = curr_he.next;
-  } while (curr_he_id != first_he_id);
+  for (const auto& new_f : original.get_adjacent_faces(fc.f_id)) {
+    // if new_f is new
+    if (remaining_f_ids.contains(new_f.f_id))
+      adjoining_f_ids.emplace(new_f.f_id);
+  }
   adjoining_f_ids.erase(fc.f_id);
 }
 
@@ -97,16 +86,10 @@ face_id choose_random_f_id(const face_id_set& f_ids, const he_mesh& original)
 }
 
 // bv_type dependent part -------------------------------------------------------------
-u_ptr<bounding_volume> create_bv_from_single_face(bv_type type, const face& f, const he_mesh& original)
+u_ptr<bounding_volume> create_bv_from_single_face(bv_type type, face_id f_id, const he_mesh& original)
 {
-  std::vector<vec3d> vertices;
-  auto first_id = f.he_id;
-  auto curr_id = first_id;
-  do {
-    const auto& curr = original.get_half_edge(curr_id);
-    vertices.push_back(original.get_vertex(curr.v_id).position);
-    curr_id = curr.next;
-  } while (curr_id != first_id);
+  std::array<vec3d, 3> vertices;
+  std::ranges::transform(original.get_face_vertices(f_id), vertices.begin(), &vertex::position);
 
   switch (type) {
     case bv_type::SPHERE : {
@@ -151,15 +134,9 @@ double dist2(const vec3d& a, const vec3d& b)
 
 double compute_sphere_loss(const bounding_volume& curr_s, face_id f_id, const he_mesh& original)
 {
-  const auto& f = original.get_face(f_id);
-  const auto& he = original.get_half_edge(f.he_id);
-  const auto& next = original.get_half_edge(he.next);
-  const auto& prev = original.get_half_edge(he.prev);
-
   auto radius2 = std::pow(curr_s.get_sphere_radius(), 2);
-  radius2 = std::max(radius2, dist2(curr_s.get_local_center_point(), original.get_vertex(he.v_id).position));
-  radius2 = std::max(radius2, dist2(curr_s.get_local_center_point(), original.get_vertex(next.v_id).position));
-  radius2 = std::max(radius2, dist2(curr_s.get_local_center_point(), original.get_vertex(prev.v_id).position));
+  for (const auto& v : original.get_face_vertices(f_id))
+    radius2 = std::max(radius2, dist2(curr_s.get_local_center_point(), v.position));
   return radius2;
 }
 
@@ -193,20 +170,16 @@ face_id choose_best_face_id(const face_id_set& adjoining_face_ids, const boundin
 }
 
 template <bv_type type>
-void add_face_to_bv_mesh(const face& f, bv_mesh<type>& bm, const he_mesh& original)
+void add_face_to_bv_mesh(face_id f_id, bv_mesh<type>& bm, const he_mesh& original)
 {
-  bm.add_f_id(f.f_id);
-  const auto& he = original.get_half_edge(f.he_id);
-  bm.add_v_id(he.v_id);
-  const auto& next = original.get_half_edge(he.next);
-  bm.add_v_id(next.v_id);
-  const auto& prev = original.get_half_edge(he.prev);
-  bm.add_v_id(prev.v_id);
+  bm.add_f_id(f_id);
+  for (const auto& v : original.get_face_vertices(f_id))
+    bm.add_v_id(v.v_id);
 }
 
 void update_aabb(bounding_volume& curr, const face& f, const he_mesh& original)
 {
-  auto face_aabb = create_bv_from_single_face(bv_type::AABB, f, original);
+  auto face_aabb = create_bv_from_single_face(bv_type::AABB, f.f_id, original);
   vec3d max_vec3, min_vec3;
   max_vec3.x() = std::max(curr.get_max_x(), face_aabb->get_max_x());
   min_vec3.x() = std::min(curr.get_min_x(), face_aabb->get_min_x());
@@ -223,25 +196,20 @@ void update_aabb(bounding_volume& curr, const face& f, const he_mesh& original)
 void update_sphere(bounding_volume& curr, const face& f, const he_mesh& original)
 {
   // calc farthest point
-  half_edge_id far_he_id = NULL_ID;
-  auto he_id = f.he_id;
+  const vertex* far_v = nullptr;
   auto far_dist2 = std::pow(curr.get_sphere_radius(), 2);
 
-  for (int i = 0; i < 3; i++) {
-    const auto& he = original.get_half_edge(he_id);
-    auto d2 = dist2(curr.get_local_center_point(), original.get_vertex(he.v_id).position);
+  for (const auto& v : original.get_face_vertices(f.f_id)) {
+    auto d2 = dist2(curr.get_local_center_point(), v.position);
     if (d2 > far_dist2) {
       far_dist2 = d2;
-      far_he_id = he.this_id;
+      far_v = &v;
     }
-    he_id = he.next;
   }
 
-  if (far_he_id == NULL_ID) return;
+  if (far_v == nullptr) return;
 
-  vec3d new_position;
-  const auto& far_he = original.get_half_edge(far_he_id);
-  new_position = original.get_vertex(far_he.v_id).position;
+  vec3d new_position = far_v->position;
 
   // compute new center and radius
   auto center = curr.get_local_center_point();
@@ -278,7 +246,8 @@ template<bv_type type>
 std::vector<u_ptr<bv_mesh<type>>> separate_greedy(const he_mesh& original)
 {
   std::vector<u_ptr<bv_mesh<type>>> meshlets;
-  auto remaining_f_ids = extract_keys(original.get_face_map());
+  const auto face_ids = original.get_face_ids();
+  face_id_set remaining_f_ids(face_ids.begin(), face_ids.end());
 
   // all he_mesh has a face which id is 0
   face_id curr_f_id = 0;
@@ -340,13 +309,8 @@ graphics::meshletBS translate_to_meshletBS(const bv_mesh<bv_type::SPHERE>& bm, c
   current_id = 0;
   // fill primitive index info
   for (auto f_id : bm.get_f_ids()) {
-    const auto& f = original.get_face(f_id);
-    auto he_id = f.he_id;
-    for (int i = 0; i < 3; i++) {
-      const auto& he = original.get_half_edge(he_id);
-      ret.primitive_indices[current_id++] = id_map[he.v_id];
-      he_id = he.next;
-    }
+    for (const auto& v : original.get_face_vertices(f_id))
+      ret.primitive_indices[current_id++] = id_map[v.v_id];
   }
   ret.index_count = current_id;
 
@@ -359,20 +323,18 @@ graphics::meshletBS translate_to_meshletBS(const bv_mesh<bv_type::SPHERE>& bm, c
   return ret;
 }
 
-std::vector<graphics::meshletBS> mesh_separation::separate_meshletBS(const he_mesh& original, const std::string& name)
+std::vector<graphics::meshletBS> mesh_separation::separate_meshletBS(const he_mesh& original)
 {
+  HNLL_MEMORY_SCOPE(GEOMETRY);
+  HNLL_PERF_SCOPE("separate meshlets");
   std::vector<graphics::meshletBS> meshlets;
 
-  auto vertex_count = original.get_vertex_map().size();
-
   auto geometry_meshlets = separate_greedy<bv_type::SPHERE>(original);
 
   for (const auto& meshlet : geometry_meshlets) {
     meshlets.emplace_back(translate_to_meshletBS(*meshlet, original));
   }
 
-  write_meshlet_cache(meshlets, vertex_count, name);
-
   return meshlets;
 }
 
@@ -700,19 +662,34 @@ std::vector<graphics::meshletBS> mesh_separation::separate_meshletBS(const he_me
 //  return geometry_meshlets;
 //}
 
+// bump when the separation or the format changes
+static constexpr uint64_t MESHLET_CACHE_VERSION = 2;
+
+static utils::asset_cache& get_meshlet_cache()
+{
+  static utils::asset_cache cache(utils::create_sub_cache_directory("meshlets"));
+  return cache;
+}
+
+// everything the result depends on other than the obj itself
+static uint64_t get_meshlet_cache_params()
+{
+  auto params = utils::hash_string("greedy/MINIMIZE_BOUNDING_SPHERE");
+  params = utils::hash_combine(params, MESHLET_CACHE_VERSION);
+  params = utils::hash_combine(params, graphics::meshlet_constants::MAX_VERTEX_COUNT);
+  params = utils::hash_combine(params, graphics::meshlet_constants::MAX_PRIMITIVE_INDICES_COUNT);
+  return params;
+}
+
 void mesh_separation::write_meshlet_cache(
   const std::vector<graphics::meshletBS> &_meshlets,
   const size_t vertex_count,
-  const std::string& _filename)
+  const std::string& _source_path)
 {
-  auto directory = utils::create_sub_cache_directory("meshlets");
-
-  std::ofstream writing_file;
-  std::string filepath = directory + "/" + _filename + ".ml";
-  writing_file.open(filepath, std::ios::out);
+  std::ostringstream writing_file;
 
   // write contents
-  writing_file << filepath << std::endl;
+  writing_file << _source_path << std::endl;
   writing_file << "greedy" << std::endl;
   writing_file << "MINIMIZE_BOUNDING_SPHERE" << std::endl;
 
@@ -727,7 +704,7 @@ void mesh_separation::write_meshlet_cache(
   auto meshlet_count = _meshlets.size();
   writing_file << meshlet_count << std::endl;
   for (int i = 0; i < meshlet_count; i++) {
-    auto current_ml = _meshlets[i];
+    const auto& current_ml = _meshlets[i];
     // vertex info
     writing_file << current_ml.vertex_count << std::endl;
     for (const auto& v_id : current_ml.vertex_indices) {
@@ -746,28 +723,26 @@ void mesh_separation::write_meshlet_cache(
                  current_ml.sphere.z() << std::endl;
     writing_file << current_ml.sphere.w() << std::endl;
   }
-  writing_file.close();
+
+  // the cache is optional, the meshlets are separated again next time if it fails
+  if (!get_meshlet_cache().store(_source_path, get_meshlet_cache_params(), writing_file.view()))
+    HNLL_LOG_WARN("failed to write meshlet cache of ", _source_path);
 }
 
-std::vector<graphics::meshletBS> mesh_separation::load_meshlet_cache(const std::string &_filename)
+std::vector<graphics::meshletBS> mesh_separation::load_meshlet_cache(const std::string& _source_path)
 {
+  HNLL_MEMORY_SCOPE(GEOMETRY);
   std::vector<graphics::meshletBS> ret{};
 
-  std::string cache_dir = std::string(getenv("HNLL_ENGN")) + "/cache/meshlets/";
-  std::string file_path = cache_dir + _filename + ".ml";
-
-  // cache does not exist
-  if (!std::filesystem::exists(file_path)) {
+  // missing, or generated from a different obj or with different parameters
+  auto entry = get_meshlet_cache().lookup(_source_path, get_meshlet_cache_params());
+  if (!entry) {
     return ret;
   }
 
-  std::ifstream reading_file(file_path);
+  utils::memory_istream reading_file(entry->data(), entry->size());
   std::string buffer;
 
-  if (reading_file.fail()) {
-    throw std::runtime_error("failed to open file" + file_path);
-  }
-
   // ignore first 4 lines
   for (int i = 0; i < 4; i++) {
     getline(reading_file, buffer);
@@ -2,6 +2,7 @@
 #include <graphics/device.hpp>
 #include <utils/vulkan_config.hpp>
 #include <utils/singleton.hpp>
+#include <utils/logger.hpp>
 #include <extensions/extensions_vk.hpp>
 
 // ray tracing
@@ -9,7 +10,6 @@
 
 // std headers
 #include <cstring>
-#include <iostream>
 #include <set>
 #include <unordered_set>
 
@@ -22,7 +22,11 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
   const VkDebugUtilsMessengerCallbackDataEXT *p_callback_data,
   void *p_user_data)
 {
-  std::cerr << "validation layer: " << p_callback_data->pMessage << std::endl;
+  // may be called from the driver threads
+  if (message_severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+    HNLL_LOG_ERROR("validation layer: ", p_callback_data->pMessage);
+  else
+    HNLL_LOG_WARN("validation layer: ", p_callback_data->pMessage);
 
   return VK_FALSE;
 }
@@ -134,10 +138,10 @@ void device::setup_device_extensions()
     device_extensions_.emplace_back("VK_KHR_portability_subset");
 #endif
 
-  std::cout << "enabled device extensions:" << std::endl;
+  HNLL_LOG_INFO("enabled device extensions:");
   auto& required_extensions = device_extensions_;
   for (const auto &required : required_extensions) {
-    std::cout << "\t" << required << std::endl;
+    HNLL_LOG_INFO("\t", required);
     if (available.find(required) == available.end()) {
       throw std::runtime_error("Missing required device extension");
     }
@@ -202,7 +206,7 @@ void device::pick_physical_device()
     throw std::runtime_error("failed to find GPUs with Vulkan support!");
   }
   // allocate an array to hold all of VkPhysicalDevice handle
-  std::cout << "Device count: " << device_count << std::endl;
+  HNLL_LOG_INFO("Device count: ", device_count);
   std::vector<VkPhysicalDevice> devices(device_count);
   vkEnumeratePhysicalDevices(instance_, &device_count, devices.data());
   // physical_device_ is constructed as VK_NULL_HANDLE
@@ -218,7 +222,7 @@ void device::pick_physical_device()
   }
 
   vkGetPhysicalDeviceProperties(physical_device_, &properties);
-  std::cout << "physical device: " << properties.deviceName << std::endl;
+  HNLL_LOG_INFO("physical device: ", properties.deviceName);
   swap_chain_support_details details;
   // surface capabilities
   vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device_, surface_, &details.capabilities_);
@@ -380,10 +384,10 @@ void device::create_logical_device()
   vkGetDeviceQueue(device_, indices.transfer_family_.value(), 0, &transfer_queue_);
 
   if (indices.graphics_family_.value() == indices.compute_family_.value()) {
-    std::cout << "same queue family for compute and graphics." << std::endl;
+    HNLL_LOG_INFO("same queue family for compute and graphics.");
   }
   else {
-    std::cout << "dedicated compute queue family detected." << std::endl;
+    HNLL_LOG_INFO("dedicated compute queue family detected.");
   }
 
   if (rendering_type_ == utils::rendering_type::MESH_SHADING || rendering_type_ == utils::rendering_type::RAY_TRACING) {
@@ -525,10 +529,10 @@ void device::has_glfw_required_instance_extensions()
     available.insert(extension.extensionName);
   }
 
-  std::cout << "enabled instance extensions:" << std::endl;
+  HNLL_LOG_INFO("enabled instance extensions:");
   auto required_extensions = get_required_extensions();
   for (const auto &required : required_extensions) {
-    std::cout << "\t" << required << std::endl;
+    HNLL_LOG_INFO("\t", required);
     if (available.find(required) == available.end()) {
       throw std::runtime_error("missing required glfw extension");
     }
@@ -953,7 +957,7 @@ void device::create_image_with_info(
   }
 }
 
-VkShaderModule device::create_shader_module(const std::vector<char> &code)
+VkShaderModule device::create_shader_module(std::span<const char> code)
 {
   VkShaderModuleCreateInfo create_info{};
   create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
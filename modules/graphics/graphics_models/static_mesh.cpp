@@ -5,6 +5,7 @@
 #include <graphics/utils.hpp>
 #include <graphics/texture_image.hpp>
 #include <utils/utils.hpp>
+#include <utils/memory_tracker.hpp>
 
 // std
 #include <iostream>
@@ -28,25 +29,34 @@ u_ptr<static_mesh> static_mesh::create_from_file(
   device &device,
   const std::string &filename,
   bool for_ray_tracing)
+{ return create_from_cpu_data(device, load_cpu_data(filename), for_ray_tracing); }
+
+static_mesh::cpu_data static_mesh::load_cpu_data(const std::string& filename)
 {
+  HNLL_MEMORY_SCOPE(GRAPHICS);
   // load geometry
   obj_loader builder;
   builder.load_model(filename);
-  std::cout << filename << " vertex count: " << builder.vertices.size() << "\n";
+  HNLL_LOG_INFO(filename, " vertex count: ", builder.vertices.size());
+
+  // find texture
+  auto texture_path = filename.substr(0, filename.size() - 4) + ".png";
+  if (!std::filesystem::exists(texture_path))
+    texture_path = std::string(std::getenv("HNLL_ENGN")) + "/models/primitives/null_texture.png";
+
+  return { std::move(builder.vertices), std::move(builder.indices), image_resource::load_pixels(texture_path) };
+}
 
+u_ptr<static_mesh> static_mesh::create_from_cpu_data(device& device, cpu_data&& data, bool for_ray_tracing)
+{
+  HNLL_MEMORY_SCOPE(GRAPHICS);
+  obj_loader builder;
+  builder.vertices = std::move(data.vertices);
+  builder.indices  = std::move(data.indices);
   auto ret = std::make_unique<static_mesh>(device, builder, for_ray_tracing);
 
-  // load texture
-  auto texture_path = filename.substr(0, filename.size() - 4) + ".png";
-  if (std::filesystem::exists(texture_path)) {
-    auto texture = texture_image::create(device, texture_path);
-    ret->set_texture(std::move(texture));
-  }
-  else {
-    auto null_texture_path = std::string(std::getenv("HNLL_ENGN")) + "/models/primitives/null_texture.png";
-    auto texture = texture_image::create(device, null_texture_path);
-    ret->set_texture(std::move(texture));
-  }
+  // upload texture
+  ret->set_texture(texture_image::create_from_pixels(device, data.texture));
 
   return ret;
 }
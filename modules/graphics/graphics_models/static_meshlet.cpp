@@ -6,6 +6,7 @@
 #include <geometry/mesh_separation.hpp>
 #include <geometry/he_mesh.hpp>
 #include <utils/utils.hpp>
+#include <utils/memory_tracker.hpp>
 
 // std
 #include <iostream>
@@ -22,21 +23,33 @@ static_meshlet::static_meshlet(device& device, std::vector<vertex> &&raw_vertice
 }
 
 u_ptr<static_meshlet> static_meshlet::create_from_file(hnll::graphics::device &device, std::string filename)
-{
-  std::vector<meshletBS> meshlets;
+{ return create_from_cpu_data(device, load_cpu_data(filename)); }
 
+static_meshlet::cpu_data static_meshlet::load_cpu_data(const std::string& filename)
+{
+  HNLL_MEMORY_SCOPE(GRAPHICS);
   auto filepath = utils::get_full_path(filename);
 
-  // prepare required data
+  // if model's cache exists, only the raw vertices are loaded
+  auto meshlets = geometry::mesh_separation::load_meshlet_cache(filepath);
+  if (meshlets.size() != 0) {
+    obj_loader loader;
+    loader.load_model(filepath);
+    return { std::move(loader.vertices), std::move(meshlets) };
+  }
+
+  // the half-edge mesh is built only for the separation
   auto mesh = geometry::he_mesh::create_from_obj_file(filepath);
+  meshlets = geometry::mesh_separation::separate_meshletBS(*mesh);
+  geometry::mesh_separation::write_meshlet_cache(meshlets, mesh->get_vertex_count(), filepath);
 
-  // if model's cache exists
-  meshlets = geometry::mesh_separation::load_meshlet_cache(filename);
-  if (meshlets.size() == 0) {
-    meshlets = geometry::mesh_separation::separate_meshletBS(*mesh, filename);
-  }
+  return { mesh->move_raw_vertices(), std::move(meshlets) };
+}
 
-  return std::make_unique<static_meshlet>(device, mesh->move_raw_vertices(), std::move(meshlets));
+u_ptr<static_meshlet> static_meshlet::create_from_cpu_data(device& device, cpu_data&& data)
+{
+  HNLL_MEMORY_SCOPE(GRAPHICS);
+  return std::make_unique<static_meshlet>(device, std::move(data.raw_vertices), std::move(data.meshlets));
 }
 
 void static_meshlet::draw(VkCommandBuffer _command_buffer) const
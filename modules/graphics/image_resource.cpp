@@ -2,6 +2,7 @@
 #include <graphics/image_resource.hpp>
 #include <graphics/device.hpp>
 #include <graphics/buffer.hpp>
+#include <utils/mapped_file.hpp>
 
 // lib
 #define STB_IMAGE_IMPLEMENTATION
@@ -11,12 +12,32 @@
 namespace hnll::graphics {
 
 u_ptr<image_resource> image_resource::create_from_file(device& device, const std::string& filepath)
+{ return create_from_pixels(device, load_pixels(filepath)); }
+
+image_pixels image_resource::load_pixels(const std::string& filepath)
 {
   // load raw data using stb_image
   int width, height, channels;
-  stbi_uc* pixels = stbi_load(filepath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  // decode from the mapped file
+  utils::mapped_file file(filepath, utils::mapped_file::access_hint::SEQUENTIAL);
+  stbi_uc* pixels = stbi_load_from_memory(
+    reinterpret_cast<const stbi_uc*>(file.data()),
+    static_cast<int>(file.size()),
+    &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels)
+    throw std::runtime_error("failed to load texture: " + filepath);
+
+  image_pixels ret;
+  ret.width  = static_cast<uint32_t>(width);
+  ret.height = static_cast<uint32_t>(height);
+  ret.data.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+  stbi_image_free(pixels);
+  return ret;
+}
 
-  VkDeviceSize image_size = width * height * 4;
+u_ptr<image_resource> image_resource::create_from_pixels(device& device, const image_pixels& pixels)
+{
+  VkDeviceSize image_size = pixels.data.size();
 
   auto staging_buffer = buffer::create(
     device,
@@ -24,11 +45,10 @@ u_ptr<image_resource> image_resource::create_from_file(device& device, const std
     1,
     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    pixels
+    const_cast<uint8_t*>(pixels.data.data())
   );
 
-  VkExtent3D extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 };
-  free(pixels);
+  VkExtent3D extent = { pixels.width, pixels.height, 1 };
 
   // create texture image
   VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
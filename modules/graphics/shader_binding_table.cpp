@@ -3,6 +3,7 @@
 #include <graphics/device.hpp>
 #include <graphics/buffer.hpp>
 #include <graphics/utils.hpp>
+#include <utils/logger.hpp>
 #include <utils/utils.hpp>
 
 namespace hnll::graphics {
@@ -148,7 +149,7 @@ void shader_binding_table::setup_shader_groups(
         shader_types_polled[static_cast<uint32_t>(rt_shader_id::INT)].push_back(shader_names[i]);
         break;
       default :
-        std::cerr << "not ray tracing shader : " + shader_names[i] << std::endl;
+        HNLL_LOG_ERROR("not ray tracing shader : ", shader_names[i]);
         break;
     }
   }
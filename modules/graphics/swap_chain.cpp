@@ -1,13 +1,13 @@
 //hnll
 #include <graphics/swap_chain.hpp>
 #include <graphics/timeline_semaphore.hpp>
+#include <utils/logger.hpp>
 #include <utils/vulkan_config.hpp>
 #include <utils/singleton.hpp>
 
 // std
 #include <array>
 #include <cstring>
-#include <iostream>
 #include <limits>
 #include <stdexcept>
 
@@ -595,18 +595,18 @@ VkPresentModeKHR swap_chain::choose_swap_present_mode(const std::vector<VkPresen
     if (available_present_mode == VK_PRESENT_MODE_IMMEDIATE_KHR &&
       present_mode == utils::present_mode::IMMEDIATE)
     {
-      std::cout << "Present mode: Immediate" << std::endl;
+      HNLL_LOG_INFO("Present mode: Immediate");
       return available_present_mode;
     }
     else if (available_present_mode == VK_PRESENT_MODE_MAILBOX_KHR &&
       present_mode == utils::present_mode::V_SYNC)
     {
-      std::cout << "Present mode: V-Sync" << std::endl;
+      HNLL_LOG_INFO("Present mode: V-Sync");
       return available_present_mode;
     }
   }
 
-  std::cout << "Present mode: V-Sync" << std::endl;
+  HNLL_LOG_INFO("Present mode: V-Sync");
   return VK_PRESENT_MODE_FIFO_KHR;
 }
 
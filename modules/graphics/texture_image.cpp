@@ -11,9 +11,15 @@ u_ptr<desc_layout> texture_image::desc_layout_;
 u_ptr<texture_image> texture_image::create(device& device, const std::string &filepath)
 { return std::make_unique<texture_image>(device, filepath); }
 
-texture_image::texture_image(device &device, const std::string& filepath) : device_(device)
+u_ptr<texture_image> texture_image::create_from_pixels(device& device, const image_pixels& pixels)
+{ return std::make_unique<texture_image>(device, image_resource::create_from_pixels(device, pixels)); }
+
+texture_image::texture_image(device &device, const std::string& filepath)
+  : texture_image(device, image_resource::create_from_file(device, filepath)) {}
+
+texture_image::texture_image(device& device, u_ptr<image_resource>&& image) : device_(device)
 {
-  image_ = image_resource::create_from_file(device, filepath);
+  image_ = std::move(image);
   create_sampler();
 
   // desc set layout is basically set up by engine, because it's necessary for shader ctor
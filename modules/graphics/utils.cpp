@@ -1,5 +1,9 @@
 // hnll
 #include <graphics/utils.hpp>
+#include <utils/mapped_file.hpp>
+
+// std
+#include <filesystem>
 
 // libs
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -39,7 +43,12 @@ void obj_loader::load_model(const std::string& filename)
   std::vector<tinyobj::material_t> materials;
   std::string warn, err;
 
-  if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str()))
+  // parse the mapped file in place, .mtl files are looked up next to it
+  utils::mapped_file file(filename, utils::mapped_file::access_hint::SEQUENTIAL);
+  utils::memory_istream stream(file);
+  auto base_dir = std::filesystem::path(filename).parent_path().string();
+  tinyobj::MaterialFileReader material_reader(base_dir.empty() ? "" : base_dir + "/");
+  if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, &material_reader))
     throw std::runtime_error(warn + err);
 
   vertices.clear();
@@ -1,2 +1,85 @@
 // hnll
-#include <physics/collision_detector.hpp>
\ No newline at end of file
+#include <physics/collision_detector.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <utils/parallel.hpp>
+
+// std
+#include <algorithm>
+
+namespace hnll::physics {
+
+collision_detector::volume_id collision_detector::add_volume(const geometry::bounding_volume& volume)
+{
+  volumes_.emplace_back(&volume);
+  dirty_ = true;
+  return static_cast<volume_id>(volumes_.size() - 1);
+}
+
+void collision_detector::clear_volumes()
+{
+  volumes_.clear();
+  bvh_.reset();
+  collisions_.clear();
+  dirty_ = true;
+}
+
+void collision_detector::update()
+{
+  if (dirty_ || !bvh_ || ++refit_count_ >= REBUILD_INTERVAL) {
+    bvh_ = geometry::bvh::create(volumes_, pool_);
+    dirty_ = false;
+    refit_count_ = 0;
+  }
+  else {
+    bvh_->refit();
+  }
+}
+
+const std::vector<collision_detector::collision_pair>& collision_detector::detect_collisions()
+{
+  if (dirty_ || !bvh_)
+    update();
+
+  // each volume queries the others, and keeps the pairs with the larger ids
+  auto detect = [this](size_t begin, size_t end, std::vector<collision_pair> pairs) {
+    std::vector<volume_id> ids;
+    for (auto i = begin; i < end; i++) {
+      ids.clear();
+      bvh_->query(*volumes_[i], ids);
+      std::sort(ids.begin(), ids.end());
+      for (auto id : ids)
+        if (id > i)
+          pairs.emplace_back(static_cast<volume_id>(i), id);
+    }
+    return pairs;
+  };
+
+  if (pool_) {
+    // partials are concatenated in order, so that the result doesn't depend on the scheduling
+    collisions_ = utils::parallel_reduce(*pool_, 0, volumes_.size(), std::vector<collision_pair>{}, detect,
+      [](std::vector<collision_pair> a, std::vector<collision_pair> b) {
+        a.insert(a.end(), b.begin(), b.end());
+        return a;
+      });
+  }
+  else {
+    collisions_.clear();
+    collisions_ = detect(0, volumes_.size(), std::move(collisions_));
+  }
+  return collisions_;
+}
+
+geometry::ray_hit collision_detector::cast_ray(const geometry::ray& ray, double t_max) const
+{
+  if (!bvh_)
+    return {};
+  return bvh_->intersect(ray, t_max);
+}
+
+void collision_detector::query(const geometry::bounding_volume& volume, std::vector<volume_id>& ids) const
+{
+  if (bvh_)
+    bvh_->query(volume, ids);
+}
+
+} // namespace hnll::physics
@@ -4,6 +4,7 @@
 #include <game/modules/graphics_engine.hpp>
 #include <graphics/desc_set.hpp>
 #include <graphics/buffer.hpp>
+#include <utils/memory_tracker.hpp>
 
 namespace hnll::physics {
 
@@ -11,6 +12,7 @@ u_ptr<graphics::desc_layout> mass_spring_cloth::desc_layout_ = nullptr;
 
 s_ptr<mass_spring_cloth> mass_spring_cloth::create(int x_grid, int y_grid, float x_len, float y_len)
 {
+  HNLL_MEMORY_SCOPE(PHYSICS);
   auto ret = std::make_shared<mass_spring_cloth>(x_grid, y_grid, x_len, y_len);
 
   // add to shaders
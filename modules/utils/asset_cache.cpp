@@ -0,0 +1,317 @@
+// hnll
+#include <utils/asset_cache.hpp>
+#include <utils/hash.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hnll::utils {
+
+namespace fs = std::filesystem;
+
+static constexpr char ENTRY_MAGIC[8] = { 'H', 'N', 'L', 'L', 'C', 'A', 'C', 'H' };
+static constexpr uint32_t ENTRY_VERSION = 2;
+static constexpr std::string_view TEMP_EXTENSION = ".tmp";
+// temporary files older than this are left by crashed writers
+static constexpr std::chrono::seconds STALE_TEMP_AGE{ 60 * 60 };
+// size of the head and the tail blocks hashed before the whole content
+static constexpr size_t EDGE_BLOCK_SIZE = 64 * 1024;
+
+struct entry_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t source_size;
+  int64_t  source_mtime; // ns
+  uint64_t source_hash;
+  uint64_t source_edge_hash; // head and tail blocks only
+  uint64_t params_hash;
+  uint64_t payload_size;
+};
+
+struct file_stamp
+{
+  uint64_t size;
+  int64_t mtime;
+};
+
+// a single stat
+static std::optional<file_stamp> get_file_stamp(const std::string& path)
+{
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0)
+    return std::nullopt;
+#ifdef __APPLE__
+  auto mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1'000'000'000 + st.st_mtimespec.tv_nsec;
+#else
+  auto mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+#endif
+  return file_stamp{ static_cast<uint64_t>(st.st_size), mtime };
+}
+
+static uint64_t hash_edges(const char* data, size_t size)
+{
+  if (size <= EDGE_BLOCK_SIZE * 2)
+    return hash_bytes(data, size);
+  auto head = hash_bytes(data, EDGE_BLOCK_SIZE);
+  return hash_bytes(data + size - EDGE_BLOCK_SIZE, EDGE_BLOCK_SIZE, head);
+}
+
+struct content_hash
+{
+  uint64_t edges;
+  uint64_t full;
+};
+
+// full is only computed if the edges match (or expected_edges is nullopt)
+static std::optional<content_hash> hash_file(const std::string& path, std::optional<uint64_t> expected_edges = std::nullopt)
+{
+  try {
+    mapped_file file(path, mapped_file::access_hint::SEQUENTIAL);
+    content_hash hash{ hash_edges(file.data(), file.size()), 0 };
+    if (expected_edges && *expected_edges != hash.edges)
+      return hash;
+    hash.full = hash_bytes(file.data(), file.size());
+    return hash;
+  }
+  catch (const std::exception&) {
+    return std::nullopt;
+  }
+}
+
+static bool ends_with(const std::string& str, std::string_view suffix)
+{ return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0; }
+
+asset_cache::asset_cache(const std::string& directory, uint64_t max_size)
+  : directory_(directory), max_size_(max_size)
+{
+  std::error_code ec;
+  fs::create_directories(directory_, ec);
+  if (ec)
+    throw std::runtime_error("failed to create cache directory : " + directory_);
+  // the only scan until the cache grows beyond max_size
+  evict();
+}
+
+std::string asset_cache::get_entry_path(const std::string& source_path, uint64_t params_hash) const
+{
+  char key[17];
+  std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash_string(source_path, params_hash)));
+  // the stem is only for the readability
+  return directory_ + "/" + fs::path(source_path).stem().string() + "-" + key + std::string(ENTRY_EXTENSION);
+}
+
+std::optional<asset_cache::entry> asset_cache::lookup(const std::string& source_path, uint64_t params_hash)
+{
+  auto source = get_file_stamp(source_path);
+  if (!source)
+    return std::nullopt;
+
+  auto entry_path = get_entry_path(source_path, params_hash);
+  auto entry_stamp = get_file_stamp(entry_path);
+  if (!entry_stamp || entry_stamp->size < sizeof(entry_header))
+    return std::nullopt;
+
+  std::optional<mapped_file> file;
+  try {
+    file.emplace(entry_path, mapped_file::access_hint::SEQUENTIAL);
+  }
+  // removed by another process in the meantime
+  catch (const std::exception&) {
+    return std::nullopt;
+  }
+
+  entry_header header;
+  if (file->size() < sizeof(header))
+    return std::nullopt;
+  std::memcpy(&header, file->data(), sizeof(header));
+
+  if (std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) != 0
+      || header.version != ENTRY_VERSION
+      || header.header_size != sizeof(entry_header)
+      || header.params_hash != params_hash
+      || header.payload_size != file->size() - header.header_size) {
+    remove(source_path, params_hash);
+    return std::nullopt;
+  }
+
+  // fast path
+  bool valid = header.source_size == source->size && header.source_mtime == source->mtime;
+
+  // touched or copied, compare the content.
+  // an edited source usually differs in the head or the tail, which rejects it without reading the rest
+  if (!valid && header.source_size == source->size) {
+    auto source_hash = hash_file(source_path, header.source_edge_hash);
+    valid = source_hash && source_hash->edges == header.source_edge_hash && source_hash->full == header.source_hash;
+    if (valid) {
+      // re-stamp for the fast path
+      header.source_mtime = source->mtime;
+      write_entry(entry_path, &header, sizeof(header), { file->data() + header.header_size, header.payload_size });
+    }
+  }
+
+  if (!valid) {
+    remove(source_path, params_hash);
+    return std::nullopt;
+  }
+
+  // record the use for the lru eviction
+  auto now = fs::file_time_type::clock::now();
+  auto entry_mtime = std::chrono::nanoseconds(entry_stamp->mtime);
+  auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+  if (now_ns - entry_mtime > TOUCH_INTERVAL) {
+    std::error_code ec;
+    fs::last_write_time(entry_path, now, ec);
+  }
+
+  return entry(std::move(*file), sizeof(entry_header));
+}
+
+bool asset_cache::store(const std::string& source_path, uint64_t params_hash, std::string_view payload)
+{
+  auto source = get_file_stamp(source_path);
+  auto source_hash = hash_file(source_path);
+  if (!source || !source_hash)
+    return false;
+
+  entry_header header;
+  std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+  header.version = ENTRY_VERSION;
+  header.header_size = sizeof(entry_header);
+  header.source_size = source->size;
+  header.source_mtime = source->mtime;
+  header.source_hash = source_hash->full;
+  header.source_edge_hash = source_hash->edges;
+  header.params_hash = params_hash;
+  header.payload_size = payload.size();
+
+  auto entry_path = get_entry_path(source_path, params_hash);
+  auto old_entry = get_file_stamp(entry_path);
+  if (!write_entry(entry_path, &header, sizeof(header), payload))
+    return false;
+
+  uint64_t entry_size = sizeof(header) + payload.size();
+  // wraps around if the entry shrinks, which is still the right sum
+  auto added = entry_size - (old_entry ? old_entry->size : 0);
+  if (tracked_size_.fetch_add(added, std::memory_order_relaxed) + added > max_size_)
+    evict();
+  return true;
+}
+
+bool asset_cache::write_entry(const std::string& entry_path, const void* header, size_t header_size, std::string_view payload)
+{
+  // unique among the threads and the processes
+  static std::atomic<uint64_t> temp_counter = 0;
+  auto temp_path = entry_path + "." + std::to_string(::getpid()) + "." + std::to_string(temp_counter++) + std::string(TEMP_EXTENSION);
+
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file)
+      return false;
+    file.write(static_cast<const char*>(header), static_cast<std::streamsize>(header_size));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    file.close();
+    if (!file) {
+      std::error_code ec;
+      fs::remove(temp_path, ec);
+      return false;
+    }
+  }
+
+  // atomically replaces the old entry, readers keep the old mapping
+  std::error_code ec;
+  fs::rename(temp_path, entry_path, ec);
+  if (ec) {
+    fs::remove(temp_path, ec);
+    return false;
+  }
+  return true;
+}
+
+void asset_cache::remove(const std::string& source_path, uint64_t params_hash)
+{
+  auto entry_path = get_entry_path(source_path, params_hash);
+  auto entry_stamp = get_file_stamp(entry_path);
+  std::error_code ec;
+  if (entry_stamp && fs::remove(entry_path, ec))
+    tracked_size_.fetch_sub(entry_stamp->size, std::memory_order_relaxed);
+}
+
+void asset_cache::evict()
+{
+  std::lock_guard<std::mutex> lock(evict_mutex_);
+
+  struct entry_info
+  {
+    fs::path path;
+    uint64_t size;
+    fs::file_time_type last_use;
+  };
+  std::vector<entry_info> entries;
+  uint64_t total_size = 0;
+  auto now = fs::file_time_type::clock::now();
+
+  // other processes may add or remove the files while iterating, ignore the errors
+  std::error_code ec;
+  for (const auto& file : fs::directory_iterator(directory_, ec)) {
+    std::error_code file_ec;
+    auto name = file.path().filename().string();
+    auto last_write = file.last_write_time(file_ec);
+    if (file_ec)
+      continue;
+
+    if (ends_with(name, TEMP_EXTENSION)) {
+      if (now - last_write > STALE_TEMP_AGE)
+        fs::remove(file.path(), file_ec);
+      continue;
+    }
+    if (!ends_with(name, ENTRY_EXTENSION))
+      continue;
+
+    auto size = file.file_size(file_ec);
+    if (file_ec)
+      continue;
+    entries.push_back({ file.path(), size, last_write });
+    total_size += size;
+  }
+
+  if (total_size <= max_size_) {
+    tracked_size_.store(total_size, std::memory_order_relaxed);
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.last_use < b.last_use; });
+  for (const auto& e : entries) {
+    if (total_size <= max_size_)
+      break;
+    fs::remove(e.path, ec);
+    total_size -= e.size;
+  }
+  tracked_size_.store(total_size, std::memory_order_relaxed);
+}
+
+uint64_t asset_cache::get_total_size() const
+{
+  uint64_t total_size = 0;
+  std::error_code ec;
+  for (const auto& file : fs::directory_iterator(directory_, ec)) {
+    std::error_code file_ec;
+    if (!ends_with(file.path().filename().string(), ENTRY_EXTENSION))
+      continue;
+    auto size = file.file_size(file_ec);
+    if (!file_ec)
+      total_size += size;
+  }
+  return total_size;
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,158 @@
+#include <utils/block_pool.hpp>
+
+// std
+#include <cassert>
+#include <mutex>
+
+namespace hnll::utils {
+
+// size classes : 32, 64, 128, 256 bytes
+constexpr size_t MIN_BLOCK_SIZE = 32;
+constexpr size_t CLASS_COUNT = 4;
+// blocks moved between a thread and the depot at once
+constexpr size_t BATCH_SIZE = 32;
+static_assert((MIN_BLOCK_SIZE << (CLASS_COUNT - 1)) == block_pool::MAX_BLOCK_SIZE);
+
+static size_t get_size_class(size_t size)
+{
+  size_t size_class = 0;
+  while ((MIN_BLOCK_SIZE << size_class) < size)
+    size_class++;
+  return size_class;
+}
+
+// a free block is used as a list node
+struct free_block
+{
+  free_block* next;
+  // only for the first block of a batch in the depot
+  free_block* next_batch;
+  size_t batch_count;
+};
+static_assert(sizeof(free_block) <= MIN_BLOCK_SIZE);
+
+// shared by all threads, guarded by a mutex but touched only once per BATCH_SIZE blocks
+struct block_depot
+{
+  std::mutex mutex;
+  free_block* batches[CLASS_COUNT] = {};
+};
+
+static block_depot& get_depot()
+{
+  // never destroyed, threads may return their blocks after static destruction
+  static auto* depot = new block_depot;
+  return *depot;
+}
+
+static void push_batch(size_t size_class, free_block* batch, size_t count)
+{
+  batch->batch_count = count;
+  auto& depot = get_depot();
+  std::lock_guard<std::mutex> lock(depot.mutex);
+  batch->next_batch = depot.batches[size_class];
+  depot.batches[size_class] = batch;
+}
+
+static free_block* pop_batch(size_t size_class, size_t& count)
+{
+  {
+    auto& depot = get_depot();
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    if (auto batch = depot.batches[size_class]; batch) {
+      depot.batches[size_class] = batch->next_batch;
+      count = batch->batch_count;
+      return batch;
+    }
+  }
+
+  // carve a new slab, slabs live until the process exits
+  const auto block_size = MIN_BLOCK_SIZE << size_class;
+  auto slab = static_cast<std::byte*>(::operator new(block_size * BATCH_SIZE));
+  free_block* head = nullptr;
+  for (size_t i = BATCH_SIZE; i > 0; i--) {
+    auto block = reinterpret_cast<free_block*>(slab + (i - 1) * block_size);
+    block->next = head;
+    head = block;
+  }
+  count = BATCH_SIZE;
+  return head;
+}
+
+struct thread_cache
+{
+  free_block* heads[CLASS_COUNT] = {};
+  size_t counts[CLASS_COUNT] = {};
+
+  // hand the remaining blocks to the other threads
+  ~thread_cache();
+
+  void flush(size_t size_class, size_t count)
+  {
+    auto batch = heads[size_class];
+    auto last = batch;
+    for (size_t i = 1; i < count; i++)
+      last = last->next;
+    heads[size_class] = last->next;
+    counts[size_class] -= count;
+    last->next = nullptr;
+    push_batch(size_class, batch, count);
+  }
+};
+
+// trivially destructible, so it's still readable while other thread_locals are destroyed
+static thread_local bool cache_destroyed = false;
+static thread_local thread_cache cache;
+
+thread_cache::~thread_cache()
+{
+  for (size_t size_class = 0; size_class < CLASS_COUNT; size_class++) {
+    if (counts[size_class] > 0)
+      flush(size_class, counts[size_class]);
+  }
+  cache_destroyed = true;
+}
+
+void* block_pool::allocate(size_t size)
+{
+  assert(size <= MAX_BLOCK_SIZE && "too large for block_pool.");
+  const auto size_class = get_size_class(size);
+
+  if (cache_destroyed) {
+    size_t count;
+    auto batch = pop_batch(size_class, count);
+    if (count > 1)
+      push_batch(size_class, batch->next, count - 1);
+    return batch;
+  }
+
+  if (cache.heads[size_class] == nullptr) {
+    cache.heads[size_class] = pop_batch(size_class, cache.counts[size_class]);
+  }
+  auto block = cache.heads[size_class];
+  cache.heads[size_class] = block->next;
+  cache.counts[size_class]--;
+  return block;
+}
+
+void block_pool::deallocate(void* ptr, size_t size)
+{
+  if (ptr == nullptr)
+    return;
+  const auto size_class = get_size_class(size);
+  auto block = static_cast<free_block*>(ptr);
+
+  if (cache_destroyed) {
+    block->next = nullptr;
+    push_batch(size_class, block, 1);
+    return;
+  }
+
+  block->next = cache.heads[size_class];
+  cache.heads[size_class] = block;
+  // keep at most 2 batches per thread
+  if (++cache.counts[size_class] > BATCH_SIZE * 2)
+    cache.flush(size_class, BATCH_SIZE);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,94 @@
+#include <utils/frame_arena.hpp>
+
+// std
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace hnll::utils {
+
+// regions are aligned to a cache line, so that each frame starts on its own line
+constexpr size_t REGION_ALIGNMENT = 64;
+
+frame_arena::frame_arena(size_t capacity, std::pmr::memory_resource* upstream) : upstream_(upstream)
+{
+  assert(upstream_ && "frame_arena needs an upstream resource.");
+  for (auto& r : regions_) {
+    r.capacity = capacity;
+    if (capacity > 0)
+      r.data = static_cast<std::byte*>(upstream_->allocate(capacity, REGION_ALIGNMENT));
+  }
+}
+
+frame_arena::~frame_arena()
+{
+  for (size_t i = 0; i < regions_.size(); i++) {
+    reset_region(i);
+    if (regions_[i].data)
+      upstream_->deallocate(regions_[i].data, regions_[i].capacity, REGION_ALIGNMENT);
+  }
+}
+
+void frame_arena::begin_frame()
+{
+  frame_index_ = (frame_index_ + 1) % regions_.size();
+  auto& r = regions_[frame_index_];
+
+  // grow the region if the last use of it overflowed
+  auto used = r.offset.load(std::memory_order_relaxed) + r.overflow_bytes.load(std::memory_order_relaxed);
+  reset_region(frame_index_);
+  if (used > r.capacity) {
+    if (r.data)
+      upstream_->deallocate(r.data, r.capacity, REGION_ALIGNMENT);
+    r.capacity = std::bit_ceil(used);
+    r.data = static_cast<std::byte*>(upstream_->allocate(r.capacity, REGION_ALIGNMENT));
+  }
+}
+
+size_t frame_arena::get_used_bytes() const
+{
+  const auto& r = regions_[frame_index_];
+  return r.offset.load(std::memory_order_relaxed) + r.overflow_bytes.load(std::memory_order_relaxed);
+}
+
+void* frame_arena::do_allocate(size_t bytes, size_t alignment)
+{
+  auto& r = regions_[frame_index_];
+  const auto base = reinterpret_cast<uintptr_t>(r.data);
+
+  auto offset = r.offset.load(std::memory_order_relaxed);
+  while (true) {
+    auto aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (aligned + bytes > r.capacity)
+      return allocate_overflow(bytes, alignment);
+    // other threads may bump the offset concurrently
+    if (r.offset.compare_exchange_weak(offset, aligned + bytes, std::memory_order_relaxed))
+      return r.data + aligned;
+  }
+}
+
+void* frame_arena::allocate_overflow(size_t bytes, size_t alignment)
+{
+  auto& r = regions_[frame_index_];
+  auto ptr = upstream_->allocate(bytes, alignment);
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.overflow.push_back({ ptr, bytes, alignment });
+  r.overflow_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  return ptr;
+}
+
+void frame_arena::reset_region(size_t index)
+{
+  auto& r = regions_[index];
+  high_water_mark_ = std::max(high_water_mark_,
+    r.offset.load(std::memory_order_relaxed) + r.overflow_bytes.load(std::memory_order_relaxed));
+
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (const auto& block : r.overflow)
+    upstream_->deallocate(block.ptr, block.bytes, block.alignment);
+  r.overflow.clear();
+  r.overflow_bytes.store(0, std::memory_order_relaxed);
+  r.offset.store(0, std::memory_order_relaxed);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,129 @@
+// hnll
+#include <utils/frame_pacer.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace hnll::utils {
+
+// weight of a new oversleep sample in the running estimate
+constexpr double OVERSLEEP_SMOOTHING = 0.1;
+// the spin tail covers mean + N * deviation of the oversleep
+constexpr double OVERSLEEP_MARGIN = 4.0;
+
+static double to_ms(frame_pacer::duration d)
+{ return std::chrono::duration<double, std::milli>(d).count(); }
+
+frame_pacer::frame_pacer(float max_fps)
+{
+  set_max_fps(max_fps);
+  reset();
+}
+
+void frame_pacer::set_max_fps(float max_fps)
+{
+  max_fps_ = max_fps;
+  period_ = max_fps > 0.f
+    ? std::chrono::duration_cast<duration>(std::chrono::duration<double>(1.0 / max_fps))
+    : duration::zero();
+  deadline_ = last_frame_ + period_;
+}
+
+void frame_pacer::reset()
+{
+  last_frame_ = clock::now();
+  deadline_ = last_frame_ + period_;
+}
+
+void frame_pacer::reset_statistics()
+{
+  frame_count_ = 0;
+  interval_mean_ = 0.0;
+  interval_m2_ = 0.0;
+  interval_min_ = 0.0;
+  interval_max_ = 0.0;
+  missed_count_ = 0;
+  error_sum_ = 0.0;
+}
+
+float frame_pacer::wait_for_next_frame()
+{
+  auto now = clock::now();
+
+  if (period_ > duration::zero()) {
+    // coarse sleep, leave the spin tail for the scheduler's wake up latency
+    auto wake_target = deadline_ - spin_threshold_;
+    if (now < wake_target) {
+      std::this_thread::sleep_until(wake_target);
+      now = clock::now();
+      calibrate(now - wake_target);
+    }
+    // fine spin
+    while (now < deadline_) {
+      std::this_thread::yield();
+      now = clock::now();
+    }
+  }
+
+  auto error = now - deadline_;
+  record(now - last_frame_, period_ > duration::zero() ? error : duration::zero());
+
+  // drift correction : keep the phase of the schedule unless the frame is too late,
+  // catching up with more than half a period would make the next frame visibly short
+  if (error > period_ / 2)
+    deadline_ = now + period_;
+  else
+    deadline_ += period_;
+
+  float dt = std::chrono::duration<float>(now - last_frame_).count();
+  last_frame_ = now;
+  return dt;
+}
+
+void frame_pacer::calibrate(duration oversleep)
+{
+  auto sample = static_cast<double>(oversleep.count());
+  oversleep_mean_ += OVERSLEEP_SMOOTHING * (sample - oversleep_mean_);
+  oversleep_deviation_ += OVERSLEEP_SMOOTHING * (std::abs(sample - oversleep_mean_) - oversleep_deviation_);
+
+  auto threshold = duration(static_cast<int64_t>(oversleep_mean_ + OVERSLEEP_MARGIN * oversleep_deviation_));
+  spin_threshold_ = std::clamp(threshold, MIN_SPIN, MAX_SPIN);
+}
+
+void frame_pacer::record(duration interval, duration error)
+{
+  auto ms = to_ms(interval);
+  if (frame_count_ == 0) {
+    interval_min_ = ms;
+    interval_max_ = ms;
+  }
+  frame_count_++;
+  auto delta = ms - interval_mean_;
+  interval_mean_ += delta / static_cast<double>(frame_count_);
+  interval_m2_ += delta * (ms - interval_mean_);
+  interval_min_ = std::min(interval_min_, ms);
+  interval_max_ = std::max(interval_max_, ms);
+
+  if (error > MAX_SPIN)
+    missed_count_++;
+  error_sum_ += std::abs(to_ms(error));
+}
+
+frame_pacer::statistics frame_pacer::get_statistics() const
+{
+  statistics ret;
+  ret.frame_count = frame_count_;
+  if (frame_count_ == 0)
+    return ret;
+  ret.mean = interval_mean_;
+  ret.variance = frame_count_ > 1 ? interval_m2_ / static_cast<double>(frame_count_ - 1) : 0.0;
+  ret.min = interval_min_;
+  ret.max = interval_max_;
+  ret.missed_count = missed_count_;
+  ret.mean_error = error_sum_ / static_cast<double>(frame_count_);
+  return ret;
+}
+
+} // namespace hnll::utils
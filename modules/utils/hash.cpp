@@ -0,0 +1,102 @@
+// hnll
+#include <utils/hash.hpp>
+
+// std
+#include <cstring>
+
+namespace hnll::utils {
+
+static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// memcpy for the unaligned loads, compiles to a single mov
+static inline uint64_t read64(const unsigned char* p)
+{
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t read32(const unsigned char* p)
+{
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t round(uint64_t acc, uint64_t input)
+{
+  acc += input * PRIME2;
+  acc = rotl(acc, 31);
+  return acc * PRIME1;
+}
+
+static inline uint64_t merge_round(uint64_t acc, uint64_t val)
+{
+  acc ^= round(0, val);
+  return acc * PRIME1 + PRIME4;
+}
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed)
+{
+  auto p = static_cast<const unsigned char*>(data);
+  const auto end = p + size;
+  uint64_t h;
+
+  if (size >= 32) {
+    // four independent lanes keep the pipeline busy
+    uint64_t v1 = seed + PRIME1 + PRIME2;
+    uint64_t v2 = seed + PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME1;
+    const auto limit = end - 32;
+    do {
+      v1 = round(v1, read64(p));      p += 8;
+      v2 = round(v2, read64(p));      p += 8;
+      v3 = round(v3, read64(p));      p += 8;
+      v4 = round(v4, read64(p));      p += 8;
+    } while (p <= limit);
+
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    h = merge_round(h, v4);
+  }
+  else
+    h = seed + PRIME5;
+
+  h += static_cast<uint64_t>(size);
+
+  // tail
+  while (p + 8 <= end) {
+    h ^= round(0, read64(p));
+    h = rotl(h, 27) * PRIME1 + PRIME4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+    h = rotl(h, 23) * PRIME2 + PRIME3;
+    p += 4;
+  }
+  while (p < end) {
+    h ^= (*p) * PRIME5;
+    h = rotl(h, 11) * PRIME1;
+    p++;
+  }
+
+  // avalanche
+  h ^= h >> 33;
+  h *= PRIME2;
+  h ^= h >> 29;
+  h *= PRIME3;
+  h ^= h >> 32;
+  return h;
+}
+
+} // namespace hnll::utils
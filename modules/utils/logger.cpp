@@ -0,0 +1,264 @@
+// hnll
+#include <utils/logger.hpp>
+#include <utils/mpmc_ring.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hnll::utils {
+
+static constexpr std::array<const char*, 6> level_names = {
+  "TRACE",
+  "DEBUG",
+  "INFO",
+  "WARN",
+  "ERROR",
+  "OFF",
+};
+
+// lines popped at once by the writer
+static constexpr size_t WRITE_BATCH = 64;
+
+struct logger_state
+{
+  mpmc_ring<log_record> queue{ logger::QUEUE_CAPACITY };
+  std::atomic<log_level> level = COMPILED_LOG_LEVEL;
+  std::atomic<bool> console_enabled = true;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  // ticket of the next line to write, published after the line reaches the sinks.
+  // the writer pops the lines in the order of the ring indices, which are the tickets.
+  std::atomic<uint64_t> written_ticket = 0;
+  std::atomic<uint64_t> dropped_count = 0;
+  // touched only by the writer
+  uint64_t reported_dropped_count = 0;
+  std::atomic<uint32_t> next_thread_id = 0;
+
+  // the producers wake the writer only while it's sleeping
+  std::atomic<uint32_t> sequence = 0;
+  std::atomic<bool> sleeping = false;
+  std::atomic<bool> stopped = false;
+  std::thread writer;
+
+  // guards the sinks, locked only by the writer (or by the producers after the stop)
+  std::mutex sink_mutex;
+  FILE* file = nullptr;
+  // set by stop_writer() once it has written the lines left in the queue
+  bool drained = false;
+};
+
+static void write_line(logger_state& state, const log_record& record)
+{
+  constexpr size_t HEADER_CAPACITY = 64;
+  // header, text and the newline
+  char line[HEADER_CAPACITY + log_record::MAX_LENGTH];
+  auto seconds = static_cast<double>(record.time_ns) * 1e-9;
+  auto header = std::snprintf(line, HEADER_CAPACITY, "[%11.6f] [%-5s] [t%u] ",
+    seconds, level_names[static_cast<size_t>(record.level)], record.thread_id);
+  // snprintf returns the untruncated length, or a negative value on an encoding error
+  size_t header_length = header < 0 ? 0 : std::min<size_t>(header, HEADER_CAPACITY - 1);
+  size_t text_length = std::min<size_t>(record.length, log_record::MAX_LENGTH);
+  std::memcpy(line + header_length, record.text, text_length);
+  auto length = header_length + text_length;
+  line[length++] = '\n';
+
+  if (state.console_enabled.load(std::memory_order_relaxed))
+    std::fwrite(line, 1, length, record.level >= log_level::WARN ? stderr : stdout);
+  if (state.file)
+    std::fwrite(line, 1, length, state.file);
+}
+
+static void flush_sinks(logger_state& state)
+{
+  std::fflush(stdout);
+  if (state.file)
+    std::fflush(state.file);
+}
+
+// writes the queued lines synchronously, the caller locks sink_mutex
+static void drain_queue(logger_state& state)
+{
+  while (auto record = state.queue.try_pop())
+    write_line(state, *record);
+  flush_sinks(state);
+}
+
+static void run_writer(logger_state& state)
+{
+  std::vector<log_record> batch(WRITE_BATCH);
+  while (true) {
+    auto count = state.queue.try_pop_batch(batch.begin(), batch.size());
+    if (count > 0) {
+      {
+        // a single flush per batch instead of per line
+        std::lock_guard<std::mutex> lock(state.sink_mutex);
+        for (size_t i = 0; i < count; i++)
+          write_line(state, batch[i]);
+        flush_sinks(state);
+      }
+      state.written_ticket.fetch_add(count);
+      state.written_ticket.notify_all();
+      continue;
+    }
+
+    // the dropped lines are reported once the queue is drained
+    if (auto dropped = state.dropped_count.load(std::memory_order_relaxed); dropped != state.reported_dropped_count) {
+      log_record record{};
+      record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state.start).count();
+      record.level = log_level::WARN;
+      log_formatter(record).append(dropped - state.reported_dropped_count);
+      log_formatter(record).append(" lines were dropped, the log queue was full");
+      state.reported_dropped_count = dropped;
+      std::lock_guard<std::mutex> lock(state.sink_mutex);
+      write_line(state, record);
+      flush_sinks(state);
+    }
+
+    if (state.stopped.load())
+      break;
+
+    // sleep until a producer bumps the sequence
+    auto sequence = state.sequence.load();
+    state.sleeping.store(true);
+    if (state.queue.empty())
+      state.sequence.wait(sequence);
+    state.sleeping.store(false);
+  }
+}
+
+static void stop_writer();
+
+// leaked, the lines may be logged while the static objects are destructed
+static logger_state& get_state()
+{
+  static auto* state = []() {
+    auto* ret = new logger_state;
+    ret->writer = std::thread(run_writer, std::ref(*ret));
+    // the remaining lines are written at the exit
+    std::atexit(stop_writer);
+    return ret;
+  }();
+  return *state;
+}
+
+static void stop_writer()
+{
+  auto& state = get_state();
+  if (state.stopped.exchange(true))
+    return;
+  state.sequence.fetch_add(1);
+  state.sequence.notify_one();
+  state.writer.join();
+  std::lock_guard<std::mutex> lock(state.sink_mutex);
+  // a producer may have pushed after the writer saw the empty queue for the last time
+  drain_queue(state);
+  state.drained = true;
+  // wakes flush()
+  state.written_ticket.notify_all();
+  if (state.file) {
+    std::fclose(state.file);
+    state.file = nullptr;
+  }
+}
+
+static thread_local log_record local_record;
+static thread_local uint32_t local_thread_id = UINT32_MAX;
+
+log_record& logger::begin_record(log_level level)
+{
+  auto& state = get_state();
+  if (local_thread_id == UINT32_MAX)
+    local_thread_id = state.next_thread_id.fetch_add(1, std::memory_order_relaxed);
+
+  auto& record = local_record;
+  record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state.start).count();
+  record.thread_id = local_thread_id;
+  record.level = level;
+  record.truncated = false;
+  record.length = 0;
+  return record;
+}
+
+void logger::commit_record(log_record& record)
+{
+  auto& state = get_state();
+  if (record.truncated)
+    std::memcpy(record.text + log_record::MAX_LENGTH - 3, "...", 3);
+
+  // after the writer has stopped (exit), write synchronously
+  if (state.stopped.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(state.sink_mutex);
+    write_line(state, record);
+    flush_sinks(state);
+    return;
+  }
+
+  if (!state.queue.try_push(record)) {
+    state.dropped_count.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  state.sequence.fetch_add(1);
+  if (state.sleeping.load())
+    state.sequence.notify_one();
+
+  // stopped while pushing. the sequence is bumped by stop_writer() too, so that either its drain sees this line
+  // or this check sees the stop. the line is written here only if the drain is already over.
+  if (state.stopped.load()) {
+    std::lock_guard<std::mutex> lock(state.sink_mutex);
+    if (state.drained)
+      drain_queue(state);
+  }
+}
+
+log_level logger::get_level() { return get_state().level.load(std::memory_order_relaxed); }
+
+void logger::set_level(log_level level) { get_state().level.store(level, std::memory_order_relaxed); }
+
+bool logger::set_file(const std::string& path)
+{
+  auto& state = get_state();
+  FILE* file = nullptr;
+  if (!path.empty()) {
+    file = std::fopen(path.c_str(), "a");
+    if (!file)
+      return false;
+  }
+  // the lines before the call go to the previous file
+  flush();
+  std::lock_guard<std::mutex> lock(state.sink_mutex);
+  if (state.file)
+    std::fclose(state.file);
+  state.file = file;
+  return true;
+}
+
+void logger::set_console_enabled(bool enabled)
+{ get_state().console_enabled.store(enabled, std::memory_order_relaxed); }
+
+void logger::flush()
+{
+  auto& state = get_state();
+  // every line pushed before the call has a lower ticket, including the lines of the other threads
+  // that are still being copied into the ring
+  auto target = state.queue.get_push_ticket();
+  while (!state.stopped.load()) {
+    auto written = state.written_ticket.load();
+    if (written >= target)
+      break;
+    state.written_ticket.wait(written);
+  }
+}
+
+uint64_t logger::get_dropped_count() { return get_state().dropped_count.load(std::memory_order_relaxed); }
+
+const char* logger::get_level_name(log_level level) { return level_names[static_cast<size_t>(level)]; }
+
+} // namespace hnll::utils
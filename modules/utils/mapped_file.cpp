@@ -0,0 +1,167 @@
+// hnll
+#include <utils/mapped_file.hpp>
+
+// std
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HNLL_MAPPED_FILE_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace hnll::utils {
+
+#ifdef HNLL_MAPPED_FILE_POSIX
+static int to_madvise_flag(mapped_file::access_hint hint)
+{
+  switch (hint) {
+    case mapped_file::access_hint::SEQUENTIAL : return MADV_SEQUENTIAL;
+    case mapped_file::access_hint::RANDOM :     return MADV_RANDOM;
+    case mapped_file::access_hint::WILL_NEED :  return MADV_WILLNEED;
+    default :                                   return MADV_NORMAL;
+  }
+}
+
+mapped_file::mapped_file(const std::string& path, access_hint hint)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("failed to open file: " + path);
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("failed to stat file: " + path);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+
+  if (size_ >= SMALL_FILE_SIZE) {
+    // the mapping keeps the file alive after closing the descriptor
+    void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr != MAP_FAILED) {
+      ::close(fd);
+      data_ = static_cast<const char*>(ptr);
+      mapped_ = true;
+      advise(hint);
+      return;
+    }
+  }
+
+  // small file, or mmap is not available for the file
+  buffer_.resize(size_);
+  size_t offset = 0;
+  while (offset < size_) {
+    auto count = ::read(fd, buffer_.data() + offset, size_ - offset);
+    if (count <= 0) {
+      ::close(fd);
+      throw std::runtime_error("failed to read file: " + path);
+    }
+    offset += static_cast<size_t>(count);
+  }
+  ::close(fd);
+  data_ = buffer_.data();
+}
+
+void mapped_file::advise(access_hint hint) const
+{
+  if (mapped_)
+    ::madvise(const_cast<char*>(data_), size_, to_madvise_flag(hint));
+}
+
+void mapped_file::release()
+{
+  if (mapped_)
+    ::munmap(const_cast<char*>(data_), size_);
+  buffer_.clear();
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+}
+#else
+// the hints are ignored for the buffered files
+mapped_file::mapped_file(const std::string& path, access_hint)
+{
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if (!file.is_open())
+    throw std::runtime_error("failed to open file: " + path);
+
+  size_ = static_cast<size_t>(file.tellg());
+  buffer_.resize(size_);
+  file.seekg(0);
+  file.read(buffer_.data(), size_);
+  data_ = buffer_.data();
+}
+
+void mapped_file::advise(access_hint) const {}
+
+void mapped_file::release()
+{
+  buffer_.clear();
+  data_ = nullptr;
+  size_ = 0;
+}
+#endif
+
+mapped_file::~mapped_file() { release(); }
+
+mapped_file::mapped_file(mapped_file&& other) noexcept { *this = std::move(other); }
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+  release();
+  // moving the vector keeps its data pointer
+  buffer_ = std::move(other.buffer_);
+  data_ = other.data_;
+  size_ = other.size_;
+  mapped_ = other.mapped_;
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.mapped_ = false;
+  return *this;
+}
+
+// memory_istream ------------------------------------------------------------
+
+memory_istream::memory_streambuf::memory_streambuf(const char* data, size_t size)
+{
+  // streambuf takes a non-const range, but nothing is written through it
+  auto begin = const_cast<char*>(data);
+  setg(begin, begin, begin + size);
+}
+
+memory_istream::memory_streambuf::pos_type memory_istream::memory_streambuf::seekoff(
+  off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+  if (!(which & std::ios_base::in))
+    return pos_type(off_type(-1));
+
+  char* base;
+  if (dir == std::ios_base::beg)
+    base = eback();
+  else if (dir == std::ios_base::cur)
+    base = gptr();
+  else
+    base = egptr();
+
+  auto target = base + off;
+  if (target < eback() || target > egptr())
+    return pos_type(off_type(-1));
+  setg(eback(), target, egptr());
+  return pos_type(target - eback());
+}
+
+memory_istream::memory_streambuf::pos_type memory_istream::memory_streambuf::seekpos(
+  pos_type pos, std::ios_base::openmode which)
+{ return seekoff(off_type(pos), std::ios_base::beg, which); }
+
+memory_istream::memory_istream(const char* data, size_t size)
+  : std::istream(nullptr), buf_(data, size)
+{ rdbuf(&buf_); }
+
+} // namespace hnll::utils
@@ -0,0 +1,126 @@
+// hnll
+#include <utils/memory_tracker.hpp>
+#include <utils/mt_queue.hpp>
+
+// std
+#include <array>
+#include <atomic>
+#include <fstream>
+
+namespace hnll::utils {
+
+// each tag on its own cache line, allocations of different subsystems don't contend
+struct alignas(CACHE_LINE_SIZE) tag_counters
+{
+  std::atomic<int64_t> live_bytes = 0;
+  std::atomic<int64_t> peak_bytes = 0;
+  std::atomic<uint64_t> alloc_count = 0;
+  std::atomic<uint64_t> free_count = 0;
+  std::atomic<uint64_t> frame_alloc_count = 0;
+  std::atomic<uint64_t> last_frame_alloc_count = 0;
+};
+
+// constant initialized, usable from operator new before any dynamic initialization
+static std::array<tag_counters, MEMORY_TAG_COUNT> counters;
+static thread_local memory_tag current_tag = memory_tag::UNTAGGED;
+
+static constexpr std::array<const char*, MEMORY_TAG_COUNT> tag_names = {
+  "untagged",
+  "geometry",
+  "graphics",
+  "audio",
+  "physics",
+  "game",
+};
+
+bool memory_tracker::is_enabled()
+{
+#ifdef HNLL_TRACK_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+memory_tag memory_tracker::get_current_tag() { return current_tag; }
+
+memory_tag memory_tracker::set_current_tag(memory_tag tag)
+{
+  auto previous = current_tag;
+  current_tag = tag;
+  return previous;
+}
+
+void memory_tracker::on_allocate(memory_tag tag, size_t size)
+{
+  auto& c = counters[static_cast<size_t>(tag)];
+  auto live = c.live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+  c.alloc_count.fetch_add(1, std::memory_order_relaxed);
+  c.frame_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  // the cas loop runs only while the usage is growing
+  auto peak = c.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+}
+
+void memory_tracker::on_deallocate(memory_tag tag, size_t size)
+{
+  auto& c = counters[static_cast<size_t>(tag)];
+  c.live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+  c.free_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void memory_tracker::end_frame()
+{
+  for (auto& c : counters)
+    c.last_frame_alloc_count.store(c.frame_alloc_count.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void memory_tracker::reset_peaks()
+{
+  for (auto& c : counters)
+    c.peak_bytes.store(c.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+memory_tracker::report memory_tracker::get_report(memory_tag tag)
+{
+  const auto& c = counters[static_cast<size_t>(tag)];
+  return {
+    tag,
+    get_tag_name(tag),
+    c.live_bytes.load(std::memory_order_relaxed),
+    c.peak_bytes.load(std::memory_order_relaxed),
+    c.alloc_count.load(std::memory_order_relaxed),
+    c.free_count.load(std::memory_order_relaxed),
+    c.last_frame_alloc_count.load(std::memory_order_relaxed)
+  };
+}
+
+std::vector<memory_tracker::report> memory_tracker::get_reports()
+{
+  std::vector<report> ret;
+  ret.reserve(MEMORY_TAG_COUNT);
+  for (size_t i = 0; i < MEMORY_TAG_COUNT; i++)
+    ret.emplace_back(get_report(static_cast<memory_tag>(i)));
+  return ret;
+}
+
+const char* memory_tracker::get_tag_name(memory_tag tag)
+{ return tag_names[static_cast<size_t>(tag)]; }
+
+bool memory_tracker::write_csv(const std::string& path)
+{
+  // take the reports first, the stream allocates
+  auto reports = get_reports();
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  file << "tag,live_bytes,peak_bytes,alloc_count,free_count,frame_alloc_count\n";
+  for (const auto& r : reports) {
+    file << r.name << ',' << r.live_bytes << ',' << r.peak_bytes << ',' << r.alloc_count << ','
+         << r.free_count << ',' << r.frame_alloc_count << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,117 @@
+// replaced operator new / delete for utils::memory_tracker.
+// a binary which replaces operator new by itself must not be linked with HNLL_TRACK_ALLOCATIONS.
+
+#ifdef HNLL_TRACK_ALLOCATIONS
+
+// hnll
+#include <utils/memory_tracker.hpp>
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+namespace hnll::utils {
+
+// placed right before the returned pointer
+struct allocation_header
+{
+  uint64_t size;
+  // from the malloc-ed pointer to the returned pointer
+  uint32_t offset;
+  memory_tag tag;
+};
+static_assert(sizeof(allocation_header) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+static void* tracked_allocate(size_t size, size_t alignment) noexcept
+{
+  // the header fits in the padding for the alignment
+  size_t offset = std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  if (size > std::numeric_limits<size_t>::max() - offset - alignment)
+    return nullptr;
+  void* raw;
+  if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    auto total = (size + offset + alignment - 1) / alignment * alignment;
+    raw = std::aligned_alloc(alignment, total);
+  }
+  else
+    raw = std::malloc(size + offset);
+  if (!raw)
+    return nullptr;
+
+  auto tag = memory_tracker::get_current_tag();
+  auto ptr = static_cast<char*>(raw) + offset;
+  new (ptr - sizeof(allocation_header)) allocation_header{ size, static_cast<uint32_t>(offset), tag };
+  memory_tracker::on_allocate(tag, size);
+  return ptr;
+}
+
+static void tracked_deallocate(void* ptr) noexcept
+{
+  if (!ptr)
+    return;
+  auto header = reinterpret_cast<allocation_header*>(static_cast<char*>(ptr) - sizeof(allocation_header));
+  memory_tracker::on_deallocate(header->tag, header->size);
+  std::free(static_cast<char*>(ptr) - header->offset);
+}
+
+// calls the new handler until the allocation succeeds, as the default operator new does
+static void* tracked_allocate_or_throw(size_t size, size_t alignment)
+{
+  if (size == 0)
+    size = 1;
+  while (true) {
+    if (auto ptr = tracked_allocate(size, alignment))
+      return ptr;
+    auto handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+static void* tracked_allocate_nothrow(size_t size, size_t alignment) noexcept
+{
+  try {
+    return tracked_allocate_or_throw(size, alignment);
+  }
+  catch (...) {
+    return nullptr;
+  }
+}
+
+} // namespace hnll::utils
+
+using hnll::utils::tracked_allocate_nothrow;
+using hnll::utils::tracked_allocate_or_throw;
+using hnll::utils::tracked_deallocate;
+
+void* operator new(std::size_t size) { return tracked_allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t size) { return tracked_allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t size, std::align_val_t al) { return tracked_allocate_or_throw(size, static_cast<size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return tracked_allocate_or_throw(size, static_cast<size_t>(al)); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{ return tracked_allocate_nothrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{ return tracked_allocate_nothrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{ return tracked_allocate_nothrow(size, static_cast<size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{ return tracked_allocate_nothrow(size, static_cast<size_t>(al)); }
+
+void operator delete(void* ptr) noexcept { tracked_deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { tracked_deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { tracked_deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { tracked_deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_deallocate(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { tracked_deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { tracked_deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { tracked_deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tracked_deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_deallocate(ptr); }
+
+#endif // HNLL_TRACK_ALLOCATIONS
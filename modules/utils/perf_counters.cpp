@@ -0,0 +1,433 @@
+// hnll
+#include <utils/perf_counters.hpp>
+#include <utils/common_alias.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace hnll::utils {
+
+static constexpr std::array<const char*, PERF_COUNTER_COUNT> counter_names = {
+  "cycles",
+  "instructions",
+  "cache_references",
+  "cache_misses",
+  "branches",
+  "branch_misses",
+  "stalled_cycles_frontend",
+  "stalled_cycles_backend",
+  "task_clock",
+  "page_faults",
+};
+
+// the core events fit the fixed and general purpose counters of the common cores
+static constexpr std::array<size_t, PERF_COUNTER_COUNT> kernel_group_indices = {
+  0, 0, 0, 0, 0, 0,
+  1, 1, 1, 1,
+};
+
+// sample --------------------------------------------------------------------
+
+double perf_sample::get_ratio(perf_counter numerator, perf_counter denominator) const
+{
+  if (!has(numerator) || !has(denominator) || get(denominator) == 0)
+    return 0.0;
+  return static_cast<double>(get(numerator)) / static_cast<double>(get(denominator));
+}
+
+perf_sample& perf_sample::operator+=(const perf_sample& other)
+{
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++)
+    values[i] += other.values[i];
+  valid_mask |= other.valid_mask;
+  return *this;
+}
+
+perf_sample perf_sample::operator-(const perf_sample& other) const
+{
+  perf_sample ret;
+  ret.valid_mask = valid_mask & other.valid_mask;
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+    // scaled values of a multiplexed group may go backwards slightly
+    ret.values[i] = values[i] > other.values[i] ? values[i] - other.values[i] : 0;
+  }
+  return ret;
+}
+
+// group ---------------------------------------------------------------------
+
+#ifdef __linux__
+static perf_event_attr get_event_attr(perf_counter counter)
+{
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  switch (counter) {
+    case perf_counter::CYCLES :                  attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case perf_counter::INSTRUCTIONS :            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case perf_counter::CACHE_REFERENCES :        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_REFERENCES; break;
+    case perf_counter::CACHE_MISSES :            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+    case perf_counter::BRANCHES :                attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS; break;
+    case perf_counter::BRANCH_MISSES :           attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case perf_counter::STALLED_CYCLES_FRONTEND : attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_STALLED_CYCLES_FRONTEND; break;
+    case perf_counter::STALLED_CYCLES_BACKEND :  attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND; break;
+    case perf_counter::TASK_CLOCK :              attr.type = PERF_TYPE_SOFTWARE; attr.config = PERF_COUNT_SW_TASK_CLOCK; break;
+    case perf_counter::PAGE_FAULTS :             attr.type = PERF_TYPE_SOFTWARE; attr.config = PERF_COUNT_SW_PAGE_FAULTS; break;
+  }
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // user space only, allowed with the default perf_event_paranoid (2)
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return attr;
+}
+
+perf_counter_group::perf_counter_group(uint32_t counter_mask)
+{
+  leader_fds_.fill(-1);
+  fds_.fill(-1);
+
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+    if (!(counter_mask & (1u << i)))
+      continue;
+
+    auto attr = get_event_attr(static_cast<perf_counter>(i));
+    auto& leader_fd = leader_fds_[kernel_group_indices[i]];
+    // this thread, any cpu
+    int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader_fd, PERF_FLAG_FD_CLOEXEC));
+    if (fd < 0) {
+      // ENOENT : not supported by the cpu or the hypervisor, EACCES / EPERM : perf_event_paranoid or seccomp
+      if (error_.empty())
+        error_ = std::string(counter_names[i]) + " : " + std::strerror(errno);
+      continue;
+    }
+    if (::ioctl(fd, PERF_EVENT_IOC_ID, &ids_[i]) != 0) {
+      ::close(fd);
+      continue;
+    }
+    if (leader_fd < 0)
+      leader_fd = fd;
+    fds_[i] = fd;
+    valid_mask_ |= 1u << i;
+  }
+}
+
+void perf_counter_group::reset()
+{
+  for (auto fd : leader_fds_)
+    if (fd >= 0)
+      ::ioctl(fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counter_group::enable()
+{
+  for (auto fd : leader_fds_)
+    if (fd >= 0)
+      ::ioctl(fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counter_group::disable()
+{
+  for (auto fd : leader_fds_)
+    if (fd >= 0)
+      ::ioctl(fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+perf_sample perf_counter_group::read() const
+{
+  // PERF_FORMAT_GROUP layout
+  struct read_format
+  {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    struct { uint64_t value; uint64_t id; } values[PERF_COUNTER_COUNT];
+  };
+
+  perf_sample sample;
+  for (auto leader_fd : leader_fds_) {
+    if (leader_fd < 0)
+      continue;
+    read_format data;
+    if (::read(leader_fd, &data, sizeof(data)) <= 0 || data.time_running == 0)
+      continue;
+
+    // extrapolate if the kernel multiplexed the group with the other users
+    double scale = static_cast<double>(data.time_enabled) / static_cast<double>(data.time_running);
+    for (uint64_t j = 0; j < data.nr && j < PERF_COUNTER_COUNT; j++) {
+      for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (fds_[i] >= 0 && ids_[i] == data.values[j].id) {
+          sample.values[i] = data.time_enabled == data.time_running
+            ? data.values[j].value : static_cast<uint64_t>(data.values[j].value * scale);
+          sample.valid_mask |= 1u << i;
+          break;
+        }
+      }
+    }
+  }
+  return sample;
+}
+
+void perf_counter_group::close()
+{
+  // members before the leaders
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+    if (fds_[i] >= 0 && std::find(leader_fds_.begin(), leader_fds_.end(), fds_[i]) == leader_fds_.end())
+      ::close(fds_[i]);
+  }
+  for (auto fd : leader_fds_)
+    if (fd >= 0)
+      ::close(fd);
+  leader_fds_.fill(-1);
+  fds_.fill(-1);
+  valid_mask_ = 0;
+}
+#else
+perf_counter_group::perf_counter_group(uint32_t)
+{
+  leader_fds_.fill(-1);
+  fds_.fill(-1);
+  error_ = "perf counters are available only on linux";
+}
+
+void perf_counter_group::reset() {}
+void perf_counter_group::enable() {}
+void perf_counter_group::disable() {}
+perf_sample perf_counter_group::read() const { return {}; }
+void perf_counter_group::close() {}
+#endif
+
+perf_counter_group::~perf_counter_group() { close(); }
+
+perf_counter_group::perf_counter_group(perf_counter_group&& other) noexcept
+{
+  leader_fds_.fill(-1);
+  fds_.fill(-1);
+  *this = std::move(other);
+}
+
+perf_counter_group& perf_counter_group::operator=(perf_counter_group&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+  close();
+  leader_fds_ = other.leader_fds_;
+  fds_ = other.fds_;
+  ids_ = other.ids_;
+  valid_mask_ = other.valid_mask_;
+  error_ = std::move(other.error_);
+  other.leader_fds_.fill(-1);
+  other.fds_.fill(-1);
+  other.valid_mask_ = 0;
+  return *this;
+}
+
+// registry ------------------------------------------------------------------
+
+// written by the owner thread, read and cleared by the collector
+struct scope_totals
+{
+  std::atomic<uint64_t> count = 0;
+  std::array<std::atomic<uint64_t>, PERF_COUNTER_COUNT> values{};
+  std::atomic<uint32_t> valid_mask = 0;
+};
+
+struct thread_perf_state
+{
+  perf_counter_group group{ 0 };
+  std::string name;
+  scope_slots<scope_totals> totals;
+};
+
+struct perf_counters_registry
+{
+  std::mutex mutex;
+  scope_names names;
+  std::vector<u_ptr<thread_perf_state>> threads;
+  // totals of the finished threads
+  std::vector<perf_counters::scope_summary> retired_scopes;
+  std::vector<perf_counters::thread_summary> retired_threads;
+};
+
+// leaked, the scopes may be recorded while the static objects are destructed
+static perf_counters_registry& get_registry()
+{
+  static auto* registry = new perf_counters_registry;
+  return *registry;
+}
+
+static void add_to_summary(perf_counters::scope_summary& summary, const scope_totals& totals)
+{
+  summary.count += totals.count.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++)
+    summary.total.values[i] += totals.values[i].load(std::memory_order_relaxed);
+  summary.total.valid_mask |= totals.valid_mask.load(std::memory_order_relaxed);
+}
+
+static void retire_thread(thread_perf_state* state)
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.retired_threads.push_back({ state->name, state->group.read() });
+  for (size_t id = 0; id < registry.names.size(); id++) {
+    if (auto totals = state->totals.find(id); totals)
+      add_to_summary(registry.retired_scopes[id], *totals);
+  }
+  std::erase_if(registry.threads, [state](const auto& thread) { return thread.get() == state; });
+}
+
+static thread_local thread_perf_state* local_state = nullptr;
+static thread_local const perf_counter_group* local_group = nullptr;
+
+static thread_perf_state* get_local_state()
+{
+  if (local_state)
+    return local_state;
+
+  // retires the state at the thread exit
+  static thread_local thread_exit_hook<thread_perf_state> hook;
+  auto state = std::make_unique<thread_perf_state>();
+  // opened by this thread, counts this thread
+  state->group = perf_counter_group();
+  local_state = state.get();
+  local_group = state->group.is_available() ? &state->group : nullptr;
+  hook.state = local_state;
+  hook.on_exit = retire_thread;
+
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threads.emplace_back(std::move(state));
+  return local_state;
+}
+
+perf_counters::scope_id perf_counters::register_scope(const char* name)
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto id = registry.names.add(name);
+  if (id != INVALID_SCOPE_ID && id >= registry.retired_scopes.size())
+    registry.retired_scopes.push_back({ registry.names[id], 0, {} });
+  return id;
+}
+
+const perf_counter_group* perf_counters::get_thread_group()
+{
+  if (!local_state)
+    get_local_state();
+  return local_group;
+}
+
+void perf_counters::set_thread_name(const std::string& name)
+{
+  auto state = get_local_state();
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  state->name = name;
+}
+
+void perf_counters::record(scope_id id, const perf_sample& delta)
+{
+  if (id >= MAX_SCOPE_COUNT)
+    return;
+  auto& totals = get_local_state()->totals.get_or_create(id);
+  totals.count.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++)
+    totals.values[i].fetch_add(delta.values[i], std::memory_order_relaxed);
+  totals.valid_mask.fetch_or(delta.valid_mask, std::memory_order_relaxed);
+}
+
+std::vector<perf_counters::scope_summary> perf_counters::get_scope_summaries()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto summaries = registry.retired_scopes;
+  for (const auto& thread : registry.threads) {
+    for (size_t id = 0; id < registry.names.size(); id++) {
+      if (auto totals = thread->totals.find(id); totals)
+        add_to_summary(summaries[id], *totals);
+    }
+  }
+  std::erase_if(summaries, [](const auto& summary) { return summary.count == 0; });
+  return summaries;
+}
+
+std::vector<perf_counters::thread_summary> perf_counters::get_thread_summaries()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto summaries = registry.retired_threads;
+  // the counters of the other threads can be read from here
+  for (const auto& thread : registry.threads)
+    summaries.push_back({ thread->name, thread->group.read() });
+  return summaries;
+}
+
+void perf_counters::clear()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& summary : registry.retired_scopes) {
+    summary.count = 0;
+    summary.total = {};
+  }
+  registry.retired_threads.clear();
+  for (const auto& thread : registry.threads) {
+    for (size_t id = 0; id < registry.names.size(); id++) {
+      auto totals = thread->totals.find(id);
+      if (!totals)
+        continue;
+      totals->count.store(0, std::memory_order_relaxed);
+      for (auto& value : totals->values)
+        value.store(0, std::memory_order_relaxed);
+      totals->valid_mask.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+const char* perf_counters::get_counter_name(perf_counter counter)
+{ return counter_names[static_cast<size_t>(counter)]; }
+
+// unavailable values are left empty
+static void write_sample(std::ofstream& file, const perf_sample& sample)
+{
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+    file << ',';
+    if (sample.has(static_cast<perf_counter>(i)))
+      file << sample.values[i];
+  }
+  file << ',' << sample.get_ipc() << ',' << sample.get_cache_miss_rate() << ',' << sample.get_branch_miss_rate() << '\n';
+}
+
+bool perf_counters::write_csv(const std::string& path)
+{
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  file << "kind,name,count";
+  for (auto name : counter_names)
+    file << ',' << name;
+  file << ",ipc,cache_miss_rate,branch_miss_rate\n";
+
+  for (const auto& s : get_scope_summaries()) {
+    file << "scope," << s.name << ',' << s.count;
+    write_sample(file, s.total);
+  }
+  for (const auto& t : get_thread_summaries()) {
+    file << "thread," << t.name << ",";
+    write_sample(file, t.total);
+  }
+  return static_cast<bool>(file);
+}
+
+} // namespace hnll::utils
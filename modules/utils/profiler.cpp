@@ -0,0 +1,314 @@
+// hnll
+#include <utils/profiler.hpp>
+#include <utils/common_alias.hpp>
+#include <utils/spsc_ring.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <vector>
+#if defined(HNLL_PROFILE_USE_TSC) && (defined(__x86_64__) || defined(_M_X64))
+#include <x86intrin.h>
+#define HNLL_PROFILE_TSC_AVAILABLE
+#endif
+
+namespace hnll::utils {
+
+struct trace_event
+{
+  const char* name;
+  uint64_t timestamp;
+  double value;
+  trace_event_type type;
+};
+
+struct thread_buffer
+{
+  explicit thread_buffer(uint32_t _tid) : ring(profiler::EVENTS_PER_THREAD), tid(_tid) {}
+
+  // written by the owner thread, read by collect()
+  spsc_ring<trace_event> ring;
+  std::atomic<size_t> dropped_count = 0;
+  std::atomic<bool> finished = false;
+  const uint32_t tid;
+
+  // owner thread only.
+  // recorded begins without their ends, each one keeps a slot of the ring for the end
+  size_t open_count = 0;
+  // nesting depth in a dropped scope, whose events are dropped until its end
+  size_t dropped_depth = 0;
+
+  // guarded by the registry mutex
+  std::string name;
+  std::vector<trace_event> events;
+  // dropped beyond the collected event cap
+  size_t trimmed_count = 0;
+};
+
+struct thread_buffer_registry
+{
+  std::mutex mutex;
+  std::vector<u_ptr<thread_buffer>> buffers;
+  uint32_t next_tid = 0;
+  size_t max_collected_events = profiler::MAX_COLLECTED_EVENTS;
+
+  // for the tick to microsecond conversion
+  const uint64_t origin_ticks = profiler::now();
+  const std::chrono::steady_clock::time_point origin_time = std::chrono::steady_clock::now();
+};
+
+// leaked, thread buffers may be touched while the static objects are destructed
+static thread_buffer_registry& get_registry()
+{
+  static auto* registry = new thread_buffer_registry;
+  return *registry;
+}
+
+// marks the buffer as finished at the thread exit
+struct thread_buffer_holder
+{
+  ~thread_buffer_holder() { if (buffer) buffer->finished.store(true, std::memory_order_release); }
+  thread_buffer* buffer = nullptr;
+};
+
+static thread_local thread_buffer* local_buffer = nullptr;
+
+static thread_buffer* register_thread_buffer()
+{
+  static thread_local thread_buffer_holder holder;
+
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.buffers.emplace_back(std::make_unique<thread_buffer>(registry.next_tid++));
+  local_buffer = registry.buffers.back().get();
+  holder.buffer = local_buffer;
+  return local_buffer;
+}
+
+static thread_buffer* get_thread_buffer()
+{
+  if (local_buffer)
+    return local_buffer;
+  return register_thread_buffer();
+}
+
+uint64_t profiler::now()
+{
+#ifdef HNLL_PROFILE_TSC_AVAILABLE
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// only the owner thread writes
+static void count_dropped(thread_buffer& buffer)
+{ buffer.dropped_count.store(buffer.dropped_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+void profiler::record(trace_event_type type, const char* name, double value)
+{
+  auto buffer = get_thread_buffer();
+  auto timestamp = now();
+
+  // a scope is dropped as a whole, so that the begins and ends in the trace stay balanced
+  if (buffer->dropped_depth > 0) {
+    if (type == trace_event_type::BEGIN)
+      buffer->dropped_depth++;
+    else if (type == trace_event_type::END)
+      buffer->dropped_depth--;
+    count_dropped(*buffer);
+    return;
+  }
+
+  // ends use the slots kept by their begins, the others leave them
+  size_t required = 1;
+  if (type != trace_event_type::END)
+    required += buffer->open_count;
+  if (type == trace_event_type::BEGIN)
+    required++;
+  if (buffer->ring.writable_count() < required) {
+    if (type == trace_event_type::BEGIN)
+      buffer->dropped_depth = 1;
+    count_dropped(*buffer);
+    return;
+  }
+
+  auto span = buffer->ring.prepare_write(1);
+  span[0] = { name, timestamp, value, type };
+  buffer->ring.commit_write(1);
+
+  if (type == trace_event_type::BEGIN)
+    buffer->open_count++;
+  else if (type == trace_event_type::END && buffer->open_count > 0)
+    buffer->open_count--;
+}
+
+void profiler::set_thread_name(const std::string& name)
+{
+  auto buffer = get_thread_buffer();
+  std::lock_guard<std::mutex> lock(get_registry().mutex);
+  buffer->name = name;
+}
+
+// drops the oldest count events except the begins whose ends are kept, so that the trace stays balanced.
+// the registry mutex should be locked
+static void drop_oldest_events(thread_buffer& buffer, size_t count)
+{
+  auto& events = buffer.events;
+  std::vector<trace_event> open_begins;
+  for (size_t i = 0; i < count; i++) {
+    if (events[i].type == trace_event_type::BEGIN)
+      open_begins.emplace_back(events[i]);
+    else if (events[i].type == trace_event_type::END && !open_begins.empty())
+      open_begins.pop_back();
+  }
+  // the kept begins are placed just before the remaining events
+  auto dropped = count - open_begins.size();
+  std::copy(open_begins.begin(), open_begins.end(), events.begin() + dropped);
+  events.erase(events.begin(), events.begin() + dropped);
+  buffer.trimmed_count += dropped;
+}
+
+// the registry mutex should be locked
+static void drain(thread_buffer& buffer, size_t max_events)
+{
+  for (auto events = buffer.ring.peek_read(); !events.empty(); events = buffer.ring.peek_read()) {
+    buffer.events.insert(buffer.events.end(), events.begin(), events.end());
+    buffer.ring.commit_read(events.size());
+  }
+  // trimmed by a quarter at once, not on every collect()
+  if (buffer.events.size() > max_events)
+    drop_oldest_events(buffer, buffer.events.size() - max_events * 3 / 4);
+}
+
+void profiler::collect()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& buffer : registry.buffers)
+    drain(*buffer, registry.max_collected_events);
+}
+
+void profiler::clear()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& buffer : registry.buffers) {
+    drain(*buffer, registry.max_collected_events);
+    buffer->events.clear();
+    buffer->dropped_count.store(0, std::memory_order_relaxed);
+    buffer->trimmed_count = 0;
+  }
+  std::erase_if(registry.buffers, [](const auto& buffer) {
+    return buffer->finished.load(std::memory_order_acquire);
+  });
+}
+
+void profiler::set_max_collected_events(size_t count)
+{
+  assert(count > 0 && "max collected events should be positive.");
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.max_collected_events = count;
+}
+
+size_t profiler::get_event_count()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  size_t count = 0;
+  for (auto& buffer : registry.buffers)
+    count += buffer->events.size();
+  return count;
+}
+
+size_t profiler::get_dropped_count()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  size_t count = 0;
+  for (auto& buffer : registry.buffers)
+    count += buffer->dropped_count.load(std::memory_order_relaxed) + buffer->trimmed_count;
+  return count;
+}
+
+// json ----------------------------------------------------------------------
+
+static void write_json_string(std::ofstream& file, const char* str)
+{
+  file << '"';
+  for (; str && *str; str++) {
+    switch (*str) {
+      case '"'  : file << "\\\""; break;
+      case '\\' : file << "\\\\"; break;
+      case '\n' : file << "\\n"; break;
+      case '\t' : file << "\\t"; break;
+      default   : file << *str; break;
+    }
+  }
+  file << '"';
+}
+
+bool profiler::write_trace(const std::string& path)
+{
+  collect();
+
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  // ticks to microseconds
+#ifdef HNLL_PROFILE_TSC_AVAILABLE
+  // calibrate the tsc frequency with steady_clock over the session
+  auto elapsed_ticks = static_cast<double>(now() - registry.origin_ticks);
+  auto elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.origin_time).count();
+  auto us_per_tick = elapsed_ticks > 0.0 ? elapsed_us / elapsed_ticks : 0.0;
+#else
+  constexpr double us_per_tick = 1e-3;
+#endif
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"honolulu engine\"}}";
+
+  file.setf(std::ios::fixed);
+  file.precision(3);
+  for (auto& buffer : registry.buffers) {
+    if (!buffer->name.empty()) {
+      file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+      write_json_string(file, buffer->name.c_str());
+      file << "}}";
+    }
+
+    for (const auto& event : buffer->events) {
+      auto ticks = event.timestamp - registry.origin_ticks;
+      file << ",\n{\"ph\":";
+      switch (event.type) {
+        case trace_event_type::BEGIN   : file << "\"B\""; break;
+        case trace_event_type::END     : file << "\"E\""; break;
+        case trace_event_type::INSTANT : file << "\"i\",\"s\":\"t\""; break;
+        case trace_event_type::COUNTER : file << "\"C\""; break;
+      }
+      if (event.name) {
+        file << ",\"name\":";
+        write_json_string(file, event.name);
+      }
+      file << ",\"ts\":" << static_cast<double>(ticks) * us_per_tick
+           << ",\"pid\":1,\"tid\":" << buffer->tid;
+      if (event.type == trace_event_type::COUNTER)
+        file << ",\"args\":{\"value\":" << event.value << "}";
+      file << "}";
+    }
+  }
+  file << "\n]}\n";
+  return static_cast<bool>(file);
+}
+
+} // namespace hnll::utils
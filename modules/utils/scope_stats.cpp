@@ -0,0 +1,309 @@
+// hnll
+#include <utils/scope_stats.hpp>
+#include <utils/common_alias.hpp>
+
+// std
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace hnll::utils {
+
+// histogram -----------------------------------------------------------------
+
+size_t latency_histogram::get_bucket_index(uint64_t value)
+{
+  if (value < SUB_BUCKET_COUNT)
+    return value;
+  uint32_t msb = std::bit_width(value) - 1;
+  if (msb >= MAX_VALUE_BITS)
+    return BUCKET_COUNT - 1;
+  // top SUB_BUCKET_BITS + 1 bits select the bucket
+  auto shift = msb - SUB_BUCKET_BITS;
+  auto sub_bucket = (value >> shift) - SUB_BUCKET_COUNT;
+  return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+uint64_t latency_histogram::get_bucket_value(size_t index)
+{
+  if (index < SUB_BUCKET_COUNT)
+    return index;
+  auto shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+  auto sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+  auto lower = (SUB_BUCKET_COUNT + sub_bucket) << shift;
+  return lower + ((uint64_t(1) << shift) >> 1);
+}
+
+static void update_min(std::atomic<uint64_t>& target, uint64_t value)
+{
+  auto current = target.load(std::memory_order_relaxed);
+  while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+static void update_max(std::atomic<uint64_t>& target, uint64_t value)
+{
+  auto current = target.load(std::memory_order_relaxed);
+  while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+void latency_histogram::record(uint64_t value)
+{
+  // only the owner thread writes the sequence
+  auto sequence = sequence_.load(std::memory_order_relaxed);
+  // seq_cst pairs with the swap in drain_into(), either it waits for this record or this record sees the swap
+  sequence_.store(sequence + 1, std::memory_order_seq_cst);
+
+  auto& counts = counts_[active_.load(std::memory_order_seq_cst)];
+  counts.buckets[get_bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+  counts.sum.fetch_add(value, std::memory_order_relaxed);
+  update_min(counts.min, value);
+  update_max(counts.max, value);
+
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void latency_histogram::drain_into(histogram_snapshot& snapshot)
+{
+  auto drained = active_.exchange(active_.load(std::memory_order_relaxed) ^ 1, std::memory_order_seq_cst);
+
+  // wait for the record in progress, which may still write the drained counts
+  if (auto sequence = sequence_.load(std::memory_order_seq_cst); sequence & 1) {
+    while (sequence_.load(std::memory_order_acquire) == sequence)
+      std::this_thread::yield();
+  }
+
+  // the owner doesn't touch the drained counts until the next swap
+  auto& counts = counts_[drained];
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    auto count = counts.buckets[i].load(std::memory_order_relaxed);
+    if (count == 0)
+      continue;
+    counts.buckets[i].store(0, std::memory_order_relaxed);
+    snapshot.buckets[i] += count;
+    snapshot.count += count;
+  }
+  snapshot.sum += counts.sum.exchange(0, std::memory_order_relaxed);
+  snapshot.min = std::min(snapshot.min, counts.min.exchange(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed));
+  snapshot.max = std::max(snapshot.max, counts.max.exchange(0, std::memory_order_relaxed));
+}
+
+void histogram_snapshot::merge(const histogram_snapshot& other)
+{
+  for (size_t i = 0; i < buckets.size(); i++)
+    buckets[i] += other.buckets[i];
+  count += other.count;
+  sum += other.sum;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+}
+
+uint64_t histogram_snapshot::get_percentile(double percentile) const
+{
+  if (count == 0)
+    return 0;
+  auto target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)));
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    cumulative += buckets[i];
+    if (cumulative >= target)
+      return std::clamp(latency_histogram::get_bucket_value(i), min, max);
+  }
+  return max;
+}
+
+// registry ------------------------------------------------------------------
+
+struct thread_histograms
+{
+  scope_slots<latency_histogram> histograms;
+  std::atomic<bool> finished = false;
+};
+
+struct scope_stats_registry
+{
+  std::mutex mutex;
+  scope_names names;
+  std::vector<u_ptr<thread_histograms>> threads;
+  // reused by summarize()
+  std::vector<histogram_snapshot> window;
+  std::atomic<uint32_t> frame_window = scope_stats::DEFAULT_FRAME_WINDOW;
+  uint32_t frame_count = 0;
+
+  std::mutex summary_mutex;
+  std::vector<scope_stats::summary> summaries;
+};
+
+// leaked, histograms may be touched while the static objects are destructed
+static scope_stats_registry& get_registry()
+{
+  static auto* registry = new scope_stats_registry;
+  return *registry;
+}
+
+static thread_local thread_histograms* local_histograms = nullptr;
+
+static thread_histograms* register_thread_histograms()
+{
+  // marks the histograms as finished at the thread exit
+  static thread_local thread_exit_hook<thread_histograms> hook;
+
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threads.emplace_back(std::make_unique<thread_histograms>());
+  local_histograms = registry.threads.back().get();
+  hook.state = local_histograms;
+  hook.on_exit = [](thread_histograms* histograms) { histograms->finished.store(true, std::memory_order_release); };
+  return local_histograms;
+}
+
+scope_stats::scope_id scope_stats::register_scope(const char* name)
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto id = registry.names.add(name);
+  if (id != INVALID_SCOPE_ID && id >= registry.window.size())
+    registry.window.emplace_back();
+  return id;
+}
+
+void scope_stats::record(scope_id id, uint64_t nanoseconds)
+{
+  if (id >= MAX_SCOPE_COUNT)
+    return;
+  auto histograms = local_histograms ? local_histograms : register_thread_histograms();
+  histograms->histograms.get_or_create(id).record(nanoseconds);
+}
+
+void scope_stats::end_frame()
+{
+  auto& registry = get_registry();
+  // frame_count is touched only by the frame loop
+  if (++registry.frame_count < registry.frame_window.load(std::memory_order_relaxed))
+    return;
+  registry.frame_count = 0;
+  summarize();
+}
+
+void scope_stats::set_frame_window(uint32_t frame_window)
+{
+  assert(frame_window > 0 && "frame window should be positive.");
+  get_registry().frame_window.store(frame_window, std::memory_order_relaxed);
+}
+
+void scope_stats::summarize()
+{
+  auto& registry = get_registry();
+  std::vector<summary> summaries;
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& snapshot : registry.window)
+      snapshot = {};
+
+    std::erase_if(registry.threads, [&registry](const auto& thread) {
+      // check before draining, the thread may record until it finishes
+      bool finished = thread->finished.load(std::memory_order_acquire);
+      for (size_t id = 0; id < registry.names.size(); id++) {
+        if (auto histogram = thread->histograms.find(id); histogram)
+          histogram->drain_into(registry.window[id]);
+      }
+      // the last values of the finished threads are drained
+      return finished;
+    });
+
+    constexpr double ns_to_us = 1e-3;
+    for (size_t id = 0; id < registry.names.size(); id++) {
+      const auto& snapshot = registry.window[id];
+      if (snapshot.count == 0)
+        continue;
+      summaries.push_back({
+        registry.names[id],
+        snapshot.count,
+        snapshot.min * ns_to_us,
+        snapshot.get_mean() * ns_to_us,
+        snapshot.get_percentile(50.0) * ns_to_us,
+        snapshot.get_percentile(99.0) * ns_to_us,
+        snapshot.max * ns_to_us
+      });
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(registry.summary_mutex);
+  registry.summaries = std::move(summaries);
+}
+
+std::vector<scope_stats::summary> scope_stats::get_summaries()
+{
+  auto& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.summary_mutex);
+  return registry.summaries;
+}
+
+// output --------------------------------------------------------------------
+
+static void write_json_string(std::ofstream& file, const std::string& str)
+{
+  file << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"'  : file << "\\\""; break;
+      case '\\' : file << "\\\\"; break;
+      case '\n' : file << "\\n"; break;
+      case '\t' : file << "\\t"; break;
+      default   :
+        // the other control characters
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+          file << escaped;
+        }
+        else
+          file << c;
+        break;
+    }
+  }
+  file << '"';
+}
+
+bool scope_stats::write_csv(const std::string& path)
+{
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  file << "name,count,min_us,mean_us,p50_us,p99_us,max_us\n";
+  for (const auto& s : get_summaries()) {
+    file << s.name << ',' << s.count << ',' << s.min << ',' << s.mean << ','
+         << s.p50 << ',' << s.p99 << ',' << s.max << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+bool scope_stats::write_json(const std::string& path)
+{
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  file << "{\"frame_window\":" << get_registry().frame_window.load(std::memory_order_relaxed) << ",\"scopes\":[";
+  bool first = true;
+  for (const auto& s : get_summaries()) {
+    file << (first ? "\n" : ",\n");
+    first = false;
+    file << "{\"name\":";
+    write_json_string(file, s.name);
+    file << ",\"count\":" << s.count
+         << ",\"min_us\":" << s.min << ",\"mean_us\":" << s.mean
+         << ",\"p50_us\":" << s.p50 << ",\"p99_us\":" << s.p99
+         << ",\"max_us\":" << s.max << "}";
+  }
+  file << "\n]}\n";
+  return static_cast<bool>(file);
+}
+
+} // namespace hnll::utils
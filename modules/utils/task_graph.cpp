@@ -0,0 +1,110 @@
+#include <utils/task_graph.hpp>
+
+// std
+#include <stdexcept>
+
+namespace hnll::utils {
+
+void task_graph::add_dependency(task_id predecessor, task_id successor)
+{
+  assert(predecessor < nodes_.size() && successor < nodes_.size() && "invalid task id.");
+  assert(predecessor != successor && "a task can't depend on itself.");
+  nodes_[predecessor]->successors.emplace_back(successor);
+  nodes_[successor]->predecessor_count++;
+  dirty_ = true;
+}
+
+void task_graph::clear()
+{
+  nodes_.clear();
+  roots_.clear();
+  dirty_ = true;
+}
+
+void task_graph::validate()
+{
+  roots_.clear();
+  for (task_id id = 0; id < nodes_.size(); id++) {
+    if (nodes_[id]->predecessor_count == 0)
+      roots_.emplace_back(id);
+  }
+
+  // kahn's algorithm, every task should be reached from the roots
+  std::vector<uint32_t> in_degrees(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); i++)
+    in_degrees[i] = nodes_[i]->predecessor_count;
+
+  auto stack = roots_;
+  size_t visited_count = 0;
+  while (!stack.empty()) {
+    auto id = stack.back();
+    stack.pop_back();
+    visited_count++;
+    for (auto successor : nodes_[id]->successors) {
+      if (--in_degrees[successor] == 0)
+        stack.emplace_back(successor);
+    }
+  }
+  if (visited_count != nodes_.size())
+    throw std::runtime_error("task_graph has a cycle.");
+
+  dirty_ = false;
+}
+
+void task_graph::run(thread_pool& pool)
+{
+  if (nodes_.empty())
+    return;
+  if (dirty_)
+    validate();
+
+  context_->reset();
+  for (auto& n : nodes_)
+    n->pending_count.store(n->predecessor_count, std::memory_order_relaxed);
+  // each task finishes one pending count
+  context_->add_pending(static_cast<uint32_t>(nodes_.size()));
+
+  for (auto root : roots_)
+    spawn_task(pool, root);
+
+  context_->wait(pool);
+}
+
+void task_graph::spawn_task(thread_pool& pool, task_id id)
+{
+  // copy the context, it should outlive the graph until the last notification
+  pool.spawn([this, &pool, id, context = context_]() { run_task(pool, id); });
+}
+
+void task_graph::run_task(thread_pool& pool, task_id id)
+{
+  // keep running the ready successors on this thread
+  while (true) {
+    auto& current = *nodes_[id];
+    try { current.func(); }
+    catch (...) { context_->set_exception(std::current_exception()); }
+
+    bool has_next = false;
+    task_id next = 0;
+    for (auto successor : current.successors) {
+      if (nodes_[successor]->pending_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        continue;
+      if (!has_next) {
+        has_next = true;
+        next = successor;
+      }
+      else {
+        spawn_task(pool, successor);
+      }
+    }
+
+    // the graph may be destroyed once the last task finishes, don't touch members after that.
+    // the context itself is kept alive by the spawned lambda.
+    context_->finish_pending();
+    if (!has_next)
+      return;
+    id = next;
+  }
+}
+
+} // namespace hnll::utils
@@ -1,94 +1,294 @@
 #include <utils/thread_pool.hpp>
+#include <utils/profiler.hpp>
+#include <utils/perf_counters.hpp>
+
+// std
+#include <string>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace hnll::utils {
 
-thread_local mt_deque<function_wrapper>* thread_pool::local_queue_{};
+// try this many times before parking, keeps wake latency low for bursty submissions
+constexpr int SPIN_COUNT = 64;
+
+thread_local ws_deque<task_node*>* thread_pool::local_queue_{};
 thread_local unsigned thread_pool::queue_index_{};
+thread_local unsigned thread_pool::lane_index_{};
+thread_local thread_pool* thread_pool::current_pool_{};
+
+// affinity, nice and scheduling policy of the calling thread
+static void apply_lane_config(const lane_config& config)
+{
+#ifdef __linux__
+  if (!config.cpu_ids.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (auto id : config.cpu_ids)
+      CPU_SET(id, &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  }
+  if (config.fifo_priority > 0) {
+    sched_param param{};
+    param.sched_priority = config.fifo_priority;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  }
+  // nice is per thread on linux
+  else if (config.nice != 0) {
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), config.nice);
+  }
+#endif
+}
+
+// shown by debuggers, top -H and the trace profiler
+static void set_worker_name(unsigned queue_index, unsigned lane_index)
+{
+  [[maybe_unused]] static constexpr const char* lane_names[] = { "realtime", "frame", "background" };
+#ifdef __linux__
+  static constexpr const char* short_lane_names[] = { "rt", "frame", "bg" };
+  // linux limits thread names to 15 characters, e.g. "hnll-frame-2"
+  auto os_name = "hnll-" + std::string(short_lane_names[lane_index]) + "-" + std::to_string(queue_index);
+  pthread_setname_np(pthread_self(), os_name.substr(0, 15).c_str());
+#endif
+  HNLL_PROFILE_THREAD_NAME(std::string(lane_names[lane_index]) + " worker " + std::to_string(queue_index));
+  // opens the counters of the worker, the totals are reported per worker
+  HNLL_PERF_THREAD_NAME(std::string(lane_names[lane_index]) + " worker " + std::to_string(queue_index));
+}
 
 thread_pool::thread_pool(int _thread_count) : done_(false), joiner_(threads_)
 {
-  // init worker threads
   const auto thread_count = _thread_count == 0 ?
     std::thread::hardware_concurrency() : _thread_count;
+
+  lane_configs configs;
+  configs[static_cast<size_t>(task_priority::FRAME)].worker_count = thread_count;
+  init(configs);
+}
+
+thread_pool::thread_pool(const lane_configs& configs) : done_(false), joiner_(threads_)
+{ init(configs); }
+
+void thread_pool::init(const lane_configs& configs)
+{
+  unsigned thread_count = 0;
+  for (size_t i = 0; i < LANE_COUNT; i++) {
+    lanes_[i] = std::make_unique<lane>();
+    lanes_[i]->first_worker = thread_count;
+    lanes_[i]->worker_count = configs[i].worker_count;
+    thread_count += configs[i].worker_count;
+  }
+  assert(thread_count > 0 && "thread_pool needs at least one worker.");
+
+  // a lane without workers hands its tasks to the FRAME lane, or the first lane with workers
+  unsigned fallback_lane = static_cast<unsigned>(task_priority::FRAME);
+  for (unsigned i = 0; lanes_[fallback_lane]->worker_count == 0 && i < LANE_COUNT; i++)
+    fallback_lane = i;
+  for (unsigned i = 0; i < LANE_COUNT; i++)
+    lane_map_[i] = lanes_[i]->worker_count > 0 ? i : fallback_lane;
+
   try {
-    for (int i = 0; i < thread_count; i++) {
+    for (unsigned i = 0; i < thread_count; i++) {
       // create local queues and threads
-      local_queues_.emplace_back(std::make_unique<mt_deque<function_wrapper>>());
+      local_queues_.emplace_back(std::make_unique<ws_deque<task_node*>>());
     }
     // wait until all the queues are constructed
-    for (int i = 0; i < thread_count; i++) {
-      threads_.emplace_back(&thread_pool::worker_thread, this, i);
+    for (unsigned lane_index = 0; lane_index < LANE_COUNT; lane_index++) {
+      const auto& lane = *lanes_[lane_index];
+      for (unsigned i = 0; i < lane.worker_count; i++) {
+        threads_.emplace_back(&thread_pool::worker_thread, this, lane.first_worker + i, lane_index, configs[lane_index]);
+      }
     }
   }
   catch (...) {
     // clean up all the threads before throwing an exception
-    done_ = true;
+    wake_all_workers();
     throw;
   }
 }
 
 thread_pool::~thread_pool()
 {
-  done_ = true;
-  // joiner_ joins all the worker threads
+  wake_all_workers();
+  for (auto& thread : threads_) {
+    if (thread.joinable())
+      thread.join();
+  }
+
+  // queues hold raw ptrs, so release the remaining tasks manually
+  for (auto& lane : lanes_) {
+    while (auto task = lane->global_queue.try_pop_front())
+      pool_delete(task);
+  }
+  for (auto& local_queue : local_queues_) {
+    while (auto task = local_queue->steal())
+      pool_delete(*task);
+  }
 }
 
-void thread_pool::run_pending_task()
+void thread_pool::push_task(function_wrapper&& task, unsigned lane_index)
 {
-  if (auto task = try_pop_from_local_queue(); task)
-    (*task)();
-  else if (task = try_pop_from_global_queue(); task)
-    (*task)();
-  else if (task = try_steal_task(); task)
-    (*task)();
-  else
-    std::this_thread::yield();
+  outstanding_count_.fetch_add(1, std::memory_order_relaxed);
+  auto node = pool_new<task_node>(std::move(task));
+  auto& target_lane = *lanes_[lane_index];
+  if (is_worker_thread() && lane_index == lane_index_) {
+    local_queue_->push(node);
+  }
+    // main thread and workers of the other lanes don't have a local queue of this lane
+  else {
+    target_lane.global_queue.push_tail(node);
+  }
+  notify_task_pushed(target_lane);
+}
+
+bool thread_pool::run_pending_task()
+{
+  auto task = try_pop_from_local_queue();
+  if (!task)
+    task = try_pop_from_global_queue();
+  if (!task)
+    task = try_steal_task();
+  if (!task)
+    return false;
+
+  task->task();
+  pool_delete(task);
+  notify_task_finished();
+  return true;
 }
 
 void thread_pool::wait_for_all_tasks()
 {
-  while (1) {
-    bool local_tasks_finished = true;
-    for (const auto& local_queue : local_queues_) {
-      local_tasks_finished &= local_queue->empty();
-    }
-    if (global_queue_.empty() && local_tasks_finished)
-      return;
+  assert(!is_worker_thread() && "wait_for_all_tasks() would wait for the calling task itself.");
+  // futex wait until the counter reaches zero
+  for (auto count = outstanding_count_.load(std::memory_order_acquire);
+       count != 0;
+       count = outstanding_count_.load(std::memory_order_acquire)) {
+    outstanding_count_.wait(count, std::memory_order_acquire);
   }
 }
 
-void thread_pool::worker_thread(unsigned int queue_index)
+void thread_pool::worker_thread(unsigned int queue_index, unsigned int lane_index, lane_config config)
 {
+  apply_lane_config(config);
+  set_worker_name(queue_index, lane_index);
+
   queue_index_ = queue_index;
+  lane_index_ = lane_index;
   // take local queue ptr
   assert(queue_index <= local_queues_.size() - 1);
   local_queue_ = local_queues_[queue_index_].get();
+  current_pool_ = this;
 
+  auto& own_lane = *lanes_[lane_index];
+  int idle_count = 0;
   while (!done_) {
-    run_pending_task();
+    if (run_pending_task()) {
+      idle_count = 0;
+    }
+    else if (++idle_count < SPIN_COUNT) {
+      std::this_thread::yield();
+    }
+    else {
+      park(own_lane);
+      idle_count = 0;
+    }
+  }
+}
+
+void thread_pool::park(lane& lane)
+{
+  const auto epoch = lane.epoch.load();
+  // announce parking before the last check, so that submitters see this worker
+  lane.parked_count.fetch_add(1);
+
+  bool has_task = !lane.global_queue.empty();
+  for (unsigned i = 0; i < lane.worker_count; i++) {
+    has_task |= !local_queues_[lane.first_worker + i]->empty();
+  }
+
+  // a task pushed after the check bumps the epoch, so wait() returns immediately
+  if (!has_task && !done_)
+    lane.epoch.wait(epoch);
+
+  lane.parked_count.fetch_sub(1);
+}
+
+void thread_pool::notify_task_pushed(lane& lane)
+{
+  lane.epoch.fetch_add(1);
+  // targeted wake up, skip the syscall if no one is parked
+  if (lane.parked_count.load() > 0)
+    lane.epoch.notify_one();
+}
+
+void thread_pool::notify_task_finished()
+{
+  if (outstanding_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    outstanding_count_.notify_all();
+}
+
+void thread_pool::wake_all_workers()
+{
+  done_ = true;
+  for (auto& lane : lanes_) {
+    lane->epoch.fetch_add(1);
+    lane->epoch.notify_all();
   }
 }
 
-u_ptr<function_wrapper> thread_pool::try_pop_from_local_queue()
-{ return local_queue_ ? local_queue_->try_pop_front() : nullptr; }
+task_node* thread_pool::try_pop_from_local_queue()
+{
+  if (!is_worker_thread())
+    return nullptr;
 
-u_ptr<function_wrapper> thread_pool::try_pop_from_global_queue()
-{ return global_queue_.try_pop_front(); }
+  auto task = local_queue_->pop();
+  return task ? *task : nullptr;
+}
 
-u_ptr<function_wrapper> thread_pool::try_steal_task()
+task_node* thread_pool::try_pop_from_global_queue()
 {
-  u_ptr<function_wrapper> ret;
+  if (is_worker_thread())
+    return lanes_[lane_index_]->global_queue.try_pop_front();
 
-  for (unsigned i = 0; i < local_queues_.size() - 1; i++) {
-    // not to look the first queue every time
-    auto idx = (queue_index_ + i + 1) % local_queues_.size();
+  // other threads take the most urgent task
+  for (unsigned lane_index = 0; lane_index < LANE_COUNT; lane_index++) {
+    if (!is_helped_lane(lane_index))
+      continue;
+    if (auto task = lanes_[lane_index]->global_queue.try_pop_front(); task)
+      return task;
+  }
+  return nullptr;
+}
 
-    if (ret = local_queues_[idx]->try_pop_back(); ret) {
-      return std::move(ret);
+task_node* thread_pool::try_steal_task()
+{
+  // worker threads look the other queues of the same lane
+  if (is_worker_thread()) {
+    const auto& own_lane = *lanes_[lane_index_];
+    for (unsigned i = 1; i < own_lane.worker_count; i++) {
+      // not to look the first queue every time
+      auto idx = own_lane.first_worker + (queue_index_ - own_lane.first_worker + i) % own_lane.worker_count;
+      if (auto task = local_queues_[idx]->steal(); task)
+        return *task;
     }
+    return nullptr;
   }
 
+  for (unsigned lane_index = 0; lane_index < LANE_COUNT; lane_index++) {
+    if (!is_helped_lane(lane_index))
+      continue;
+    const auto& lane = *lanes_[lane_index];
+    for (unsigned i = 0; i < lane.worker_count; i++) {
+      if (auto task = local_queues_[lane.first_worker + i]->steal(); task)
+        return *task;
+    }
+  }
   return nullptr;
 }
 
-} // namespace hnll::utils
\ No newline at end of file
+} // namespace hnll::utils
@@ -2,9 +2,9 @@
 #include <utils/utils.hpp>
 
 // std
+#include <cerrno>
 #include <filesystem>
 #include <sys/stat.h>
-#include <fstream>
 
 namespace hnll::utils {
 
@@ -31,7 +31,8 @@ void mkdir_p(const std::string& _dir_name)
   if (stat(_dir_name.c_str(), &buffer) == 0)
     return;
   else {
-    if (mkdir(_dir_name.c_str(), 0777) != 0)
+    // another process may have created it in the meantime
+    if (mkdir(_dir_name.c_str(), 0777) != 0 && errno != EEXIST)
       throw std::runtime_error("failed to make directory : " + _dir_name);
   }
 }
@@ -53,23 +54,10 @@ std::string create_sub_cache_directory(const std::string& _dir_name)
   return cache_directory;
 }
 
-std::vector<char> read_file_for_shader(const std::string& filepath)
+mapped_file read_file_for_shader(const std::string& filepath)
 {
-  // construct and open
-  // immediately read as binary
-  std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-
-  if (!file.is_open())
-    throw std::runtime_error("failed to open file: " + filepath);
-
-  size_t file_size = static_cast<size_t>(file.tellg());
-  std::vector<char> buffer(file_size);
-
-  file.seekg(0);
-  file.read(buffer.data(), file_size);
-  file.close();
-
-  return buffer;
+  // the module is created right after, so read ahead now
+  return mapped_file(filepath, mapped_file::access_hint::WILL_NEED);
 }
 
 // 3d transformation ---------------------------------------------------------------
@@ -0,0 +1,252 @@
+// hnll
+#include <geometry/bvh.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/intersection.hpp>
+#include <geometry/he_mesh.hpp>
+#include <utils/thread_pool.hpp>
+#include "grid_mesh.hpp"
+#include "random_volumes.hpp"
+
+// std
+#include <algorithm>
+#include <random>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll::geometry {
+
+// random triangles of various sizes in a 10^3 box
+static void create_triangles(int count, std::vector<vec3d>& positions, std::vector<vertex_id>& indices)
+{
+  std::mt19937 engine(7);
+  std::uniform_real_distribution<double> center(-5.0, 5.0);
+  std::uniform_real_distribution<double> offset(-0.5, 0.5);
+  for (int i = 0; i < count; i++) {
+    vec3d c = { center(engine), center(engine), center(engine) };
+    double scale = i % 16 == 0 ? 4.0 : 1.0;
+    for (int j = 0; j < 3; j++) {
+      indices.emplace_back(static_cast<vertex_id>(positions.size()));
+      positions.emplace_back(c + scale * vec3d{ offset(engine), offset(engine), offset(engine) });
+    }
+  }
+}
+
+static std::vector<const bounding_volume*> get_pointers(const std::vector<u_ptr<bounding_volume>>& volumes)
+{
+  std::vector<const bounding_volume*> ret;
+  for (const auto& v : volumes)
+    ret.emplace_back(v.get());
+  return ret;
+}
+
+// plane intersection and the inside test on the edges
+static bool reference_intersect(const ray& r, const vec3d& a, const vec3d& b, const vec3d& c, double& t)
+{
+  vec3d n = (b - a).cross(c - a);
+  double denom = n.dot(r.direction);
+  if (std::abs(denom) < 1e-12)
+    return false;
+  t = n.dot(a - r.origin) / denom;
+  if (t < 0.0)
+    return false;
+  vec3d p = r.origin + t * r.direction;
+  return n.dot((b - a).cross(p - a)) >= 0.0 && n.dot((c - b).cross(p - b)) >= 0.0 && n.dot((a - c).cross(p - c)) >= 0.0;
+}
+
+static void expect_valid_nodes(const bvh& tree)
+{
+  const auto nodes = tree.get_nodes();
+  ASSERT_FALSE(nodes.empty());
+  std::vector<int> visited(tree.get_primitive_count(), 0);
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    const auto& n = nodes[i];
+    EXPECT_TRUE((n.min.array() <= n.max.array()).all());
+    if (n.is_leaf()) {
+      EXPECT_LE(n.count, bvh::MAX_LEAF_SIZE * 8);
+      for (uint32_t p = n.offset; p < n.offset + n.count; p++)
+        visited[p]++;
+      continue;
+    }
+    // the first child follows its parent, and the children are contained
+    ASSERT_LT(n.offset, nodes.size());
+    for (auto child : { i + 1, n.offset }) {
+      EXPECT_TRUE((n.min.array() <= nodes[child].min.array()).all());
+      EXPECT_TRUE((nodes[child].max.array() <= n.max.array()).all());
+    }
+  }
+  // every primitive belongs to exactly one leaf
+  EXPECT_TRUE(std::ranges::all_of(visited, [](int v) { return v == 1; }));
+}
+
+TEST(bvh, triangle_ray)
+{
+  std::vector<vec3d> positions;
+  std::vector<vertex_id> indices;
+  create_triangles(2000, positions, indices);
+  auto tree = bvh::create(positions, indices);
+  expect_valid_nodes(*tree);
+  EXPECT_EQ(tree->get_primitive_count(), 2000);
+
+  std::mt19937 engine(11);
+  std::uniform_real_distribution<double> dist(-8.0, 8.0);
+  int hit_count = 0;
+  for (int i = 0; i < 500; i++) {
+    ray r = { { dist(engine), dist(engine), dist(engine) }, { dist(engine), dist(engine), dist(engine) } };
+    double expected_t = std::numeric_limits<double>::infinity();
+    uint32_t expected = NULL_ID;
+    for (uint32_t tri = 0; tri < indices.size() / 3; tri++) {
+      double t;
+      if (reference_intersect(r, positions[indices[tri * 3]], positions[indices[tri * 3 + 1]], positions[indices[tri * 3 + 2]], t) && t < expected_t) {
+        expected_t = t;
+        expected = tri;
+      }
+    }
+
+    auto hit = tree->intersect(r);
+    ASSERT_EQ(hit.primitive, expected) << "ray " << i;
+    if (hit.is_hit()) {
+      hit_count++;
+      EXPECT_NEAR(hit.t, expected_t, 1e-9);
+      // barycentric coordinates reproduce the hit point
+      const auto& a = positions[indices[hit.primitive * 3]];
+      const auto& b = positions[indices[hit.primitive * 3 + 1]];
+      const auto& c = positions[indices[hit.primitive * 3 + 2]];
+      vec3d p = (1.0 - hit.u - hit.v) * a + hit.u * b + hit.v * c;
+      EXPECT_LT((p - (r.origin + hit.t * r.direction)).norm(), 1e-9);
+      // t_max clips the hit
+      EXPECT_FALSE(tree->intersect(r, hit.t * 0.5).is_hit() && expected_t >= hit.t * 0.5);
+    }
+  }
+  EXPECT_GT(hit_count, 0);
+}
+
+TEST(bvh, triangle_query)
+{
+  std::vector<vec3d> positions;
+  std::vector<vertex_id> indices;
+  create_triangles(2000, positions, indices);
+  auto tree = bvh::create(positions, indices);
+
+  std::mt19937 engine(13);
+  auto volumes = create_volumes(200, engine);
+  for (const auto& volume : volumes) {
+    std::vector<uint32_t> result;
+    tree->query(*volume, result);
+    std::ranges::sort(result);
+    EXPECT_EQ(std::ranges::adjacent_find(result), result.end());
+
+    vec3d radius = volume->is_sphere() ? vec3d::Constant(volume->get_sphere_radius()) : volume->get_aabb_radius();
+    vec3d center = volume->get_world_center_point();
+    for (uint32_t tri = 0; tri < indices.size() / 3; tri++) {
+      bool reported = std::ranges::binary_search(result, tri);
+      // a vertex inside the volume is an intersection
+      bool contains_vertex = false;
+      vec3d min = positions[indices[tri * 3]], max = min;
+      for (int j = 0; j < 3; j++) {
+        const auto& p = positions[indices[tri * 3 + j]];
+        min = min.cwiseMin(p);
+        max = max.cwiseMax(p);
+        if (volume->is_sphere())
+          contains_vertex |= (p - center).norm() <= volume->get_sphere_radius();
+        else
+          contains_vertex |= ((p - center).cwiseAbs().array() <= radius.array()).all();
+      }
+      if (contains_vertex) {
+        EXPECT_TRUE(reported);
+      }
+      // apart from the bounding box is not
+      if (((max - (center - radius)).array() < 0.0).any() || (((center + radius) - min).array() < 0.0).any()) {
+        EXPECT_FALSE(reported);
+      }
+    }
+  }
+}
+
+TEST(bvh, volume_query_and_refit)
+{
+  std::mt19937 engine(17);
+  auto volumes = create_volumes(1000, engine);
+  auto pointers = get_pointers(volumes);
+  auto tree = bvh::create(pointers);
+  expect_valid_nodes(*tree);
+
+  auto expect_same_as_brute_force = [&]() {
+    for (const auto& volume : volumes) {
+      std::vector<uint32_t> result;
+      tree->query(*volume, result);
+      std::ranges::sort(result);
+      std::vector<uint32_t> expected;
+      for (uint32_t i = 0; i < volumes.size(); i++)
+        if (intersection::test_bv_intersection(*volume, *volumes[i]) > 0)
+          expected.emplace_back(i);
+      ASSERT_EQ(result, expected);
+    }
+  };
+  expect_same_as_brute_force();
+
+  // move the volumes, and follow them without rebuilding
+  std::uniform_real_distribution<double> step(-1.0, 1.0);
+  for (auto& volume : volumes)
+    volume->set_center_point(volume->get_local_center_point() + vec3d{ step(engine), step(engine), step(engine) });
+  tree->refit();
+  expect_valid_nodes(*tree);
+  expect_same_as_brute_force();
+
+  // rays hit the spheres
+  const auto& sphere = *volumes[0];
+  ray r = { sphere.get_world_center_point() + vec3d{ 20.0, 0.0, 0.0 }, { -1.0, 0.0, 0.0 } };
+  auto hit = tree->intersect(r);
+  ASSERT_TRUE(hit.is_hit());
+  EXPECT_LE(hit.t, 20.0 - sphere.get_sphere_radius() + 1e-9);
+}
+
+TEST(bvh, parallel_build)
+{
+  std::vector<vec3d> positions;
+  std::vector<vertex_id> indices;
+  // large enough to bin and build the subtrees in parallel
+  create_triangles(40000, positions, indices);
+  auto serial = bvh::create(positions, indices);
+
+  for (int thread_count : { 1, 4 }) {
+    utils::thread_pool pool(thread_count);
+    auto tree = bvh::create(positions, indices, &pool);
+    ASSERT_EQ(tree->get_node_count(), serial->get_node_count());
+    EXPECT_EQ(tree->get_depth(), serial->get_depth());
+    EXPECT_TRUE(std::ranges::equal(tree->get_primitive_ids(), serial->get_primitive_ids()));
+    for (size_t i = 0; i < tree->get_node_count(); i++) {
+      const auto& a = tree->get_nodes()[i];
+      const auto& b = serial->get_nodes()[i];
+      EXPECT_EQ(a.min, b.min);
+      EXPECT_EQ(a.max, b.max);
+      EXPECT_EQ(a.offset, b.offset);
+      EXPECT_EQ(a.count, b.count);
+    }
+  }
+}
+
+TEST(bvh, he_mesh)
+{
+  const int n = 8;
+  auto grid = create_grid(n);
+  auto mesh = he_mesh::create();
+  std::vector<vertex> vertices;
+  for (vertex_id v = 0; v < grid.positions.size(); v++)
+    vertices.emplace_back(grid.positions[v], v);
+  for (auto& v : vertices)
+    mesh->add_vertex(v);
+  face_id f_id = 0;
+  for (const auto& t : grid.triangles)
+    mesh->add_face(mesh->get_vertex_r(t[0]), mesh->get_vertex_r(t[1]), mesh->get_vertex_r(t[2]), f_id++);
+
+  auto tree = bvh::create(*mesh);
+  EXPECT_EQ(tree->get_primitive_count(), mesh->get_face_count());
+  // lower right triangle of the cell (2, 3)
+  auto hit = tree->intersect({ { 2.75, 3.25, 1.0 }, { 0.0, 0.0, -1.0 } });
+  ASSERT_TRUE(hit.is_hit());
+  EXPECT_EQ(hit.primitive, (2 + 3 * n) * 2);
+  EXPECT_DOUBLE_EQ(hit.t, 1.0);
+}
+
+} // namespace hnll::geometry
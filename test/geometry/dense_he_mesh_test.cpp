@@ -0,0 +1,116 @@
+// hnll
+#include <geometry/dense_he_mesh.hpp>
+#include <geometry/he_mesh.hpp>
+#include "grid_mesh.hpp"
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll::geometry {
+
+static void check_consistency(const dense_he_mesh& mesh)
+{
+  for (half_edge_id he = 0; he < mesh.get_half_edge_count(); he++) {
+    EXPECT_EQ(mesh.get_he_next(mesh.get_he_next(mesh.get_he_next(he))), he);
+    EXPECT_EQ(mesh.get_he_next(mesh.get_he_prev(he)), he);
+    EXPECT_EQ(mesh.get_he_face(he), he / 3);
+    if (!mesh.is_boundary(he)) {
+      auto pair = mesh.get_he_pair(he);
+      EXPECT_EQ(mesh.get_he_pair(pair), he);
+      EXPECT_EQ(mesh.get_he_vertex(pair), mesh.get_he_target(he));
+      EXPECT_EQ(mesh.get_he_target(pair), mesh.get_he_vertex(he));
+    }
+  }
+  for (vertex_id v = 0; v < mesh.get_vertex_count(); v++) {
+    auto he = mesh.get_vertex_he(v);
+    if (he != NULL_ID) {
+      EXPECT_EQ(mesh.get_he_vertex(he), v);
+    }
+  }
+}
+
+TEST(dense_he_mesh, quad)
+{
+  /*
+   *  v0 - v2
+   *   | /  |
+   *  v1 - v3
+   */
+  std::vector<vec3d> positions = { { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 }, { 1, 1, 0 } };
+  auto mesh = dense_he_mesh::create(std::move(positions), {}, { 0, 1, 2, 1, 3, 2 });
+
+  EXPECT_EQ(mesh->get_vertex_count(), 4);
+  EXPECT_EQ(mesh->get_face_count(), 2);
+  EXPECT_EQ(mesh->get_half_edge_count(), 6);
+  EXPECT_EQ(mesh->get_face_normal(0), vec3d(0, 0, -1));
+  EXPECT_EQ(mesh->get_normal(3), vec3d(0, 0, -1));
+  EXPECT_EQ(mesh->get_face_vertices(1), (std::array<vertex_id, 3>{ 1, 3, 2 }));
+
+  // v1 -> v2 and v2 -> v1
+  EXPECT_EQ(mesh->get_he_pair(1), 5);
+  EXPECT_EQ(mesh->get_he_pair(5), 1);
+  for (half_edge_id he : { 0, 2, 3, 4 })
+    EXPECT_TRUE(mesh->is_boundary(he));
+  check_consistency(*mesh);
+}
+
+TEST(dense_he_mesh, closed)
+{
+  // tetrahedron, every half-edge has its pair
+  std::vector<vec3d> positions = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+  auto mesh = dense_he_mesh::create(std::move(positions), {}, { 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3 });
+  for (half_edge_id he = 0; he < mesh->get_half_edge_count(); he++)
+    EXPECT_FALSE(mesh->is_boundary(he));
+  check_consistency(*mesh);
+}
+
+TEST(dense_he_mesh, invalid_indices)
+{
+  std::vector<vec3d> positions = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } };
+  EXPECT_THROW(dense_he_mesh::create(std::vector<vec3d>(positions), {}, { 0, 1 }), std::runtime_error);
+  EXPECT_THROW(dense_he_mesh::create(std::vector<vec3d>(positions), {}, { 0, 1, 3 }), std::runtime_error);
+}
+
+// same topology and ids as he_mesh
+TEST(dense_he_mesh, he_mesh_equivalence)
+{
+  std::mt19937 engine(42);
+  auto grid = create_grid(8, engine, 0.1);
+  auto positions = std::move(grid.positions);
+  auto indices = grid.get_indices();
+
+  auto reference = he_mesh::create();
+  std::vector<vertex> vertices;
+  for (vertex_id v = 0; v < positions.size(); v++)
+    vertices.emplace_back(positions[v], v);
+  for (vertex_id v = 0; v < positions.size(); v++)
+    reference->add_vertex(vertices[v]);
+  for (face_id f = 0; f < indices.size() / 3; f++) {
+    auto& v0 = reference->get_vertex_r(indices[f * 3]);
+    auto& v1 = reference->get_vertex_r(indices[f * 3 + 1]);
+    auto& v2 = reference->get_vertex_r(indices[f * 3 + 2]);
+    reference->add_face(v0, v1, v2, f);
+  }
+
+  auto mesh = dense_he_mesh::create(std::move(positions), {}, indices);
+  ASSERT_EQ(mesh->get_half_edge_count(), reference->get_half_edge_count());
+  ASSERT_EQ(mesh->get_face_count(), reference->get_face_count());
+  check_consistency(*mesh);
+
+  for (half_edge_id he = 0; he < mesh->get_half_edge_count(); he++) {
+    const auto& ref = reference->get_half_edge(he);
+    EXPECT_EQ(mesh->get_he_vertex(he), ref.v_id);
+    EXPECT_EQ(mesh->get_he_next(he), ref.next);
+    EXPECT_EQ(mesh->get_he_prev(he), ref.prev);
+    EXPECT_EQ(mesh->get_he_pair(he), ref.pair);
+    EXPECT_EQ(mesh->get_he_face(he), ref.f_id);
+  }
+  for (face_id f = 0; f < mesh->get_face_count(); f++) {
+    EXPECT_EQ(mesh->get_face_he(f), reference->get_face(f).he_id);
+    EXPECT_TRUE(mesh->get_face_normal(f).isApprox(reference->get_face(f).normal));
+  }
+  for (vertex_id v = 0; v < mesh->get_vertex_count(); v++)
+    EXPECT_EQ(mesh->get_vertex_he(v), reference->get_vertex(v).he_id);
+}
+
+} // namespace hnll::geometry
@@ -0,0 +1,58 @@
+// hnll
+#include <geometry/edge_map.hpp>
+
+// std
+#include <random>
+#include <unordered_map>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll::geometry {
+
+TEST(edge_map, emplace_and_find)
+{
+  edge_map map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(0, 1), NULL_ID);
+
+  EXPECT_EQ(map.emplace(0, 1, 10), std::make_pair(half_edge_id(10), true));
+  EXPECT_EQ(map.emplace(1, 0, 11), std::make_pair(half_edge_id(11), true));
+  // directed, and the first registration is kept
+  EXPECT_EQ(map.emplace(0, 1, 12), std::make_pair(half_edge_id(10), false));
+  EXPECT_EQ(map.size(), 2);
+
+  EXPECT_EQ(map.find(0, 1), 10);
+  EXPECT_EQ(map.find(1, 0), 11);
+  EXPECT_EQ(map.find(1, 2), NULL_ID);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(0, 1), NULL_ID);
+}
+
+TEST(edge_map, growth)
+{
+  // starts from the minimum capacity, so that the rehash runs many times
+  edge_map map;
+  std::unordered_map<uint64_t, half_edge_id> reference;
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<vertex_id> id(0, 4096);
+
+  for (half_edge_id he = 0; he < 100000; he++) {
+    auto start = id(engine), end = id(engine);
+    auto [registered, inserted] = map.emplace(start, end, he);
+    auto [it, ref_inserted] = reference.emplace(edge_map::make_key(start, end), he);
+    EXPECT_EQ(inserted, ref_inserted);
+    EXPECT_EQ(registered, it->second);
+  }
+  EXPECT_EQ(map.size(), reference.size());
+  for (const auto& [key, he] : reference)
+    EXPECT_EQ(map.find(key >> 32, key & 0xffffffff), he);
+  for (int i = 0; i < 1000; i++) {
+    auto start = id(engine) + 5000, end = id(engine);
+    EXPECT_EQ(map.find(start, end), NULL_ID);
+  }
+}
+
+} // namespace hnll::geometry
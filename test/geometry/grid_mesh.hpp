@@ -0,0 +1,57 @@
+#pragma once
+
+// hnll
+#include <geometry/primitives.hpp>
+#include <utils/common_alias.hpp>
+
+// std
+#include <array>
+#include <random>
+#include <vector>
+
+namespace hnll::geometry {
+
+// regular grid of (n + 1) x (n + 1) vertices on the xy plane, two triangles per cell.
+// shared by the half-edge mesh tests.
+struct grid_mesh
+{
+  std::vector<vec3d> positions;
+  std::vector<std::array<vertex_id, 3>> triangles;
+
+  std::vector<vertex_id> get_indices() const
+  {
+    std::vector<vertex_id> indices;
+    indices.reserve(triangles.size() * 3);
+    for (const auto& t : triangles)
+      indices.insert(indices.end(), t.begin(), t.end());
+    return indices;
+  }
+};
+
+// the heights are jittered in [-jitter, jitter]
+inline grid_mesh create_grid(int n, std::mt19937& engine, double jitter)
+{
+  grid_mesh grid;
+  std::uniform_real_distribution<double> height(-jitter, jitter);
+  for (int y = 0; y <= n; y++)
+    for (int x = 0; x <= n; x++)
+      grid.positions.emplace_back(x, y, jitter > 0.0 ? height(engine) : 0.0);
+
+  auto id = [n](int x, int y) { return static_cast<vertex_id>(x + y * (n + 1)); };
+  for (int y = 0; y < n; y++) {
+    for (int x = 0; x < n; x++) {
+      grid.triangles.push_back({ id(x, y), id(x + 1, y), id(x + 1, y + 1) });
+      grid.triangles.push_back({ id(x, y), id(x + 1, y + 1), id(x, y + 1) });
+    }
+  }
+  return grid;
+}
+
+// flat
+inline grid_mesh create_grid(int n)
+{
+  std::mt19937 engine;
+  return create_grid(n, engine, 0.0);
+}
+
+} // namespace hnll::geometry
@@ -0,0 +1,216 @@
+// hnll
+#include <geometry/he_mesh.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <graphics/utils.hpp>
+#include <utils/thread_pool.hpp>
+#include "grid_mesh.hpp"
+
+// std
+#include <algorithm>
+#include <random>
+#include <set>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll::geometry {
+
+// jittered grid with duplicated and flipped triangles, so that the non-manifold edges are also paired.
+// triangles are shuffled to mix the half-edge order around each edge.
+static void create_soup(int n, std::vector<graphics::vertex>& vertices, std::vector<vertex_id>& indices)
+{
+  std::mt19937 engine(3);
+  auto grid = create_grid(n, engine, 0.1);
+  for (const auto& position : grid.positions) {
+    graphics::vertex v;
+    v.position = position.cast<float>();
+    v.color  = vec3::Zero();
+    v.normal = { 0.f, 0.f, 1.f };
+    v.uv     = vec2::Zero();
+    vertices.emplace_back(v);
+  }
+
+  auto& triangles = grid.triangles;
+  std::uniform_int_distribution<size_t> pick(0, triangles.size() - 1);
+  for (int i = 0; i < n; i++) {
+    auto t = triangles[pick(engine)];
+    triangles.push_back(t);
+    triangles.push_back({ t[0], t[2], t[1] });
+  }
+  std::shuffle(triangles.begin(), triangles.end(), engine);
+  indices = grid.get_indices();
+}
+
+// same steps as create_from_obj_file
+static s_ptr<he_mesh> create_serial(const std::vector<graphics::vertex>& vertices, const std::vector<vertex_id>& indices)
+{
+  auto mesh = he_mesh::create();
+  for (vertex_id i = 0; i < vertices.size(); i++) {
+    vertex v { vertices[i].position.cast<double>(), i };
+    v.color  = vertices[i].color.cast<double>();
+    v.normal = vertices[i].normal.cast<double>();
+    v.uv     = vertices[i].uv.cast<double>();
+    mesh->add_vertex(v);
+  }
+  face_id f_id = 0;
+  for (size_t i = 0; i < indices.size(); i += 3)
+    mesh->add_face(mesh->get_vertex_r(indices[i]), mesh->get_vertex_r(indices[i + 1]), mesh->get_vertex_r(indices[i + 2]), f_id++);
+  return mesh;
+}
+
+static void expect_same_adjacency(const he_mesh& a, const he_mesh& b)
+{
+  ASSERT_EQ(a.get_vertex_count(), b.get_vertex_count());
+  ASSERT_EQ(a.get_face_count(), b.get_face_count());
+  ASSERT_EQ(a.get_half_edge_count(), b.get_half_edge_count());
+
+  for (vertex_id v = 0; v < a.get_vertex_count(); v++) {
+    EXPECT_EQ(a.get_vertex(v).position, b.get_vertex(v).position);
+    EXPECT_EQ(a.get_vertex(v).he_id, b.get_vertex(v).he_id);
+    EXPECT_EQ(a.get_vertex(v).face_count, b.get_vertex(v).face_count);
+  }
+  for (face_id f = 0; f < a.get_face_count(); f++) {
+    EXPECT_EQ(a.get_face(f).he_id, b.get_face(f).he_id);
+    EXPECT_EQ(a.get_face(f).normal, b.get_face(f).normal);
+  }
+  for (half_edge_id he = 0; he < a.get_half_edge_count(); he++) {
+    const auto& x = a.get_half_edge(he);
+    const auto& y = b.get_half_edge(he);
+    EXPECT_EQ(x.v_id, y.v_id);
+    EXPECT_EQ(x.f_id, y.f_id);
+    EXPECT_EQ(x.next, y.next);
+    EXPECT_EQ(x.prev, y.prev);
+    EXPECT_EQ(x.pair, y.pair) << "half edge " << he;
+  }
+}
+
+TEST(he_mesh, parallel_build)
+{
+  std::vector<graphics::vertex> vertices;
+  std::vector<vertex_id> indices;
+  create_soup(64, vertices, indices);
+  auto serial = create_serial(vertices, indices);
+
+  for (int thread_count : { 1, 2, 4, 8 }) {
+    utils::thread_pool pool(thread_count);
+    auto copy = vertices;
+    auto mesh = he_mesh::create_from_indexed_buffers(pool, std::move(copy), indices);
+    expect_same_adjacency(*serial, *mesh);
+
+    // lookups by vertices and the later faces go through the same map
+    const auto& v0 = mesh->get_vertex(indices[0]);
+    const auto& v1 = mesh->get_vertex(indices[1]);
+    EXPECT_EQ(mesh->get_half_edge_r(v0, v1).this_id, serial->get_half_edge_r(v0, v1).this_id);
+    EXPECT_EQ(mesh->move_raw_vertices().size(), vertices.size());
+  }
+}
+
+TEST(he_mesh, parallel_build_invalid_indices)
+{
+  utils::thread_pool pool(2);
+  std::vector<graphics::vertex> vertices(3);
+  EXPECT_THROW(he_mesh::create_from_indexed_buffers(pool, std::move(vertices), { 0, 1 }), std::runtime_error);
+  vertices.resize(3);
+  EXPECT_THROW(he_mesh::create_from_indexed_buffers(pool, std::move(vertices), { 0, 1, 3 }), std::runtime_error);
+}
+
+// closed octahedron and an open grid (interior and boundary vertices)
+static std::vector<s_ptr<he_mesh>> create_manifolds()
+{
+  // eigen leaves the default-constructed attributes uninitialized
+  auto make_vertex = [](const vec3& position) {
+    graphics::vertex v;
+    v.position = position;
+    v.color    = vec3::Zero();
+    v.normal   = vec3::Zero();
+    v.uv       = vec2::Zero();
+    return v;
+  };
+
+  std::vector<graphics::vertex> vertices = {
+    make_vertex({  1.f,  0.f,  0.f }),
+    make_vertex({ -1.f,  0.f,  0.f }),
+    make_vertex({  0.f,  1.f,  0.f }),
+    make_vertex({  0.f, -1.f,  0.f }),
+    make_vertex({  0.f,  0.f,  1.f }),
+    make_vertex({  0.f,  0.f, -1.f }),
+  };
+  std::vector<vertex_id> indices = {
+    0, 2, 4,  2, 1, 4,  1, 3, 4,  3, 0, 4,
+    2, 0, 5,  1, 2, 5,  3, 1, 5,  0, 3, 5,
+  };
+  std::vector<s_ptr<he_mesh>> meshes = { create_serial(vertices, indices) };
+
+  auto grid = create_grid(4);
+  vertices.clear();
+  for (const auto& position : grid.positions)
+    vertices.emplace_back(make_vertex(position.cast<float>()));
+  meshes.emplace_back(create_serial(vertices, grid.get_indices()));
+  return meshes;
+}
+
+TEST(he_mesh, face_circulators)
+{
+  for (const auto& mesh : create_manifolds()) {
+    for (face_id f : mesh->get_face_ids()) {
+      // vertices around the face in the order of the half-edges
+      auto he_id = mesh->get_face(f).he_id;
+      for (const auto& v : mesh->get_face_vertices(f)) {
+        EXPECT_EQ(v.v_id, mesh->get_half_edge(he_id).v_id);
+        he_id = mesh->get_half_edge(he_id).next;
+      }
+      EXPECT_EQ(std::ranges::distance(mesh->get_face_half_edges(f)), 3);
+
+      // adjacent faces share an edge
+      std::set<face_id> adjacent;
+      for (const auto& he : mesh->get_face_half_edges(f)) {
+        if (he.pair != NULL_ID)
+          adjacent.emplace(mesh->get_half_edge(he.pair).f_id);
+      }
+      std::set<face_id> circulated;
+      std::ranges::for_each(mesh->get_adjacent_faces(f), [&](const face& fc) { circulated.emplace(fc.f_id); });
+      EXPECT_EQ(circulated, adjacent);
+    }
+  }
+}
+
+TEST(he_mesh, vertex_circulators)
+{
+  for (const auto& mesh : create_manifolds()) {
+    for (vertex_id v : mesh->get_vertex_ids()) {
+      // brute force
+      std::multiset<face_id> expected;
+      for (const auto& fc : mesh->get_faces()) {
+        if (std::ranges::any_of(mesh->get_face_vertices(fc.f_id), [v](const vertex& fv) { return fv.v_id == v; }))
+          expected.emplace(fc.f_id);
+      }
+
+      std::multiset<face_id> circulated;
+      for (const auto& fc : mesh->get_vertex_faces(v))
+        circulated.emplace(fc.f_id);
+      EXPECT_EQ(circulated, expected) << "vertex " << v;
+      EXPECT_TRUE(std::ranges::all_of(mesh->get_vertex_half_edges(v), [v](const half_edge& he) { return he.v_id == v; }));
+    }
+  }
+}
+
+static_assert(std::ranges::view<half_edge_circulator> && std::ranges::forward_range<half_edge_circulator>);
+
+TEST(he_mesh, views)
+{
+  auto mesh = create_manifolds()[1];
+  EXPECT_EQ(std::ranges::distance(mesh->get_vertices()), mesh->get_vertex_count());
+  EXPECT_EQ(std::ranges::distance(mesh->get_half_edges()), mesh->get_half_edge_count());
+  EXPECT_EQ(std::ranges::count_if(mesh->get_half_edges(), [](const half_edge& he) { return he.pair == NULL_ID; }), 16);
+
+  std::vector<vec3d> positions;
+  for (const auto& v : mesh->get_vertices())
+    positions.emplace_back(v.position);
+  auto expected = bounding_volume::create_aabb(positions);
+  auto aabb = bounding_volume::create_aabb(mesh->get_positions());
+  EXPECT_EQ(aabb->get_local_center_point(), expected->get_local_center_point());
+  EXPECT_EQ(aabb->get_aabb_radius(), expected->get_aabb_radius());
+  EXPECT_EQ(aabb->get_aabb_radius(), vec3d(2, 2, 0));
+}
+
+} // namespace hnll::geometry
@@ -0,0 +1,30 @@
+#pragma once
+
+// hnll
+#include <geometry/bounding_volume.hpp>
+#include <utils/common_alias.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+namespace hnll::geometry {
+
+// random spheres and aabbs in a 10^3 box, alternately.
+// shared by the bvh and collision_detector tests.
+inline std::vector<u_ptr<bounding_volume>> create_volumes(int count, std::mt19937& engine)
+{
+  std::uniform_real_distribution<double> center(-5.0, 5.0);
+  std::uniform_real_distribution<double> radius(0.05, 0.5);
+  std::vector<u_ptr<bounding_volume>> volumes;
+  for (int i = 0; i < count; i++) {
+    vec3d c = { center(engine), center(engine), center(engine) };
+    if (i % 2 == 0)
+      volumes.emplace_back(bounding_volume::create_sphere(c, radius(engine)));
+    else
+      volumes.emplace_back(bounding_volume::create_aabb(c, vec3d{ radius(engine), radius(engine), radius(engine) }));
+  }
+  return volumes;
+}
+
+} // namespace hnll::geometry
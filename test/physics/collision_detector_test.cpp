@@ -0,0 +1,43 @@
+// hnll
+#include <physics/collision_detector.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/intersection.hpp>
+#include <utils/thread_pool.hpp>
+#include "../geometry/random_volumes.hpp"
+
+// std
+#include <random>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll::physics {
+
+TEST(collision_detector, detect_collisions)
+{
+  std::mt19937 engine(19);
+  auto volumes = geometry::create_volumes(500, engine);
+  utils::thread_pool pool(4);
+
+  for (auto* p : { static_cast<utils::thread_pool*>(nullptr), &pool }) {
+    collision_detector detector(p);
+    for (const auto& volume : volumes)
+      detector.add_volume(*volume);
+
+    for (int frame = 0; frame < 3; frame++) {
+      detector.update();
+      std::vector<collision_detector::collision_pair> expected;
+      for (uint32_t i = 0; i < volumes.size(); i++)
+        for (uint32_t j = i + 1; j < volumes.size(); j++)
+          if (geometry::intersection::test_bv_intersection(*volumes[i], *volumes[j]) > 0)
+            expected.emplace_back(i, j);
+      EXPECT_EQ(detector.detect_collisions(), expected);
+
+      std::uniform_real_distribution<double> step(-0.3, 0.3);
+      for (auto& volume : volumes)
+        volume->set_center_point(volume->get_local_center_point() + vec3d{ step(engine), step(engine), step(engine) });
+    }
+  }
+}
+
+} // namespace hnll::physics
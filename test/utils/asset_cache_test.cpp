@@ -0,0 +1,260 @@
+// hnll
+#include <utils/asset_cache.hpp>
+#include <utils/hash.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+namespace fs = std::filesystem;
+
+static std::string get_cache_test_directory(const std::string& name)
+{
+  auto directory = (fs::temp_directory_path() / ("hnll_asset_cache_" + name)).string();
+  fs::remove_all(directory);
+  return directory;
+}
+
+static void write_source(const std::string& path, const std::string& contents)
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << contents;
+}
+
+TEST(hash, xxh64)
+{
+  // reference values of xxh64
+  EXPECT_EQ(utils::hash_string(""), 0xEF46DB3751D8E999ull);
+  EXPECT_EQ(utils::hash_string("a"), 0xD24EC4F1A98C6E5Bull);
+  EXPECT_EQ(utils::hash_string("abc"), 0x44BC2CF5AD770999ull);
+
+  // every tail length, with and without the 32 byte lanes
+  std::string str;
+  for (int i = 0; i < 100; i++) {
+    str += static_cast<char>('a' + i % 26);
+    EXPECT_NE(utils::hash_string(str), utils::hash_string(str.substr(0, str.size() - 1)));
+  }
+  EXPECT_NE(utils::hash_string("abc", 1), utils::hash_string("abc"));
+  EXPECT_NE(utils::hash_combine(0, 1), utils::hash_combine(0, 2));
+}
+
+TEST(asset_cache, hit_and_miss)
+{
+  auto directory = get_cache_test_directory("hit");
+  utils::asset_cache cache(directory);
+  auto source = directory + "/model.obj";
+  write_source(source, "v 0 0 0\n");
+
+  EXPECT_FALSE(cache.lookup(source, 1));
+  EXPECT_TRUE(cache.store(source, 1, std::string_view("payload")));
+
+  auto entry = cache.lookup(source, 1);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->get_string_view(), "payload");
+
+  // different parameters
+  EXPECT_FALSE(cache.lookup(source, 2));
+  // missing source
+  EXPECT_FALSE(cache.lookup(directory + "/missing.obj", 1));
+  EXPECT_FALSE(cache.store(directory + "/missing.obj", 1, std::string_view("payload")));
+}
+
+TEST(asset_cache, invalidation)
+{
+  auto directory = get_cache_test_directory("invalidation");
+  utils::asset_cache cache(directory);
+  auto source = directory + "/model.obj";
+  write_source(source, "v 0 0 0\n");
+  ASSERT_TRUE(cache.store(source, 1, std::string_view("old")));
+
+  // same content with a new mtime (checkout, copy) is still valid
+  fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(10));
+  auto entry = cache.lookup(source, 1);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->get_string_view(), "old");
+  EXPECT_TRUE(cache.lookup(source, 1));
+
+  // same size, different content
+  write_source(source, "v 1 0 0\n");
+  fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(20));
+  EXPECT_FALSE(cache.lookup(source, 1));
+  // the outdated entry is removed
+  EXPECT_FALSE(fs::exists(cache.get_entry_path(source, 1)));
+
+  // different size
+  ASSERT_TRUE(cache.store(source, 1, std::string_view("new")));
+  write_source(source, "v 1 0 0\nv 2 0 0\n");
+  EXPECT_FALSE(cache.lookup(source, 1));
+}
+
+TEST(asset_cache, invalidation_of_large_source)
+{
+  auto directory = get_cache_test_directory("invalidation_of_large_source");
+  utils::asset_cache cache(directory);
+  auto source = directory + "/model.obj";
+  // larger than the head and the tail blocks
+  std::string contents(1024 * 1024, 'v');
+  write_source(source, contents);
+  ASSERT_TRUE(cache.store(source, 1, std::string_view("payload")));
+
+  fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(10));
+  EXPECT_TRUE(cache.lookup(source, 1));
+
+  // same size, differs only in the middle
+  contents[contents.size() / 2] = 'f';
+  write_source(source, contents);
+  fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(20));
+  EXPECT_FALSE(cache.lookup(source, 1));
+
+  // same size, differs in the head
+  ASSERT_TRUE(cache.store(source, 1, std::string_view("payload")));
+  contents[0] = 'f';
+  write_source(source, contents);
+  fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(30));
+  EXPECT_FALSE(cache.lookup(source, 1));
+}
+
+TEST(asset_cache, corrupted_entry)
+{
+  auto directory = get_cache_test_directory("corrupted");
+  utils::asset_cache cache(directory);
+  auto source = directory + "/model.obj";
+  write_source(source, "v 0 0 0\n");
+  ASSERT_TRUE(cache.store(source, 1, std::string_view("payload")));
+
+  // truncated
+  auto entry_path = cache.get_entry_path(source, 1);
+  fs::resize_file(entry_path, fs::file_size(entry_path) - 1);
+  EXPECT_FALSE(cache.lookup(source, 1));
+
+  // not an entry
+  write_source(entry_path, std::string(128, 'x'));
+  EXPECT_FALSE(cache.lookup(source, 1));
+}
+
+TEST(asset_cache, entry_outlives_replacement)
+{
+  auto directory = get_cache_test_directory("replacement");
+  utils::asset_cache cache(directory);
+  auto source = directory + "/model.obj";
+  write_source(source, "v 0 0 0\n");
+  std::string old_payload(64 * 1024, 'a');
+  ASSERT_TRUE(cache.store(source, 1, old_payload));
+
+  auto entry = cache.lookup(source, 1);
+  ASSERT_TRUE(entry);
+  ASSERT_TRUE(cache.store(source, 1, std::string_view("b")));
+  EXPECT_EQ(entry->get_string_view(), old_payload);
+  EXPECT_EQ(cache.lookup(source, 1)->get_string_view(), "b");
+}
+
+TEST(asset_cache, concurrent_store)
+{
+  auto directory = get_cache_test_directory("concurrent");
+  utils::asset_cache cache(directory);
+  auto source = directory + "/model.obj";
+  write_source(source, "v 0 0 0\n");
+
+  constexpr int THREAD_COUNT = 8;
+  constexpr int STORE_COUNT = 20;
+  // every payload has a distinct valid form, a torn entry would be detected
+  auto make_payload = [](int id) { return std::string(4096 + id, static_cast<char>('a' + id)); };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_COUNT; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < STORE_COUNT; i++) {
+        EXPECT_TRUE(cache.store(source, 1, make_payload(t)));
+        if (auto entry = cache.lookup(source, 1)) {
+          auto view = entry->get_string_view();
+          ASSERT_GE(view.size(), 4096u);
+          auto id = static_cast<int>(view.size() - 4096);
+          EXPECT_EQ(view, make_payload(id));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_TRUE(cache.lookup(source, 1));
+  // no temporary files are left
+  for (const auto& file : fs::directory_iterator(directory))
+    EXPECT_NE(file.path().extension(), ".tmp");
+}
+
+TEST(asset_cache, eviction)
+{
+  auto directory = get_cache_test_directory("eviction");
+  constexpr size_t PAYLOAD_SIZE = 1000;
+  // room for two entries
+  utils::asset_cache cache(directory, PAYLOAD_SIZE * 2 + 200);
+
+  std::vector<std::string> sources;
+  for (int i = 0; i < 3; i++) {
+    sources.emplace_back(directory + "/model" + std::to_string(i) + ".obj");
+    write_source(sources.back(), "v " + std::to_string(i));
+  }
+
+  auto now = fs::file_time_type::clock::now();
+  ASSERT_TRUE(cache.store(sources[0], 1, std::string(PAYLOAD_SIZE, '0')));
+  fs::last_write_time(cache.get_entry_path(sources[0], 1), now - std::chrono::hours(3));
+  ASSERT_TRUE(cache.store(sources[1], 1, std::string(PAYLOAD_SIZE, '1')));
+  fs::last_write_time(cache.get_entry_path(sources[1], 1), now - std::chrono::hours(5));
+
+  // the lookup records the use of an old entry
+  EXPECT_TRUE(cache.lookup(sources[1], 1));
+
+  // the least recently used one is evicted
+  ASSERT_TRUE(cache.store(sources[2], 1, std::string(PAYLOAD_SIZE, '2')));
+  EXPECT_FALSE(cache.lookup(sources[0], 1));
+  EXPECT_TRUE(cache.lookup(sources[1], 1));
+  EXPECT_TRUE(cache.lookup(sources[2], 1));
+  EXPECT_LE(cache.get_total_size(), cache.get_max_size());
+
+  // stale temporary files of crashed writers
+  auto temp = cache.get_entry_path(sources[2], 1) + ".1234.0.tmp";
+  write_source(temp, "partial");
+  fs::last_write_time(temp, now - std::chrono::hours(2));
+  cache.evict();
+  EXPECT_FALSE(fs::exists(temp));
+}
+
+TEST(asset_cache, eviction_of_existing_entries)
+{
+  auto directory = get_cache_test_directory("existing");
+  constexpr size_t PAYLOAD_SIZE = 1000;
+  fs::create_directories(directory);
+
+  std::vector<std::string> sources;
+  for (int i = 0; i < 3; i++) {
+    sources.emplace_back(directory + "/model" + std::to_string(i) + ".obj");
+    write_source(sources.back(), "v " + std::to_string(i));
+  }
+
+  // written by the previous run
+  {
+    utils::asset_cache cache(directory);
+    ASSERT_TRUE(cache.store(sources[0], 1, std::string(PAYLOAD_SIZE, '0')));
+    ASSERT_TRUE(cache.store(sources[1], 1, std::string(PAYLOAD_SIZE, '1')));
+    fs::last_write_time(cache.get_entry_path(sources[0], 1), fs::file_time_type::clock::now() - std::chrono::hours(3));
+  }
+
+  // the existing entries count toward the limit without another scan
+  utils::asset_cache cache(directory, PAYLOAD_SIZE * 2 + 200);
+  ASSERT_TRUE(cache.store(sources[2], 1, std::string(PAYLOAD_SIZE, '2')));
+  EXPECT_FALSE(cache.lookup(sources[0], 1));
+  EXPECT_TRUE(cache.lookup(sources[1], 1));
+  EXPECT_TRUE(cache.lookup(sources[2], 1));
+  EXPECT_LE(cache.get_total_size(), cache.get_max_size());
+}
+
+} // namespace hnll
@@ -0,0 +1,86 @@
+// hnll
+#include <utils/block_pool.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+#define JOIN_THREADS(threads) for (auto& t : threads) t.join()
+
+TEST(block_pool, allocate_deallocate)
+{
+  std::vector<void*> blocks;
+  for (size_t size : { 1, 16, 32, 33, 64, 100, 128, 200, 256 }) {
+    for (int i = 0; i < 100; i++) {
+      auto block = utils::block_pool::allocate(size);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % utils::block_pool::BLOCK_ALIGNMENT, 0);
+      // the whole block is writable
+      std::memset(block, i, size);
+      blocks.emplace_back(block);
+    }
+    // no block is handed out twice
+    auto sorted = blocks;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(std::adjacent_find(sorted.begin(), sorted.end()), sorted.end());
+
+    for (auto block : blocks)
+      utils::block_pool::deallocate(block, size);
+    blocks.clear();
+  }
+}
+
+TEST(block_pool, cross_thread_free)
+{
+  // blocks allocated on one thread are freed on others like thread_pool tasks
+  std::vector<void*> blocks(ELEMENT_COUNT);
+  for (auto& block : blocks)
+    block = utils::block_pool::allocate(64);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([&blocks, i]() {
+      for (int j = i; j < ELEMENT_COUNT; j += THREAD_COUNT)
+        utils::block_pool::deallocate(blocks[j], 64);
+    });
+  }
+  JOIN_THREADS(threads);
+
+  // freed blocks come back through the depot instead of new slabs.
+  // a few may come from the blocks this thread had cached before
+  auto freed = blocks;
+  std::sort(freed.begin(), freed.end());
+  int reused_count = 0;
+  for (auto& block : blocks) {
+    block = utils::block_pool::allocate(64);
+    reused_count += std::binary_search(freed.begin(), freed.end(), block);
+  }
+  EXPECT_GE(reused_count, ELEMENT_COUNT * 9 / 10);
+
+  for (auto block : blocks)
+    utils::block_pool::deallocate(block, 64);
+}
+
+TEST(block_pool, pool_allocator)
+{
+  // small shared_ptr control blocks are pooled, large ones fall back to std::allocator
+  auto small = std::allocate_shared<int>(utils::pool_allocator<int>{}, 1);
+  auto large = std::allocate_shared<std::array<char, 1024>>(utils::pool_allocator<std::array<char, 1024>>{});
+  EXPECT_EQ(*small, 1);
+  EXPECT_EQ(large->size(), 1024);
+
+  auto ptr = utils::pool_new<std::pair<int, double>>(1, 2.0);
+  EXPECT_EQ(ptr->first, 1);
+  EXPECT_EQ(ptr->second, 2.0);
+  utils::pool_delete(ptr);
+}
+
+} // namespace hnll
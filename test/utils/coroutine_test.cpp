@@ -0,0 +1,134 @@
+// hnll
+#include <utils/coroutine.hpp>
+
+// std
+#include <set>
+#include <thread>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+
+utils::task<std::thread::id> get_thread_id(utils::thread_pool& pool)
+{
+  co_await pool.schedule();
+  co_return std::this_thread::get_id();
+}
+
+TEST(coroutine, schedule)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  // resumed on a worker thread
+  auto id = utils::sync_wait(get_thread_id(pool));
+  EXPECT_NE(id, std::this_thread::get_id());
+}
+
+// imitates a load -> build -> separate pipeline
+utils::task<int> load(utils::thread_pool& pool, int value)
+{
+  co_await pool.schedule();
+  co_return value;
+}
+
+utils::task<int> build(utils::thread_pool& pool, int value)
+{
+  auto loaded = co_await load(pool, value);
+  co_await pool.schedule();
+  co_return loaded * 2;
+}
+
+utils::task<std::string> separate(utils::thread_pool& pool, int value)
+{
+  auto built = build(pool, value);
+  auto result = co_await built;
+  co_return std::to_string(result);
+}
+
+TEST(coroutine, await_task)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  EXPECT_EQ(utils::sync_wait(separate(pool, 21)), "42");
+
+  // a task is lazy
+  bool started = false;
+  // the lambda should outlive the coroutine
+  auto start = [&]() -> utils::task<void> { started = true; co_return; };
+  auto lazy = start();
+  EXPECT_FALSE(started);
+  utils::sync_wait(std::move(lazy));
+  EXPECT_TRUE(started);
+}
+
+utils::task<int> throw_error(utils::thread_pool& pool)
+{
+  co_await pool.schedule();
+  throw std::runtime_error("error");
+  co_return 0;
+}
+
+TEST(coroutine, exception)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  EXPECT_THROW(utils::sync_wait(throw_error(pool)), std::runtime_error);
+
+  auto catch_error = [&]() -> utils::task<bool> {
+    try { co_await throw_error(pool); }
+    catch (const std::runtime_error&) { co_return true; }
+    co_return false;
+  };
+  EXPECT_TRUE(utils::sync_wait(catch_error()));
+}
+
+TEST(coroutine, when_all)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  constexpr int task_count = 1000;
+
+  std::vector<utils::task<int>> tasks;
+  for (int i = 0; i < task_count; i++)
+    tasks.emplace_back(build(pool, i));
+
+  auto results = utils::sync_wait(utils::when_all(std::move(tasks)));
+  ASSERT_EQ(results.size(), static_cast<size_t>(task_count));
+  for (int i = 0; i < task_count; i++)
+    EXPECT_EQ(results[i], i * 2);
+
+  // void tasks, some of them finish synchronously
+  std::atomic<int> counter = 0;
+  auto increment = [&](bool schedule) -> utils::task<void> {
+    if (schedule)
+      co_await pool.schedule();
+    counter++;
+  };
+  std::vector<utils::task<void>> void_tasks;
+  for (int i = 0; i < task_count; i++)
+    void_tasks.emplace_back(increment(i % 2 == 0));
+  utils::sync_wait(utils::when_all(std::move(void_tasks)));
+  EXPECT_EQ(counter, task_count);
+
+  // empty
+  utils::sync_wait(utils::when_all(std::vector<utils::task<void>>{}));
+}
+
+TEST(coroutine, no_oversubscription)
+{
+  // many more suspended tasks than threads
+  utils::thread_pool pool(2);
+  constexpr int task_count = 10000;
+
+  std::vector<utils::task<std::thread::id>> tasks;
+  for (int i = 0; i < task_count; i++)
+    tasks.emplace_back(get_thread_id(pool));
+  auto results = utils::sync_wait(utils::when_all(std::move(tasks)));
+  ASSERT_EQ(results.size(), static_cast<size_t>(task_count));
+
+  // resumed only by the workers of the pool, not by a thread per task
+  std::set<std::thread::id> thread_ids(results.begin(), results.end());
+  EXPECT_LE(thread_ids.size(), pool.get_thread_count());
+  EXPECT_FALSE(thread_ids.contains(std::this_thread::get_id()));
+}
+
+} // namespace hnll
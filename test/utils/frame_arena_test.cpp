@@ -0,0 +1,156 @@
+// hnll
+#include <utils/frame_arena.hpp>
+
+// std
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+#define JOIN_THREADS(threads) for (auto& t : threads) t.join()
+
+// counts the upstream allocations
+class counting_resource : public std::pmr::memory_resource
+{
+  public:
+    int allocation_count = 0;
+    int live_count = 0;
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+      allocation_count++;
+      live_count++;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+      live_count--;
+      std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    { return this == &other; }
+};
+
+TEST(frame_arena, alignment)
+{
+  utils::frame_arena arena(1024);
+  for (size_t alignment : { 1, 2, 4, 8, 16, 32, 64 }) {
+    // misalign the offset first
+    [[maybe_unused]] auto padding = arena.allocate(1, 1);
+    auto ptr = arena.allocate(8, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+  }
+}
+
+TEST(frame_arena, reset_reuses_region)
+{
+  counting_resource upstream;
+  {
+    utils::frame_arena arena(1024, &upstream);
+    EXPECT_EQ(upstream.allocation_count, utils::FRAMES_IN_FLIGHT);
+
+    std::vector<void*> first_ptrs;
+    for (int frame = 0; frame < utils::FRAMES_IN_FLIGHT; frame++) {
+      first_ptrs.emplace_back(arena.allocate(64));
+      EXPECT_EQ(arena.get_used_bytes(), 64);
+      arena.begin_frame();
+    }
+
+    // the same region is handed out after FRAMES_IN_FLIGHT frames
+    for (int frame = 0; frame < utils::FRAMES_IN_FLIGHT; frame++) {
+      EXPECT_EQ(arena.get_used_bytes(), 0);
+      EXPECT_EQ(arena.allocate(64), first_ptrs[frame]);
+      arena.begin_frame();
+    }
+    EXPECT_EQ(upstream.allocation_count, utils::FRAMES_IN_FLIGHT);
+  }
+  EXPECT_EQ(upstream.live_count, 0);
+}
+
+TEST(frame_arena, previous_frames_stay_valid)
+{
+  utils::frame_arena arena(1024);
+  std::vector<int*> values;
+  for (int frame = 0; frame < utils::FRAMES_IN_FLIGHT; frame++) {
+    auto value = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+    *value = frame;
+    values.emplace_back(value);
+    if (frame + 1 < utils::FRAMES_IN_FLIGHT)
+      arena.begin_frame();
+  }
+  for (int frame = 0; frame < utils::FRAMES_IN_FLIGHT; frame++)
+    EXPECT_EQ(*values[frame], frame);
+}
+
+TEST(frame_arena, overflow_and_grow)
+{
+  counting_resource upstream;
+  {
+    utils::frame_arena arena(256, &upstream);
+    // the last 2 blocks overflow the region
+    for (int i = 0; i < 4; i++)
+      std::memset(arena.allocate(128), i, 128);
+    EXPECT_EQ(arena.get_used_bytes(), 512);
+    EXPECT_GT(upstream.live_count, utils::FRAMES_IN_FLIGHT);
+
+    // the region is grown to the peak usage when it comes round
+    for (int frame = 0; frame < utils::FRAMES_IN_FLIGHT; frame++)
+      arena.begin_frame();
+    EXPECT_EQ(arena.get_high_water_mark(), 512);
+    EXPECT_EQ(arena.get_capacity(), 512);
+    EXPECT_EQ(upstream.live_count, utils::FRAMES_IN_FLIGHT);
+
+    auto count = upstream.allocation_count;
+    for (int i = 0; i < 4; i++)
+      [[maybe_unused]] auto ptr = arena.allocate(128);
+    EXPECT_EQ(upstream.allocation_count, count);
+  }
+  EXPECT_EQ(upstream.live_count, 0);
+}
+
+TEST(frame_arena, pmr_vector)
+{
+  counting_resource upstream;
+  utils::frame_arena arena(1 << 20, &upstream);
+  auto count = upstream.allocation_count;
+
+  std::pmr::vector<int> values(&arena);
+  for (int i = 0; i < ELEMENT_COUNT; i++)
+    values.emplace_back(i);
+  for (int i = 0; i < ELEMENT_COUNT; i++)
+    EXPECT_EQ(values[i], i);
+  EXPECT_EQ(upstream.allocation_count, count);
+}
+
+TEST(frame_arena, multi_thread)
+{
+  utils::frame_arena arena(THREAD_COUNT * ELEMENT_COUNT * sizeof(int) / 2);
+  std::vector<std::vector<int*>> ptrs(THREAD_COUNT);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([&arena, &ptrs, i]() {
+      for (int j = 0; j < ELEMENT_COUNT; j++) {
+        auto value = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+        *value = i * ELEMENT_COUNT + j;
+        ptrs[i].emplace_back(value);
+      }
+    });
+  }
+  JOIN_THREADS(threads);
+
+  // half of the allocations overflow, no allocation overlaps
+  for (int i = 0; i < THREAD_COUNT; i++)
+    for (int j = 0; j < ELEMENT_COUNT; j++)
+      EXPECT_EQ(*ptrs[i][j], i * ELEMENT_COUNT + j);
+  EXPECT_EQ(arena.get_used_bytes(), THREAD_COUNT * ELEMENT_COUNT * sizeof(int));
+}
+
+} // namespace hnll
@@ -0,0 +1,126 @@
+// hnll
+#include <utils/frame_pacer.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <random>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int FRAME_COUNT = 200;
+constexpr float MAX_FPS = 200.f; // 5 ms
+
+TEST(frame_pacer, statistics)
+{
+  utils::frame_pacer pacer(MAX_FPS);
+  std::vector<double> intervals;
+  for (int i = 0; i < FRAME_COUNT; i++)
+    intervals.emplace_back(pacer.wait_for_next_frame() * 1000.0);
+
+  // matches the offline computation
+  double mean = 0.0;
+  for (auto v : intervals)
+    mean += v;
+  mean /= FRAME_COUNT;
+  double variance = 0.0;
+  for (auto v : intervals)
+    variance += (v - mean) * (v - mean);
+  variance /= FRAME_COUNT - 1;
+
+  auto stats = pacer.get_statistics();
+  EXPECT_EQ(stats.frame_count, FRAME_COUNT);
+  EXPECT_NEAR(stats.mean, mean, 1e-3);
+  EXPECT_NEAR(stats.variance, variance, 1e-3);
+  EXPECT_NEAR(stats.min, *std::min_element(intervals.begin(), intervals.end()), 1e-3);
+  EXPECT_NEAR(stats.max, *std::max_element(intervals.begin(), intervals.end()), 1e-3);
+
+  pacer.reset_statistics();
+  EXPECT_EQ(pacer.get_statistics().frame_count, 0);
+}
+
+TEST(frame_pacer, frame_time_variance)
+{
+  utils::frame_pacer pacer(MAX_FPS);
+  std::vector<float> intervals;
+  auto cpu_begin = std::clock();
+  auto wall_begin = utils::frame_pacer::clock::now();
+  for (int i = 0; i < FRAME_COUNT; i++)
+    intervals.emplace_back(pacer.wait_for_next_frame());
+  auto cpu_time = static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+  auto wall_time = std::chrono::duration<double>(utils::frame_pacer::clock::now() - wall_begin).count();
+
+  auto stats = pacer.get_statistics();
+  auto stddev = std::sqrt(stats.variance);
+  ::testing::Test::RecordProperty("frame_time_mean_us", static_cast<int>(stats.mean * 1000.0));
+  ::testing::Test::RecordProperty("frame_time_stddev_us", static_cast<int>(stddev * 1000.0));
+
+  EXPECT_NEAR(stats.mean, 5.0, 0.5) << "min : " << stats.min << " ms, max : " << stats.max << " ms";
+  // a loaded machine may preempt a few frames, so the outliers are tolerated
+  int on_time = 0;
+  for (auto dt : intervals)
+    on_time += std::abs(dt - 0.005f) < 0.0005f;
+  EXPECT_GE(on_time, FRAME_COUNT * 8 / 10) << "missed : " << stats.missed_count;
+  EXPECT_LT(stddev, 2.5) << "min : " << stats.min << " ms, max : " << stats.max << " ms";
+  // most of the wait is spent sleeping
+  EXPECT_LT(cpu_time, wall_time * 0.5);
+  EXPECT_GE(pacer.get_spin_threshold(), utils::frame_pacer::MIN_SPIN);
+  EXPECT_LE(pacer.get_spin_threshold(), utils::frame_pacer::MAX_SPIN);
+}
+
+TEST(frame_pacer, drift_correction)
+{
+  // random work shorter than the period doesn't accumulate into the frame rate
+  utils::frame_pacer pacer(MAX_FPS);
+  std::mt19937 engine{ 0 };
+  std::uniform_int_distribution<int> work_us(0, 2000);
+
+  auto begin = utils::frame_pacer::clock::now();
+  for (int i = 0; i < FRAME_COUNT; i++) {
+    pacer.wait_for_next_frame();
+    std::this_thread::sleep_for(std::chrono::microseconds(work_us(engine)));
+  }
+  auto elapsed = std::chrono::duration<double, std::milli>(utils::frame_pacer::clock::now() - begin).count();
+  // the mean work (1 ms) would accumulate to 200 ms without the correction,
+  // the tolerance is for the preempted frames which restart the schedule
+  EXPECT_NEAR(elapsed, FRAME_COUNT * 5.0, 50.0);
+}
+
+TEST(frame_pacer, hitch)
+{
+  utils::frame_pacer pacer(MAX_FPS);
+  pacer.wait_for_next_frame();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  // the late frame starts immediately
+  EXPECT_GE(pacer.wait_for_next_frame(), 0.020f);
+
+  // no burst of frames to catch up
+  pacer.reset_statistics();
+  for (int i = 0; i < 10; i++)
+    pacer.wait_for_next_frame();
+  EXPECT_GT(pacer.get_statistics().min, 4.0);
+}
+
+TEST(frame_pacer, unlimited)
+{
+  utils::frame_pacer pacer(0.f);
+  EXPECT_EQ(pacer.get_period(), utils::frame_pacer::duration::zero());
+  auto begin = utils::frame_pacer::clock::now();
+  for (int i = 0; i < FRAME_COUNT; i++)
+    pacer.wait_for_next_frame();
+  EXPECT_LT(utils::frame_pacer::clock::now() - begin, std::chrono::milliseconds(100));
+  EXPECT_EQ(pacer.get_statistics().missed_count, 0);
+
+  // switch to capped
+  pacer.set_max_fps(MAX_FPS);
+  pacer.wait_for_next_frame();
+  EXPECT_GE(pacer.wait_for_next_frame(), 0.0049f);
+}
+
+} // namespace hnll
@@ -0,0 +1,175 @@
+// hnll
+#include <utils/logger.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+static std::vector<std::string> read_log_lines(const std::string& path)
+{
+  std::vector<std::string> lines;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line))
+    lines.emplace_back(line);
+  return lines;
+}
+
+// writes the log to a fresh file without the console output
+class logger_test : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+      path_ = (std::filesystem::temp_directory_path() / "hnll_logger_test.log").string();
+      std::filesystem::remove(path_);
+      utils::logger::set_console_enabled(false);
+      ASSERT_TRUE(utils::logger::set_file(path_));
+    }
+
+    void TearDown() override
+    {
+      utils::logger::set_file("");
+      utils::logger::set_console_enabled(true);
+      utils::logger::set_level(utils::COMPILED_LOG_LEVEL);
+    }
+
+    std::vector<std::string> flush_and_read()
+    {
+      utils::logger::flush();
+      return read_log_lines(path_);
+    }
+
+    std::string path_;
+};
+
+TEST_F(logger_test, format)
+{
+  enum class test_enum { A, B };
+  HNLL_LOG_INFO("int ", -42, " size ", size_t(7), " float ", 1.5f, " bool ", true, " enum ", test_enum::B,
+                " string ", std::string("str"), " char ", 'c');
+  auto lines = flush_and_read();
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_NE(lines[0].find("[INFO ]"), std::string::npos);
+  EXPECT_NE(lines[0].find("int -42 size 7 float 1.5 bool true enum 1 string str char c"), std::string::npos);
+}
+
+TEST_F(logger_test, truncation)
+{
+  std::string long_text(1000, 'x');
+  HNLL_LOG_INFO(long_text);
+  auto lines = flush_and_read();
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_EQ(lines[0].substr(lines[0].size() - 3), "...");
+  EXPECT_LT(lines[0].size(), utils::log_record::MAX_LENGTH + 64);
+}
+
+TEST_F(logger_test, level)
+{
+  // removed at compile time, the arguments are not evaluated
+  int evaluated = 0;
+  auto count = [&evaluated]() { return ++evaluated; };
+  if constexpr (utils::COMPILED_LOG_LEVEL > utils::log_level::TRACE) {
+    HNLL_LOG_TRACE("trace ", count());
+    EXPECT_EQ(evaluated, 0);
+  }
+
+  // runtime filter
+  utils::logger::set_level(utils::log_level::WARN);
+  HNLL_LOG_INFO("filtered");
+  HNLL_LOG_WARN("warn");
+  HNLL_LOG_ERROR("error");
+  auto lines = flush_and_read();
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_NE(lines[0].find("[WARN ] [t"), std::string::npos);
+  EXPECT_NE(lines[1].find("[ERROR]"), std::string::npos);
+}
+
+TEST_F(logger_test, multi_thread)
+{
+  constexpr int THREAD_COUNT = 4;
+  // below the queue capacity, nothing is dropped
+  constexpr int LINE_COUNT = 500;
+  auto dropped = utils::logger::get_dropped_count();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_COUNT; t++) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < LINE_COUNT; i++)
+        HNLL_LOG_INFO("thread ", t, " line ", i);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  auto lines = flush_and_read();
+  EXPECT_EQ(utils::logger::get_dropped_count(), dropped);
+  ASSERT_EQ(lines.size(), THREAD_COUNT * LINE_COUNT);
+
+  // lines of each thread keep their order
+  std::vector<int> next(THREAD_COUNT, 0);
+  for (const auto& line : lines) {
+    auto pos = line.find("thread ");
+    ASSERT_NE(pos, std::string::npos);
+    int t = 0, i = 0;
+    ASSERT_EQ(std::sscanf(line.c_str() + pos, "thread %d line %d", &t, &i), 2);
+    EXPECT_EQ(i, next[t]++);
+  }
+}
+
+TEST_F(logger_test, flush_from_threads)
+{
+  constexpr int THREAD_COUNT = 4;
+  constexpr int FLUSH_COUNT = 20;
+
+  // each flush returns only after the line of its thread is written, even if the other threads
+  // push their lines in the meantime
+  std::vector<int> missing(THREAD_COUNT, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_COUNT; t++) {
+    threads.emplace_back([this, t, &missing]() {
+      for (int i = 0; i < FLUSH_COUNT; i++) {
+        auto text = "flush thread " + std::to_string(t) + " line " + std::to_string(i);
+        HNLL_LOG_INFO(text);
+        utils::logger::flush();
+        bool found = false;
+        for (const auto& line : read_log_lines(path_))
+          found |= line.ends_with(text);
+        if (!found)
+          missing[t]++;
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int t = 0; t < THREAD_COUNT; t++)
+    EXPECT_EQ(missing[t], 0);
+}
+
+TEST_F(logger_test, never_blocks)
+{
+  // more than the queue, the overflow is dropped and counted instead of blocking
+  auto dropped = utils::logger::get_dropped_count();
+  constexpr size_t LINE_COUNT = utils::logger::QUEUE_CAPACITY * 4;
+  for (size_t i = 0; i < LINE_COUNT; i++)
+    HNLL_LOG_INFO("burst ", i);
+
+  auto lines = flush_and_read();
+  auto newly_dropped = utils::logger::get_dropped_count() - dropped;
+  size_t burst_lines = 0;
+  for (const auto& line : lines)
+    if (line.find("burst ") != std::string::npos)
+      burst_lines++;
+  EXPECT_EQ(burst_lines + newly_dropped, LINE_COUNT);
+}
+
+} // namespace hnll
@@ -0,0 +1,118 @@
+// hnll
+#include <utils/mapped_file.hpp>
+#include <utils/utils.hpp>
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int ELEMENT_COUNT = 10000;
+
+std::string write_temp_file(const std::string& name, const std::string& contents)
+{
+  auto path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream file(path, std::ios::binary);
+  file << contents;
+  return path;
+}
+
+std::string create_lines(int count)
+{
+  std::string ret;
+  for (int i = 0; i < count; i++)
+    ret += std::to_string(i) + "\n";
+  return ret;
+}
+
+TEST(mapped_file, large_file)
+{
+  auto contents = create_lines(ELEMENT_COUNT);
+  ASSERT_GE(contents.size(), utils::mapped_file::SMALL_FILE_SIZE);
+  auto path = write_temp_file("hnll_mapped_large.txt", contents);
+
+  utils::mapped_file file(path);
+  EXPECT_TRUE(file.is_mapped());
+  EXPECT_EQ(file.size(), contents.size());
+  EXPECT_EQ(file.get_string_view(), contents);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(file.data()) % 16, 0);
+  file.advise(utils::mapped_file::access_hint::RANDOM);
+
+  std::filesystem::remove(path);
+  // the mapping is still valid
+  EXPECT_EQ(file.get_string_view(), contents);
+}
+
+TEST(mapped_file, small_file)
+{
+  auto path = write_temp_file("hnll_mapped_small.txt", "small");
+  utils::mapped_file file(path);
+  EXPECT_FALSE(file.is_mapped());
+  EXPECT_EQ(file.get_string_view(), "small");
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(file.data()) % 16, 0);
+  std::filesystem::remove(path);
+
+  auto empty_path = write_temp_file("hnll_mapped_empty.txt", "");
+  utils::mapped_file empty(empty_path);
+  EXPECT_TRUE(empty.empty());
+  std::filesystem::remove(empty_path);
+}
+
+TEST(mapped_file, move)
+{
+  for (int lines : { 10, ELEMENT_COUNT }) {
+    auto contents = create_lines(lines);
+    auto path = write_temp_file("hnll_mapped_move.txt", contents);
+
+    utils::mapped_file file(path);
+    utils::mapped_file moved(std::move(file));
+    EXPECT_EQ(file.size(), 0);
+    EXPECT_EQ(moved.get_string_view(), contents);
+
+    utils::mapped_file assigned(path);
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.get_string_view(), contents);
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(mapped_file, missing_file)
+{
+  EXPECT_THROW(utils::mapped_file("/nonexistent/hnll_mapped_file"), std::runtime_error);
+  EXPECT_THROW(utils::read_file_for_shader("/nonexistent/hnll_shader.spv"), std::runtime_error);
+}
+
+TEST(mapped_file, istream)
+{
+  auto contents = create_lines(ELEMENT_COUNT);
+  auto path = write_temp_file("hnll_mapped_stream.txt", contents);
+  utils::mapped_file file(path);
+  utils::memory_istream stream(file);
+
+  std::string line;
+  int count = 0;
+  while (std::getline(stream, line)) {
+    EXPECT_EQ(std::stoi(line), count);
+    count++;
+  }
+  EXPECT_EQ(count, ELEMENT_COUNT);
+
+  // seek back
+  stream.clear();
+  stream.seekg(0);
+  std::getline(stream, line);
+  EXPECT_EQ(line, "0");
+  stream.seekg(-2, std::ios_base::end);
+  std::getline(stream, line);
+  EXPECT_EQ(line, std::to_string(ELEMENT_COUNT - 1).substr(3));
+  EXPECT_EQ(stream.tellg(), static_cast<std::streamoff>(contents.size()));
+  std::filesystem::remove(path);
+}
+
+} // namespace hnll
@@ -0,0 +1,166 @@
+// hnll
+#include <utils/memory_tracker.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+#define JOIN_THREADS(threads) for (auto& t : threads) t.join()
+
+using utils::memory_tag;
+using utils::memory_tracker;
+
+TEST(memory_tracker, scope)
+{
+  EXPECT_EQ(memory_tracker::get_current_tag(), memory_tag::UNTAGGED);
+  {
+    utils::memory_scope geometry(memory_tag::GEOMETRY);
+    EXPECT_EQ(memory_tracker::get_current_tag(), memory_tag::GEOMETRY);
+    {
+      utils::memory_scope audio(memory_tag::AUDIO);
+      EXPECT_EQ(memory_tracker::get_current_tag(), memory_tag::AUDIO);
+    }
+    EXPECT_EQ(memory_tracker::get_current_tag(), memory_tag::GEOMETRY);
+  }
+  EXPECT_EQ(memory_tracker::get_current_tag(), memory_tag::UNTAGGED);
+
+  // per thread
+  utils::memory_scope physics(memory_tag::PHYSICS);
+  std::thread([]() { EXPECT_EQ(memory_tracker::get_current_tag(), memory_tag::UNTAGGED); }).join();
+}
+
+TEST(memory_tracker, counters)
+{
+  // the counters themselves, regardless of operator new
+  auto before = memory_tracker::get_report(memory_tag::GAME);
+  memory_tracker::reset_peaks();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < ELEMENT_COUNT; j++)
+        memory_tracker::on_allocate(memory_tag::GAME, 16);
+      for (int j = 0; j < ELEMENT_COUNT; j++)
+        memory_tracker::on_deallocate(memory_tag::GAME, 16);
+    });
+  }
+  JOIN_THREADS(threads);
+
+  auto after = memory_tracker::get_report(memory_tag::GAME);
+  EXPECT_STREQ(after.name, "game");
+  EXPECT_EQ(after.live_bytes, before.live_bytes);
+  EXPECT_EQ(after.alloc_count - before.alloc_count, THREAD_COUNT * ELEMENT_COUNT);
+  EXPECT_EQ(after.free_count - before.free_count, THREAD_COUNT * ELEMENT_COUNT);
+  // at least one thread has reached its peak alone
+  EXPECT_GE(after.peak_bytes - before.live_bytes, 16 * ELEMENT_COUNT);
+  EXPECT_LE(after.peak_bytes - before.live_bytes, 16 * ELEMENT_COUNT * THREAD_COUNT);
+
+  memory_tracker::reset_peaks();
+  EXPECT_EQ(memory_tracker::get_report(memory_tag::GAME).peak_bytes, after.live_bytes);
+}
+
+TEST(memory_tracker, frame)
+{
+  // an empty frame
+  memory_tracker::end_frame();
+  memory_tracker::end_frame();
+  for (int i = 0; i < 10; i++)
+    memory_tracker::on_allocate(memory_tag::PHYSICS, 8);
+  // not closed yet
+  EXPECT_EQ(memory_tracker::get_report(memory_tag::PHYSICS).frame_alloc_count, 0);
+  memory_tracker::end_frame();
+  EXPECT_EQ(memory_tracker::get_report(memory_tag::PHYSICS).frame_alloc_count, 10);
+  memory_tracker::end_frame();
+  EXPECT_EQ(memory_tracker::get_report(memory_tag::PHYSICS).frame_alloc_count, 0);
+
+  for (int i = 0; i < 10; i++)
+    memory_tracker::on_deallocate(memory_tag::PHYSICS, 8);
+}
+
+TEST(memory_tracker, tagged_allocation)
+{
+  if (!memory_tracker::is_enabled())
+    GTEST_SKIP() << "built without HNLL_TRACK_ALLOCATIONS.";
+
+  auto before = memory_tracker::get_report(memory_tag::AUDIO);
+  std::vector<double>* buffer;
+  {
+    utils::memory_scope scope(memory_tag::AUDIO);
+    buffer = new std::vector<double>(ELEMENT_COUNT);
+  }
+  auto allocated = memory_tracker::get_report(memory_tag::AUDIO);
+  EXPECT_EQ(allocated.alloc_count - before.alloc_count, 2);
+  EXPECT_EQ(allocated.live_bytes - before.live_bytes, sizeof(std::vector<double>) + sizeof(double) * ELEMENT_COUNT);
+
+  // freed on another thread outside of the scope, still charged to the allocation's tag
+  std::thread([buffer]() { delete buffer; }).join();
+  auto freed = memory_tracker::get_report(memory_tag::AUDIO);
+  EXPECT_EQ(freed.live_bytes, before.live_bytes);
+  EXPECT_EQ(freed.free_count - before.free_count, 2);
+
+  // over-aligned
+  struct alignas(64) aligned { char data[64]; };
+  {
+    utils::memory_scope scope(memory_tag::AUDIO);
+    auto ptr = std::make_unique<aligned>();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr.get()) % 64, 0);
+    EXPECT_EQ(memory_tracker::get_report(memory_tag::AUDIO).live_bytes - before.live_bytes, 64);
+  }
+  EXPECT_EQ(memory_tracker::get_report(memory_tag::AUDIO).live_bytes, before.live_bytes);
+}
+
+static int new_handler_call_count = 0;
+
+TEST(memory_tracker, new_handler)
+{
+  if (!memory_tracker::is_enabled())
+    GTEST_SKIP() << "built without HNLL_TRACK_ALLOCATIONS.";
+
+  // called on the failure until it uninstalls itself
+  new_handler_call_count = 0;
+  std::set_new_handler([]() {
+    if (++new_handler_call_count == 2)
+      std::set_new_handler(nullptr);
+  });
+  // too large to be allocated
+  const size_t size = std::numeric_limits<size_t>::max() / 2;
+  EXPECT_THROW(static_cast<void>(::operator new(size)), std::bad_alloc);
+  EXPECT_EQ(new_handler_call_count, 2);
+
+  new_handler_call_count = 0;
+  std::set_new_handler([]() {
+    new_handler_call_count++;
+    throw std::bad_alloc();
+  });
+  EXPECT_EQ(::operator new(size, std::nothrow), nullptr);
+  EXPECT_EQ(new_handler_call_count, 1);
+  std::set_new_handler(nullptr);
+}
+
+TEST(memory_tracker, dump)
+{
+  auto path = (std::filesystem::temp_directory_path() / "hnll_memory.csv").string();
+  ASSERT_TRUE(memory_tracker::write_csv(path));
+
+  std::stringstream ss;
+  ss << std::ifstream(path).rdbuf();
+  std::filesystem::remove(path);
+  auto csv = ss.str();
+  EXPECT_EQ(csv.find("tag,live_bytes,peak_bytes,alloc_count,free_count,frame_alloc_count\n"), 0);
+  for (auto name : { "untagged,", "geometry,", "graphics,", "audio,", "physics,", "game," })
+    EXPECT_NE(csv.find(name), std::string::npos);
+}
+
+} // namespace hnll
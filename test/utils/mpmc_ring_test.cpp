@@ -0,0 +1,130 @@
+// hnll
+#include <utils/mpmc_ring.hpp>
+
+// std
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+#define JOIN_THREADS(threads) for (auto& t : threads) t.join()
+
+TEST(mpmc_ring, single_thread)
+{
+  utils::mpmc_ring<int> ring(3);
+  EXPECT_EQ(ring.capacity(), 4);
+
+  // wrap around several laps
+  for (int lap = 0; lap < 3; lap++) {
+    for (int i = 0; i < 4; i++)
+      EXPECT_TRUE(ring.try_push(i));
+    EXPECT_FALSE(ring.try_push(4));
+    EXPECT_EQ(ring.size(), 4);
+
+    for (int i = 0; i < 4; i++)
+      EXPECT_EQ(ring.try_pop(), i);
+    EXPECT_FALSE(ring.try_pop());
+    EXPECT_TRUE(ring.empty());
+  }
+
+  ring.push(1);
+  EXPECT_EQ(ring.pop(), 1);
+}
+
+TEST(mpmc_ring, batch)
+{
+  utils::mpmc_ring<int> ring(8);
+  std::vector<int> input = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+  // only the free slots are filled
+  EXPECT_EQ(ring.try_push_batch(input.begin(), 5), 5);
+  EXPECT_EQ(ring.try_push_batch(input.begin() + 5, 5), 3);
+
+  std::vector<int> output(10, -1);
+  EXPECT_EQ(ring.try_pop_batch(output.begin(), 10), 8);
+  for (int i = 0; i < 8; i++)
+    EXPECT_EQ(output[i], i);
+  EXPECT_EQ(ring.try_pop_batch(output.begin(), 10), 0);
+
+  ring.push_batch(input.begin(), 4);
+  ring.pop_batch(output.begin(), 4);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(output[i], i);
+}
+
+TEST(mpmc_ring, move_only)
+{
+  // remaining elements are destroyed with the ring
+  auto shared = std::make_shared<int>(0);
+  {
+    utils::mpmc_ring<u_ptr<s_ptr<int>>> ring(4);
+    ring.push(std::make_unique<s_ptr<int>>(shared));
+    ring.push(std::make_unique<s_ptr<int>>(shared));
+    EXPECT_EQ(**ring.pop(), 0);
+    EXPECT_EQ(shared.use_count(), 2);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+// every pushed value should be popped exactly once
+void test_producers_consumers(bool blocking, bool batch)
+{
+  utils::mpmc_ring<int> ring(64);
+  std::vector<std::atomic<int>> popped_counts(ELEMENT_COUNT * THREAD_COUNT);
+  std::atomic<int> total_popped = 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_COUNT; t++) {
+    // producer
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < ELEMENT_COUNT; ) {
+        int values[4] = { t * ELEMENT_COUNT + i, t * ELEMENT_COUNT + i + 1, t * ELEMENT_COUNT + i + 2, t * ELEMENT_COUNT + i + 3 };
+        size_t count = 0;
+        if (batch && blocking) { ring.push_batch(values, 4); count = 4; }
+        else if (batch) { count = ring.try_push_batch(values, 4); }
+        else if (blocking) { ring.push(values[0]); count = 1; }
+        else if (ring.try_push(values[0])) { count = 1; }
+
+        if (count == 0)
+          std::this_thread::yield();
+        i += static_cast<int>(count);
+      }
+    });
+    // consumer
+    threads.emplace_back([&]() {
+      for (int i = 0; i < ELEMENT_COUNT; ) {
+        int values[4];
+        size_t count = 0;
+        if (batch && blocking) { ring.pop_batch(values, 4); count = 4; }
+        else if (batch) { count = ring.try_pop_batch(values, 4); }
+        else if (blocking) { values[0] = ring.pop(); count = 1; }
+        else if (auto value = ring.try_pop(); value) { values[0] = *value; count = 1; }
+        if (count == 0)
+          std::this_thread::yield();
+
+        for (size_t j = 0; j < count; j++)
+          popped_counts[values[j]]++;
+        i += static_cast<int>(count);
+        total_popped += static_cast<int>(count);
+      }
+    });
+  }
+  JOIN_THREADS(threads);
+
+  EXPECT_EQ(total_popped, ELEMENT_COUNT * THREAD_COUNT);
+  for (const auto& count : popped_counts)
+    EXPECT_EQ(count, 1);
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(mpmc_ring, try_push_try_pop) { test_producers_consumers(false, false); }
+TEST(mpmc_ring, blocking_push_pop) { test_producers_consumers(true, false); }
+TEST(mpmc_ring, try_batch) { test_producers_consumers(false, true); }
+TEST(mpmc_ring, blocking_batch) { test_producers_consumers(true, true); }
+
+} // namespace hnll
@@ -194,4 +194,81 @@ TEST(mt_queue, push_front_pop_tail)
   }
 }
 
+TEST(ws_deque, push_pop_owner)
+{
+  utils::ws_deque<int> deque(4);
+
+  // grow beyond the initial capacity
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    deque.push(i);
+  }
+  EXPECT_EQ(deque.size(), ELEMENT_COUNT);
+
+  // owner pops in lifo order
+  for (int i = ELEMENT_COUNT - 1; i >= 0; i--) {
+    EXPECT_EQ(*deque.pop(), i);
+  }
+  EXPECT_FALSE(deque.pop());
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(ws_deque, steal_fifo)
+{
+  utils::ws_deque<int> deque;
+
+  for (int i = 0; i < 8; i++) {
+    deque.push(i);
+  }
+  // thieves take the oldest element
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(*deque.steal(), i);
+  }
+  EXPECT_FALSE(deque.steal());
+}
+
+TEST(ws_deque, owner_and_thieves)
+{
+  utils::ws_deque<int> deque(16);
+  std::atomic_bool owner_finished = false;
+  std::vector<int> owner_values;
+  std::vector<std::vector<int>> thief_values(THREAD_COUNT);
+
+  // thieves
+  std::vector<std::thread> threads(THREAD_COUNT);
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads[i] = std::thread([&, i]() {
+      while (true) {
+        // read the flag first, then make sure the deque is drained
+        bool finished = owner_finished;
+        if (auto value = deque.steal(); value)
+          thief_values[i].push_back(*value);
+        else if (finished && deque.empty())
+          break;
+      }
+    });
+  }
+
+  // owner pushes and pops concurrently with the thieves
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    deque.push(i);
+    if (i % 3 == 0) {
+      if (auto value = deque.pop(); value)
+        owner_values.push_back(*value);
+    }
+  }
+  owner_finished = true;
+
+  JOIN_THREADS(threads);
+
+  // every value is taken exactly once
+  std::vector<int> counts(ELEMENT_COUNT, 0);
+  for (auto v : owner_values) counts[v]++;
+  for (const auto& values : thief_values)
+    for (auto v : values) counts[v]++;
+
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    EXPECT_EQ(counts[i], 1);
+  }
+}
+
 } // namespace hnll
\ No newline at end of file
@@ -0,0 +1,116 @@
+// hnll
+#include <utils/parallel.hpp>
+
+// std
+#include <numeric>
+#include <string>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+
+TEST(parallel, parallel_for)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  std::vector<std::atomic<int>> counts(ELEMENT_COUNT);
+
+  // every index is visited exactly once
+  utils::parallel_for(pool, 0, ELEMENT_COUNT, [&counts](size_t i) { counts[i]++; });
+  for (const auto& count : counts)
+    EXPECT_EQ(count, 1);
+
+  // empty range
+  utils::parallel_for(pool, 10, 10, [&counts](size_t i) { counts[i]++; });
+  EXPECT_EQ(counts[10], 1);
+}
+
+TEST(parallel, parallel_for_chunk)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  constexpr size_t grain_size = 64;
+  std::atomic<size_t> total = 0;
+  std::atomic<bool> too_large = false;
+
+  utils::parallel_for(pool, 0, ELEMENT_COUNT, [&](size_t begin, size_t end) {
+    too_large = too_large || (end - begin > grain_size);
+    total += end - begin;
+  }, grain_size);
+
+  EXPECT_EQ(total, ELEMENT_COUNT);
+  EXPECT_FALSE(too_large);
+}
+
+TEST(parallel, nested_parallel_for)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  std::atomic<int> counter = 0;
+
+  // inner loops run on worker threads, which help each other while waiting
+  pool.submit([&]() {
+    utils::parallel_for(pool, 0, 100, [&](size_t) {
+      utils::parallel_for(pool, 0, 100, [&](size_t) { counter++; }, 8);
+    }, 1);
+  }).get();
+
+  EXPECT_EQ(counter, 100 * 100);
+}
+
+TEST(parallel, parallel_for_exception)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+
+  auto throw_in_middle = [](size_t i) {
+    if (i == ELEMENT_COUNT / 2)
+      throw std::runtime_error("error");
+  };
+  EXPECT_THROW(utils::parallel_for(pool, 0, ELEMENT_COUNT, throw_in_middle, 16), std::runtime_error);
+}
+
+TEST(parallel, parallel_reduce)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+
+  auto sum = utils::parallel_reduce(pool, 0, ELEMENT_COUNT, size_t(0),
+    [](size_t begin, size_t end, size_t init) {
+      for (auto i = begin; i < end; i++) init += i;
+      return init;
+    },
+    std::plus<>{});
+  EXPECT_EQ(sum, size_t(ELEMENT_COUNT) * (ELEMENT_COUNT - 1) / 2);
+
+  // non-commutative combine keeps the order
+  auto str = utils::parallel_reduce(pool, 0, 26, std::string{},
+    [](size_t begin, size_t end, std::string init) {
+      for (auto i = begin; i < end; i++) init += char('a' + i);
+      return init;
+    },
+    [](std::string a, std::string b) { return a + b; },
+    3);
+  EXPECT_EQ(str, "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST(parallel, parallel_scan)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  std::vector<int> input(ELEMENT_COUNT);
+  std::iota(input.begin(), input.end(), 0);
+
+  std::vector<int> expected(ELEMENT_COUNT);
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+
+  for (size_t grain_size : { 0, 1, 7, 1000, ELEMENT_COUNT * 2 }) {
+    std::vector<int> output(ELEMENT_COUNT);
+    utils::parallel_scan(pool, input.begin(), input.end(), output.begin(), 0, std::plus<>{}, grain_size);
+    EXPECT_EQ(output, expected);
+  }
+
+  // in place
+  utils::parallel_scan(pool, input.begin(), input.end(), input.begin(), 0, std::plus<>{});
+  EXPECT_EQ(input, expected);
+}
+
+} // namespace hnll
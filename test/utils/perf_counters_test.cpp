@@ -0,0 +1,197 @@
+// hnll
+#include <utils/perf_counters.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+static double burn_cpu(int count)
+{
+  volatile double x = 1.0;
+  for (int i = 0; i < count; i++)
+    x = x * 1.000001 + 0.5;
+  return x;
+}
+
+static utils::perf_sample make_sample(uint64_t cycles, uint64_t instructions)
+{
+  utils::perf_sample sample;
+  sample.values[static_cast<size_t>(utils::perf_counter::CYCLES)] = cycles;
+  sample.values[static_cast<size_t>(utils::perf_counter::INSTRUCTIONS)] = instructions;
+  sample.valid_mask = (1u << static_cast<uint32_t>(utils::perf_counter::CYCLES))
+                    | (1u << static_cast<uint32_t>(utils::perf_counter::INSTRUCTIONS));
+  return sample;
+}
+
+TEST(perf_counters, sample)
+{
+  auto a = make_sample(1000, 2000);
+  auto b = make_sample(400, 500);
+  auto d = a - b;
+  EXPECT_EQ(d.get(utils::perf_counter::CYCLES), 600);
+  EXPECT_EQ(d.get(utils::perf_counter::INSTRUCTIONS), 1500);
+  EXPECT_DOUBLE_EQ(d.get_ipc(), 2.5);
+  // unavailable counters
+  EXPECT_FALSE(d.has(utils::perf_counter::CACHE_MISSES));
+  EXPECT_EQ(d.get_cache_miss_rate(), 0.0);
+  // never wraps
+  EXPECT_EQ((b - a).get(utils::perf_counter::CYCLES), 0);
+
+  d += b;
+  EXPECT_EQ(d.get(utils::perf_counter::CYCLES), 1000);
+}
+
+TEST(perf_counters, empty_group)
+{
+  utils::perf_counter_group group(0);
+  EXPECT_FALSE(group.is_available());
+  EXPECT_EQ(group.read().valid_mask, 0);
+}
+
+TEST(perf_counters, group)
+{
+  utils::perf_counter_group group;
+  if (!group.is_available())
+    GTEST_SKIP() << "perf counters are unavailable : " << group.get_error();
+  // some counters may be unavailable, but the error is reported
+  if (group.get_valid_mask() != utils::perf_counter_group::ALL_COUNTERS) {
+    EXPECT_FALSE(group.get_error().empty());
+  }
+
+  auto start = group.read();
+  burn_cpu(1'000'000);
+  auto end = group.read();
+  auto delta = end - start;
+  EXPECT_NE(delta.valid_mask, 0);
+  if (delta.has(utils::perf_counter::INSTRUCTIONS)) {
+    EXPECT_GT(delta.get(utils::perf_counter::INSTRUCTIONS), 1'000'000);
+  }
+  if (delta.has(utils::perf_counter::TASK_CLOCK)) {
+    EXPECT_GT(delta.get(utils::perf_counter::TASK_CLOCK), 0);
+  }
+
+  // counts of this thread can be read by the other threads
+  std::thread reader([&group, &end]() {
+    auto sample = group.read();
+    EXPECT_EQ(sample.valid_mask, end.valid_mask);
+    if (sample.has(utils::perf_counter::INSTRUCTIONS)) {
+      EXPECT_GE(sample.get(utils::perf_counter::INSTRUCTIONS), end.get(utils::perf_counter::INSTRUCTIONS));
+    }
+  });
+  reader.join();
+
+  group.reset();
+  auto after_reset = group.read();
+  if (after_reset.has(utils::perf_counter::INSTRUCTIONS)) {
+    EXPECT_LT(after_reset.get(utils::perf_counter::INSTRUCTIONS), end.get(utils::perf_counter::INSTRUCTIONS));
+  }
+}
+
+TEST(perf_counters, scope)
+{
+  using utils::perf_counters;
+  auto id = perf_counters::register_scope("perf test scope");
+  EXPECT_EQ(perf_counters::register_scope("perf test scope"), id);
+  perf_counters::clear();
+
+  // recorded by the finished threads and this thread
+  constexpr int THREAD_COUNT = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_COUNT; t++) {
+    threads.emplace_back([id, t]() {
+      perf_counters::set_thread_name("perf test thread " + std::to_string(t));
+      perf_counters::record(id, make_sample(100, 200));
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  perf_counters::record(id, make_sample(100, 200));
+
+  bool found = false;
+  for (const auto& s : perf_counters::get_scope_summaries()) {
+    if (s.name != "perf test scope")
+      continue;
+    found = true;
+    EXPECT_EQ(s.count, THREAD_COUNT + 1);
+    EXPECT_EQ(s.total.get(utils::perf_counter::CYCLES), 100 * (THREAD_COUNT + 1));
+    EXPECT_DOUBLE_EQ(s.total.get_ipc(), 2.0);
+  }
+  EXPECT_TRUE(found);
+
+  int thread_count = 0;
+  for (const auto& t : perf_counters::get_thread_summaries())
+    if (t.name.starts_with("perf test thread"))
+      thread_count++;
+  EXPECT_EQ(thread_count, THREAD_COUNT);
+
+  // a real scope records only if the counters are available
+  {
+    utils::perf_scope scope(id);
+    burn_cpu(1000);
+  }
+  for (const auto& s : perf_counters::get_scope_summaries()) {
+    if (s.name == "perf test scope") {
+      EXPECT_EQ(s.count, perf_counters::get_thread_group() ? THREAD_COUNT + 2 : THREAD_COUNT + 1);
+    }
+  }
+
+  perf_counters::clear();
+  for (const auto& s : perf_counters::get_scope_summaries())
+    EXPECT_NE(s.name, "perf test scope");
+}
+
+TEST(perf_counters, csv)
+{
+  auto id = utils::perf_counters::register_scope("perf csv scope");
+  utils::perf_counters::record(id, make_sample(100, 300));
+
+  auto path = (std::filesystem::temp_directory_path() / "hnll_perf_counters.csv").string();
+  ASSERT_TRUE(utils::perf_counters::write_csv(path));
+
+  std::ifstream file(path);
+  std::string header, line;
+  std::getline(file, header);
+  EXPECT_EQ(header.rfind("kind,name,count,cycles,instructions", 0), 0);
+  bool found = false;
+  while (std::getline(file, line))
+    if (line.rfind("scope,perf csv scope,1,100,300", 0) == 0)
+      found = true;
+  EXPECT_TRUE(found);
+}
+
+TEST(perf_counters, too_many_scopes)
+{
+  using utils::perf_counters;
+  perf_counters::scope_id last_id = 0;
+  // the names are copied, the temporaries may be destroyed
+  for (size_t i = 0; i < perf_counters::MAX_SCOPE_COUNT; i++) {
+    auto name = "perf overflow scope " + std::to_string(i);
+    last_id = perf_counters::register_scope(name.c_str());
+  }
+  // the other tests registered some scopes before
+  EXPECT_EQ(last_id, perf_counters::INVALID_SCOPE_ID);
+
+  auto get_total_count = []() {
+    uint64_t count = 0;
+    for (const auto& s : perf_counters::get_scope_summaries())
+      count += s.count;
+    return count;
+  };
+  auto count = get_total_count();
+  // ignored
+  perf_counters::record(last_id, make_sample(100, 200));
+  {
+    utils::perf_scope scope(last_id);
+  }
+  EXPECT_EQ(get_total_count(), count);
+}
+
+} // namespace hnll
@@ -0,0 +1,175 @@
+// hnll
+#include <utils/profiler.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+#define JOIN_THREADS(threads) for (auto& t : threads) t.join()
+
+std::string write_and_read_trace()
+{
+  auto path = (std::filesystem::temp_directory_path() / "hnll_profiler_test.json").string();
+  EXPECT_TRUE(utils::profiler::write_trace(path));
+  std::ifstream file(path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  std::filesystem::remove(path);
+  return ss.str();
+}
+
+size_t count_occurrences(const std::string& str, const std::string& pattern)
+{
+  size_t count = 0;
+  for (auto pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+    count++;
+  return count;
+}
+
+TEST(profiler, scope)
+{
+  utils::profiler::clear();
+  {
+    utils::profile_scope scope("outer");
+    utils::profile_scope inner("inner");
+    utils::profiler::instant("marker");
+    utils::profiler::counter("value", 42.0);
+  }
+  utils::profiler::collect();
+  EXPECT_EQ(utils::profiler::get_event_count(), 6);
+
+  auto trace = write_and_read_trace();
+  EXPECT_EQ(trace.front(), '{');
+  EXPECT_EQ(count_occurrences(trace, "\"ph\":\"B\""), 2);
+  EXPECT_EQ(count_occurrences(trace, "\"ph\":\"E\""), 2);
+  EXPECT_EQ(count_occurrences(trace, "\"name\":\"outer\""), 1);
+  EXPECT_EQ(count_occurrences(trace, "\"name\":\"marker\""), 1);
+  EXPECT_NE(trace.find("\"args\":{\"value\":42.000}"), std::string::npos);
+}
+
+TEST(profiler, timestamps_are_monotonic)
+{
+  utils::profiler::clear();
+  auto begin = utils::profiler::now();
+  {
+    utils::profile_scope scope("sleep");
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_GT(utils::profiler::now(), begin);
+
+  auto trace = write_and_read_trace();
+  auto ts = [&trace](const std::string& ph) {
+    auto pos = trace.find("\"ph\":\"" + ph + "\"");
+    pos = trace.find("\"ts\":", pos);
+    return std::stod(trace.substr(pos + 5));
+  };
+  // in microseconds
+  EXPECT_GE(ts("E") - ts("B"), 1000.0);
+}
+
+TEST(profiler, multi_thread)
+{
+  utils::profiler::clear();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([i]() {
+      utils::profiler::set_thread_name("test thread " + std::to_string(i));
+      for (int j = 0; j < ELEMENT_COUNT; j++) {
+        utils::profile_scope scope("work");
+        // collect concurrently
+        if (i == 0 && j % 100 == 0)
+          utils::profiler::collect();
+      }
+    });
+  }
+  JOIN_THREADS(threads);
+
+  utils::profiler::collect();
+  EXPECT_EQ(utils::profiler::get_event_count() + utils::profiler::get_dropped_count(), THREAD_COUNT * ELEMENT_COUNT * 2);
+
+  auto trace = write_and_read_trace();
+  for (int i = 0; i < THREAD_COUNT; i++)
+    EXPECT_EQ(count_occurrences(trace, "\"name\":\"test thread " + std::to_string(i) + "\""), 1);
+
+  // buffers of the finished threads are released
+  utils::profiler::clear();
+  EXPECT_EQ(write_and_read_trace().find("test thread"), std::string::npos);
+}
+
+TEST(profiler, full_buffer_drops_events)
+{
+  utils::profiler::clear();
+  std::thread thread([]() {
+    for (size_t i = 0; i < utils::profiler::EVENTS_PER_THREAD + ELEMENT_COUNT; i++)
+      utils::profiler::instant("event");
+  });
+  thread.join();
+
+  utils::profiler::collect();
+  EXPECT_EQ(utils::profiler::get_event_count(), utils::profiler::EVENTS_PER_THREAD);
+  EXPECT_EQ(utils::profiler::get_dropped_count(), ELEMENT_COUNT);
+  utils::profiler::clear();
+}
+
+TEST(profiler, full_buffer_keeps_scopes_balanced)
+{
+  utils::profiler::clear();
+  std::thread thread([]() {
+    utils::profile_scope outer("outer");
+    for (size_t i = 0; i < utils::profiler::EVENTS_PER_THREAD; i++)
+      utils::profiler::instant("event");
+    {
+      utils::profile_scope dropped("dropped");
+      // the ring has room again, but the rest of the dropped scope is not recorded
+      utils::profiler::collect();
+      utils::profile_scope inner("inner");
+    }
+  });
+  thread.join();
+
+  auto trace = write_and_read_trace();
+  EXPECT_EQ(count_occurrences(trace, "\"ph\":\"B\""), 1);
+  EXPECT_EQ(count_occurrences(trace, "\"ph\":\"E\""), 1);
+  EXPECT_EQ(count_occurrences(trace, "\"name\":\"outer\""), 1);
+  EXPECT_EQ(count_occurrences(trace, "\"name\":\"inner\""), 0);
+  utils::profiler::clear();
+}
+
+TEST(profiler, collected_events_are_capped)
+{
+  constexpr size_t MAX_EVENTS = 1000;
+  utils::profiler::clear();
+  utils::profiler::set_max_collected_events(MAX_EVENTS);
+  std::thread thread([]() {
+    utils::profile_scope outer("outer");
+    for (int frame = 0; frame < 10; frame++) {
+      utils::profile_scope scope("frame");
+      for (size_t i = 0; i < MAX_EVENTS / 2; i++)
+        utils::profiler::instant("event");
+      utils::profiler::collect();
+    }
+  });
+  thread.join();
+
+  utils::profiler::collect();
+  EXPECT_LE(utils::profiler::get_event_count(), MAX_EVENTS);
+  EXPECT_EQ(utils::profiler::get_event_count() + utils::profiler::get_dropped_count(), 10 * (MAX_EVENTS / 2 + 2) + 2);
+  // the oldest frames are dropped, the outer scope is kept
+  auto trace = write_and_read_trace();
+  EXPECT_EQ(count_occurrences(trace, "\"ph\":\"B\""), count_occurrences(trace, "\"ph\":\"E\""));
+  EXPECT_EQ(count_occurrences(trace, "\"name\":\"outer\""), 1);
+  utils::profiler::set_max_collected_events(utils::profiler::MAX_COLLECTED_EVENTS);
+  utils::profiler::clear();
+}
+
+} // namespace hnll
@@ -0,0 +1,244 @@
+// hnll
+#include <utils/scope_stats.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+#define JOIN_THREADS(threads) for (auto& t : threads) t.join()
+
+utils::scope_stats::summary find_summary(const std::string& name)
+{
+  for (const auto& s : utils::scope_stats::get_summaries())
+    if (s.name == name)
+      return s;
+  ADD_FAILURE() << name << " is not summarized.";
+  return {};
+}
+
+TEST(scope_stats, bucket_index)
+{
+  using hist = utils::latency_histogram;
+  // exact below the sub bucket count
+  for (uint64_t v = 0; v < hist::SUB_BUCKET_COUNT; v++) {
+    EXPECT_EQ(hist::get_bucket_index(v), v);
+    EXPECT_EQ(hist::get_bucket_value(v), v);
+  }
+  // the relative error is bounded and indices are monotonic
+  size_t prev_index = 0;
+  for (uint64_t v = 1; v < (uint64_t(1) << 36); v = v * 3 / 2 + 1) {
+    auto index = hist::get_bucket_index(v);
+    EXPECT_GE(index, prev_index);
+    EXPECT_LT(index, hist::BUCKET_COUNT);
+    auto error = std::abs(static_cast<double>(hist::get_bucket_value(index)) - v) / v;
+    EXPECT_LE(error, 1.0 / hist::SUB_BUCKET_COUNT);
+    prev_index = index;
+  }
+  // clamped
+  EXPECT_EQ(hist::get_bucket_index(UINT64_MAX), hist::BUCKET_COUNT - 1);
+}
+
+TEST(scope_stats, percentiles)
+{
+  utils::latency_histogram histogram;
+  // 1 us ... 10 ms uniformly in a shuffled order
+  std::vector<uint64_t> values;
+  for (int i = 1; i <= ELEMENT_COUNT; i++)
+    values.emplace_back(i * 1000);
+  std::shuffle(values.begin(), values.end(), std::mt19937{ 0 });
+  for (auto v : values)
+    histogram.record(v);
+
+  utils::histogram_snapshot snapshot;
+  histogram.drain_into(snapshot);
+  EXPECT_EQ(snapshot.count, ELEMENT_COUNT);
+  EXPECT_EQ(snapshot.min, 1000);
+  EXPECT_EQ(snapshot.max, ELEMENT_COUNT * 1000);
+  EXPECT_DOUBLE_EQ(snapshot.get_mean(), (ELEMENT_COUNT + 1) * 500.0);
+  EXPECT_NEAR(snapshot.get_percentile(50.0), 5'000'000, 5'000'000 / 16);
+  EXPECT_NEAR(snapshot.get_percentile(99.0), 9'900'000, 9'900'000 / 16);
+  EXPECT_EQ(snapshot.get_percentile(100.0), ELEMENT_COUNT * 1000);
+
+  // drained
+  utils::histogram_snapshot empty;
+  histogram.drain_into(empty);
+  EXPECT_EQ(empty.count, 0);
+}
+
+TEST(scope_stats, consistent_snapshot)
+{
+  utils::latency_histogram histogram;
+  std::atomic<bool> done = false;
+  std::thread owner([&histogram, &done]() {
+    for (int i = 0; i < ELEMENT_COUNT * 10; i++)
+      histogram.record(1000 + i % 2);
+    done = true;
+  });
+
+  // every drained snapshot holds whole records
+  uint64_t count = 0;
+  auto drain = [&histogram, &count]() {
+    utils::histogram_snapshot snapshot;
+    histogram.drain_into(snapshot);
+    count += snapshot.count;
+    if (snapshot.count > 0) {
+      EXPECT_GE(snapshot.sum, snapshot.count * 1000);
+      EXPECT_LE(snapshot.sum, snapshot.count * 1001);
+      EXPECT_GE(snapshot.min, 1000);
+      EXPECT_LE(snapshot.max, 1001);
+    }
+  };
+  while (!done)
+    drain();
+  owner.join();
+  drain();
+  EXPECT_EQ(count, ELEMENT_COUNT * 10);
+}
+
+TEST(scope_stats, tail_latency)
+{
+  // 1 % of hitches show up in p99 but not in the mean or p50
+  auto id = utils::scope_stats::register_scope("tail_latency");
+  utils::scope_stats::summarize();
+  for (int i = 0; i < ELEMENT_COUNT; i++)
+    utils::scope_stats::record(id, i % 100 == 99 ? 20'000'000 : 1'000'000);
+  utils::scope_stats::summarize();
+
+  auto s = find_summary("tail_latency");
+  EXPECT_EQ(s.count, ELEMENT_COUNT);
+  EXPECT_NEAR(s.p50, 1000.0, 1000.0 / 16);
+  EXPECT_NEAR(s.p99, 1000.0, 1000.0 / 16);
+  EXPECT_DOUBLE_EQ(s.max, 20000.0);
+  EXPECT_LT(s.mean, 1200.0);
+
+  // 2 % of hitches
+  for (int i = 0; i < ELEMENT_COUNT; i++)
+    utils::scope_stats::record(id, i % 50 == 49 ? 20'000'000 : 1'000'000);
+  utils::scope_stats::summarize();
+  EXPECT_NEAR(find_summary("tail_latency").p99, 20000.0, 20000.0 / 16);
+}
+
+TEST(scope_stats, frame_window)
+{
+  auto id = utils::scope_stats::register_scope("frame_window");
+  EXPECT_EQ(utils::scope_stats::register_scope("frame_window"), id);
+  utils::scope_stats::summarize();
+  utils::scope_stats::set_frame_window(10);
+
+  for (int frame = 0; frame < 9; frame++) {
+    utils::scope_stats::record(id, 1000);
+    utils::scope_stats::end_frame();
+  }
+  // not summarized yet
+  for (const auto& s : utils::scope_stats::get_summaries())
+    EXPECT_NE(s.name, "frame_window");
+
+  utils::scope_stats::record(id, 1000);
+  utils::scope_stats::end_frame();
+  EXPECT_EQ(find_summary("frame_window").count, 10);
+
+  utils::scope_stats::set_frame_window(utils::scope_stats::DEFAULT_FRAME_WINDOW);
+}
+
+TEST(scope_stats, multi_thread)
+{
+  auto id = utils::scope_stats::register_scope("multi_thread");
+  utils::scope_stats::summarize();
+
+  std::vector<std::thread> threads;
+  std::atomic<bool> done = false;
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([id, i]() {
+      for (int j = 0; j < ELEMENT_COUNT; j++) {
+        utils::stat_scope scope(id);
+        // per-thread values
+        utils::scope_stats::record(id, (i + 1) * 1000);
+      }
+    });
+  }
+  // summarize and dump concurrently, no value is lost
+  uint64_t count = 0;
+  auto summarize = [&count]() {
+    utils::scope_stats::summarize();
+    for (const auto& s : utils::scope_stats::get_summaries())
+      if (s.name == "multi_thread")
+        count += s.count;
+  };
+  std::thread reporter([&done, &summarize]() {
+    while (!done)
+      summarize();
+  });
+  JOIN_THREADS(threads);
+  done = true;
+  reporter.join();
+
+  summarize();
+  EXPECT_EQ(count, THREAD_COUNT * ELEMENT_COUNT * 2);
+}
+
+TEST(scope_stats, dump)
+{
+  auto id = utils::scope_stats::register_scope("dump");
+  utils::scope_stats::record(id, 2000);
+  utils::scope_stats::summarize();
+
+  auto read_file = [](const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::filesystem::remove(path);
+    return ss.str();
+  };
+  auto dir = std::filesystem::temp_directory_path();
+
+  ASSERT_TRUE(utils::scope_stats::write_csv((dir / "hnll_scope_stats.csv").string()));
+  auto csv = read_file((dir / "hnll_scope_stats.csv").string());
+  EXPECT_EQ(csv.find("name,count,min_us,mean_us,p50_us,p99_us,max_us\n"), 0);
+  EXPECT_NE(csv.find("dump,1,2,2,2,2,2\n"), std::string::npos);
+
+  ASSERT_TRUE(utils::scope_stats::write_json((dir / "hnll_scope_stats.json").string()));
+  auto json = read_file((dir / "hnll_scope_stats.json").string());
+  EXPECT_NE(json.find("{\"name\":\"dump\",\"count\":1,\"min_us\":2,\"mean_us\":2,\"p50_us\":2,\"p99_us\":2,\"max_us\":2}"), std::string::npos);
+
+  // names are escaped
+  utils::scope_stats::record(utils::scope_stats::register_scope("dump \"quoted\"\\path\n"), 2000);
+  utils::scope_stats::summarize();
+  ASSERT_TRUE(utils::scope_stats::write_json((dir / "hnll_scope_stats.json").string()));
+  json = read_file((dir / "hnll_scope_stats.json").string());
+  EXPECT_NE(json.find("{\"name\":\"dump \\\"quoted\\\"\\\\path\\n\",\"count\":1,"), std::string::npos);
+}
+
+TEST(scope_stats, too_many_scopes)
+{
+  utils::scope_stats::scope_id last_id = 0;
+  // the names are copied, the temporaries may be destroyed
+  for (size_t i = 0; i < utils::scope_stats::MAX_SCOPE_COUNT; i++) {
+    auto name = "overflow scope " + std::to_string(i);
+    last_id = utils::scope_stats::register_scope(name.c_str());
+  }
+  // the other tests registered some scopes before
+  EXPECT_EQ(last_id, utils::scope_stats::INVALID_SCOPE_ID);
+
+  // ignored
+  utils::scope_stats::record(last_id, 1000);
+  {
+    utils::stat_scope scope(last_id);
+  }
+  utils::scope_stats::summarize();
+  EXPECT_TRUE(utils::scope_stats::get_summaries().empty());
+}
+
+} // namespace hnll
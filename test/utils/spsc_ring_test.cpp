@@ -0,0 +1,82 @@
+// hnll
+#include <utils/spsc_ring.hpp>
+
+// std
+#include <thread>
+#include <vector>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+TEST(spsc_ring, single_thread)
+{
+  utils::spsc_ring<short> ring(5);
+  EXPECT_EQ(ring.capacity(), 8);
+  EXPECT_EQ(ring.writable_count(), 8);
+
+  std::vector<short> input = { 0, 1, 2, 3, 4, 5 };
+  EXPECT_EQ(ring.write(input), 6);
+  EXPECT_EQ(ring.readable_count(), 6);
+
+  std::vector<short> output(4);
+  EXPECT_EQ(ring.read(output), 4);
+  EXPECT_EQ(output, std::vector<short>({ 0, 1, 2, 3 }));
+
+  // wraps around the end of the buffer
+  EXPECT_EQ(ring.write(input), 6);
+  EXPECT_EQ(ring.write(input), 0);
+
+  // contiguous spans stop at the end of the buffer
+  auto span = ring.peek_read();
+  EXPECT_EQ(span.size(), 4);
+  EXPECT_EQ(span[0], 4);
+  ring.commit_read(span.size());
+  span = ring.peek_read();
+  EXPECT_EQ(span.size(), 4);
+  EXPECT_EQ(span[3], 5);
+  ring.commit_read(span.size());
+  EXPECT_EQ(ring.readable_count(), 0);
+}
+
+// samples should arrive without loss or reordering
+TEST(spsc_ring, stress)
+{
+  utils::spsc_ring<uint32_t> ring(1000);
+  constexpr uint32_t sample_count = 1 << 22;
+
+  // producer writes in place with varying chunk sizes
+  std::thread producer([&ring]() {
+    uint32_t next = 0;
+    size_t chunk = 1;
+    while (next < sample_count) {
+      auto span = ring.prepare_write(std::min<size_t>(chunk, sample_count - next));
+      for (auto& sample : span)
+        sample = next++;
+      ring.commit_write(span.size());
+      chunk = chunk % 700 + 1;
+      if (span.empty())
+        std::this_thread::yield();
+    }
+  });
+
+  // consumer copies out with another chunk pattern
+  uint32_t expected = 0;
+  bool ordered = true;
+  std::vector<uint32_t> buffer(333);
+  while (expected < sample_count) {
+    auto count = ring.read(buffer);
+    for (size_t i = 0; i < count; i++)
+      ordered &= buffer[i] == expected++;
+    if (count == 0)
+      std::this_thread::yield();
+  }
+  producer.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(expected, sample_count);
+  EXPECT_EQ(ring.readable_count(), 0);
+}
+
+} // namespace hnll
@@ -0,0 +1,95 @@
+// hnll
+#include <utils/task_graph.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+namespace hnll {
+
+constexpr int THREAD_COUNT = 4;
+constexpr int ELEMENT_COUNT = 10000;
+
+TEST(task_graph, dependency_order)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  utils::task_graph graph;
+  std::atomic<int> step = 0;
+  int a_step = -1, b_step = -1, c_step = -1, d_step = -1;
+
+  // diamond : a -> (b, c) -> d
+  auto a = graph.add_task([&]() { a_step = step++; });
+  auto b = graph.add_continuation(a, [&]() { b_step = step++; });
+  auto c = graph.add_continuation(a, [&]() { c_step = step++; });
+  auto d = graph.add_task([&]() { d_step = step++; });
+  graph.add_dependency(b, d);
+  graph.add_dependency(c, d);
+
+  graph.run(pool);
+
+  EXPECT_EQ(a_step, 0);
+  EXPECT_LT(a_step, b_step);
+  EXPECT_LT(a_step, c_step);
+  EXPECT_EQ(d_step, 3);
+}
+
+TEST(task_graph, rerun)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  utils::task_graph graph;
+  std::vector<int> values(100, 0);
+
+  // chains of 2 tasks, the second one reads the result of the first
+  for (int i = 0; i < 50; i++) {
+    auto first = graph.add_task([&values, i]() { values[i]++; });
+    graph.add_continuation(first, [&values, i]() { values[i + 50] = values[i]; });
+  }
+  EXPECT_EQ(graph.get_task_count(), 100);
+
+  // built once, run every frame
+  for (int frame = 1; frame <= 100; frame++) {
+    graph.run(pool);
+    for (int i = 0; i < 50; i++) {
+      EXPECT_EQ(values[i], frame);
+      EXPECT_EQ(values[i + 50], frame);
+    }
+  }
+}
+
+TEST(task_graph, wide_graph)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  utils::task_graph graph;
+  std::atomic<int> counter = 0;
+  int result = 0;
+
+  // fan out and join
+  auto root = graph.add_task([]() {});
+  auto join = graph.add_task([&]() { result = counter; });
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    auto id = graph.add_continuation(root, [&counter]() { counter++; });
+    graph.add_dependency(id, join);
+  }
+
+  graph.run(pool);
+  EXPECT_EQ(result, ELEMENT_COUNT);
+}
+
+TEST(task_graph, exception_and_cycle)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  utils::task_graph graph;
+  bool continued = false;
+
+  auto a = graph.add_task([]() { throw std::runtime_error("error"); });
+  graph.add_continuation(a, [&]() { continued = true; });
+  EXPECT_THROW(graph.run(pool), std::runtime_error);
+  EXPECT_TRUE(continued);
+
+  graph.clear();
+  auto b = graph.add_task([]() {});
+  auto c = graph.add_continuation(b, []() {});
+  graph.add_dependency(c, b);
+  EXPECT_THROW(graph.run(pool), std::runtime_error);
+}
+
+} // namespace hnll
@@ -1,9 +1,51 @@
 // hnll
 #include <utils/thread_pool.hpp>
+#include <utils/memory_tracker.hpp>
+
+// std
+#include <pthread.h>
+#include <sys/resource.h>
+#include <array>
+#include <cstdlib>
+#include <set>
+#include <thread>
 
 // lib
 #include <gtest/gtest.h>
 
+// count heap allocations in this test binary
+#ifdef HNLL_TRACK_ALLOCATIONS
+// operator new is already replaced by the memory tracker
+static size_t get_allocation_count()
+{
+  // get_reports() allocates
+  size_t count = 0;
+  for (size_t i = 0; i < hnll::utils::MEMORY_TAG_COUNT; i++)
+    count += hnll::utils::memory_tracker::get_report(static_cast<hnll::utils::memory_tag>(i)).alloc_count;
+  return count;
+}
+#else
+static std::atomic<size_t> allocation_count = 0;
+
+static void* counted_malloc(std::size_t size)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+// every non-aligned form is replaced, so that new and delete always come in matching pairs
+void* operator new(std::size_t size)   { return counted_malloc(size); }
+void* operator new[](std::size_t size) { return counted_malloc(size); }
+void operator delete(void* ptr) noexcept                { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept   { std::free(ptr); }
+void operator delete[](void* ptr) noexcept              { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+static size_t get_allocation_count() { return allocation_count.load(); }
+#endif
+
 namespace hnll {
 
 constexpr int THREAD_COUNT = 4;
@@ -11,7 +53,7 @@ constexpr int ELEMENT_COUNT = 10000;
 #define JOIN_THREADS(threads) for (auto& t : threads) t.join()
 
 int task() { return 0; }
-int task_with_args(float d, bool b) { return 1; }
+int task_with_args(float, bool) { return 1; }
 
 TEST(thread_pool, single_task)
 {
@@ -32,7 +74,7 @@ TEST(thread_pool, multiple_task)
 
   auto begin = std::chrono::system_clock::now();
 
-  for (int i = 0; i < std::thread::hardware_concurrency(); i++) {
+  for (unsigned i = 0; i < std::thread::hardware_concurrency(); i++) {
     // 100 ms
     tp.submit([]() { std::this_thread::sleep_for(std::chrono::milliseconds(100)); });
     // 1.2 sec
@@ -70,8 +112,8 @@ TEST(thread_pool, work_stealing)
   std::vector <std::future<int>> futures;
   utils::thread_pool pool;
 
-  for (int i = 0; i < std::thread::hardware_concurrency(); i++) { // std::thread::hardware_concurrency(); i++) {
-    int k = i;
+  for (unsigned i = 0; i < std::thread::hardware_concurrency(); i++) { // std::thread::hardware_concurrency(); i++) {
+    int k = static_cast<int>(i);
     futures.emplace_back(pool.submit(recursive_wait, pool, std::move(k)));
   }
 
@@ -80,7 +122,9 @@ TEST(thread_pool, work_stealing)
     ans += future.get();
   }
 
-  EXPECT_EQ(ans, 78);
+  // sum of 1 ~ hardware_concurrency (78 on 12 threads)
+  const int n = std::thread::hardware_concurrency();
+  EXPECT_EQ(ans, n * (n + 1) / 2);
 
   // 6.6 sec
 //  ans = 0;
@@ -91,4 +135,243 @@ TEST(thread_pool, work_stealing)
 //  EXPECT_EQ(ans, 78);
 }
 
+TEST(thread_pool, local_queue_stealing)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  std::atomic<int> counter = 0;
+
+  // tasks submitted from a worker thread go to its lock-free local queue
+  auto root = pool.submit([&pool, &counter]() {
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < ELEMENT_COUNT; i++) {
+      futures.emplace_back(pool.submit([&counter]() { counter++; }));
+    }
+    // other workers steal the tasks while this worker is blocked
+    for (auto& future : futures) {
+      future.get();
+    }
+  });
+
+  root.get();
+  EXPECT_EQ(counter, ELEMENT_COUNT);
+}
+
+TEST(thread_pool, wait_for_all_tasks)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  std::atomic<int> counter = 0;
+
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    pool.submit([&counter]() { counter++; });
+  }
+  pool.wait_for_all_tasks();
+  EXPECT_EQ(counter, ELEMENT_COUNT);
+
+  // returns immediately if there is no task
+  pool.wait_for_all_tasks();
+}
+
+std::chrono::microseconds get_process_cpu_time()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  auto to_us = [](const timeval& t) { return std::chrono::seconds(t.tv_sec) + std::chrono::microseconds(t.tv_usec); };
+  return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+TEST(thread_pool, idle_cpu_usage)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  // let workers park
+  pool.submit([]() {}).get();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  const auto idle_duration = std::chrono::milliseconds(500);
+  auto begin = get_process_cpu_time();
+  std::this_thread::sleep_for(idle_duration);
+  auto cpu_time = get_process_cpu_time() - begin;
+
+  // spinning workers would consume THREAD_COUNT * 500 ms
+  EXPECT_LT(cpu_time, idle_duration / 10);
+  RecordProperty("idle_cpu_time_us", static_cast<int>(cpu_time.count()));
+}
+
+TEST(thread_pool, wake_up_latency)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  constexpr int trial_count = 100;
+
+  std::chrono::nanoseconds total{};
+  for (int i = 0; i < trial_count; i++) {
+    // make sure all the workers are parked
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto begin = std::chrono::steady_clock::now();
+    auto started = pool.submit([]() { return std::chrono::steady_clock::now(); }).get();
+    total += started - begin;
+  }
+  auto average = std::chrono::duration_cast<std::chrono::microseconds>(total / trial_count);
+
+  // generous bound for loaded machines, typically tens of microseconds
+  EXPECT_LT(average, std::chrono::milliseconds(5));
+  RecordProperty("average_wake_up_latency_us", static_cast<int>(average.count()));
+}
+
+TEST(thread_pool, function_wrapper)
+{
+  int value = 0;
+  // small callable is stored in place, large one on the heap
+  utils::function_wrapper small{ [&value]() { value += 1; } };
+  std::array<int, 64> array{};
+  array[63] = 10;
+  utils::function_wrapper large{ [&value, array]() { value += array[63]; } };
+
+  auto moved_small = std::move(small);
+  auto moved_large = std::move(large);
+  EXPECT_FALSE(small);
+  EXPECT_FALSE(large);
+  moved_small();
+  moved_large();
+  EXPECT_EQ(value, 11);
+
+  // captured objects are destroyed once
+  auto shared = std::make_shared<int>(0);
+  {
+    utils::function_wrapper f{ [shared]() {} };
+    auto g = std::move(f);
+    f = std::move(g);
+    EXPECT_EQ(shared.use_count(), 2);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(thread_pool, allocation_free_submit)
+{
+  utils::thread_pool pool(THREAD_COUNT);
+  constexpr int task_count = 1000;
+  std::atomic<int> counter = 0;
+
+  auto submit_one_by_one = [&]() {
+    for (int i = 0; i < task_count; i++)
+      pool.submit([&counter](int k) { counter += k; return k; }, 1).get();
+  };
+  auto submit_burst = [&]() {
+    std::array<std::future<void>, task_count> futures;
+    for (auto& future : futures)
+      future = pool.submit([&counter]() { counter++; });
+    for (auto& future : futures)
+      future.get();
+  };
+
+  // warm up the free lists of each thread
+  for (int i = 0; i < 3; i++) {
+    submit_one_by_one();
+    submit_burst();
+  }
+
+  auto allocation_count = get_allocation_count();
+  submit_one_by_one();
+  submit_burst();
+
+  EXPECT_EQ(get_allocation_count() - allocation_count, 0);
+  EXPECT_EQ(counter, task_count * 2 * 4);
+}
+
+utils::lane_configs make_lane_configs(unsigned realtime, unsigned frame, unsigned background)
+{
+  utils::lane_configs configs;
+  configs[static_cast<size_t>(utils::task_priority::REALTIME)].worker_count = realtime;
+  configs[static_cast<size_t>(utils::task_priority::FRAME)].worker_count = frame;
+  configs[static_cast<size_t>(utils::task_priority::BACKGROUND)].worker_count = background;
+  return configs;
+}
+
+TEST(thread_pool, lanes)
+{
+  utils::thread_pool pool(make_lane_configs(1, 2, 1));
+  EXPECT_EQ(pool.get_thread_count(), 4);
+  EXPECT_EQ(pool.get_thread_count(utils::task_priority::REALTIME), 1);
+
+  auto get_thread_ids = [&pool](utils::task_priority priority) {
+    std::set<std::thread::id> ids;
+    for (int i = 0; i < 100; i++)
+      ids.insert(pool.submit(priority, []() { return std::this_thread::get_id(); }).get());
+    return ids;
+  };
+  auto realtime_ids = get_thread_ids(utils::task_priority::REALTIME);
+  auto frame_ids = get_thread_ids(utils::task_priority::FRAME);
+  auto background_ids = get_thread_ids(utils::task_priority::BACKGROUND);
+
+  // each lane runs on its own workers
+  EXPECT_EQ(realtime_ids.size(), 1);
+  EXPECT_EQ(background_ids.size(), 1);
+  EXPECT_FALSE(frame_ids.contains(*realtime_ids.begin()));
+  EXPECT_FALSE(frame_ids.contains(*background_ids.begin()));
+  EXPECT_NE(*realtime_ids.begin(), *background_ids.begin());
+
+  // nested tasks stay in the lane of the parent
+  auto nested_id = pool.submit(utils::task_priority::BACKGROUND, [&pool]() {
+    return pool.submit([]() { return std::this_thread::get_id(); });
+  }).get().get();
+  EXPECT_EQ(nested_id, *background_ids.begin());
+}
+
+TEST(thread_pool, lane_fallback)
+{
+  // background tasks run on the frame workers
+  utils::thread_pool pool(make_lane_configs(0, 2, 0));
+  EXPECT_EQ(pool.get_thread_count(utils::task_priority::BACKGROUND), 0);
+  EXPECT_EQ(pool.submit(utils::task_priority::BACKGROUND, []() { return 1; }).get(), 1);
+  EXPECT_EQ(pool.submit(utils::task_priority::REALTIME, []() { return 2; }).get(), 2);
+}
+
+void busy_wait(std::chrono::microseconds duration)
+{
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end);
+}
+
+TEST(thread_pool, realtime_latency_under_background_flood)
+{
+  auto configs = make_lane_configs(1, 1, 2);
+  // let the os prefer the other lanes
+  configs[static_cast<size_t>(utils::task_priority::BACKGROUND)].nice = 19;
+  utils::thread_pool pool(configs);
+
+  // ~1 sec of background work per worker
+  constexpr int flood_count = 1000;
+  static constexpr auto flood_task_duration = std::chrono::milliseconds(2);
+  for (int i = 0; i < flood_count; i++)
+    pool.spawn(utils::task_priority::BACKGROUND, []() { busy_wait(flood_task_duration); });
+
+  constexpr int trial_count = 50;
+  std::chrono::nanoseconds total{};
+  for (int i = 0; i < trial_count; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto begin = std::chrono::steady_clock::now();
+    auto started = pool.submit(utils::task_priority::REALTIME, []() { return std::chrono::steady_clock::now(); }).get();
+    total += started - begin;
+  }
+  auto average = std::chrono::duration_cast<std::chrono::microseconds>(total / trial_count);
+
+  // a real-time task queued behind the flood would wait for hundreds of ms
+  EXPECT_LT(average, flood_task_duration * 2);
+  RecordProperty("average_realtime_latency_us", static_cast<int>(average.count()));
+
+  pool.wait_for_all_tasks();
+}
+
+#ifdef __linux__
+TEST(thread_pool, worker_names)
+{
+  utils::thread_pool pool(make_lane_configs(1, 2, 0));
+  auto get_name = []() {
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    return std::string(name);
+  };
+  EXPECT_EQ(pool.submit(utils::task_priority::REALTIME, get_name).get(), "hnll-rt-0");
+  EXPECT_EQ(pool.submit(utils::task_priority::FRAME, get_name).get().substr(0, 11), "hnll-frame-");
+}
+#endif
+
 } // namespace hnll
\ No newline at end of file